@@ -0,0 +1,78 @@
+#include "build_grammar.hpp"
+#include "program.hpp"
+#include "grammar/grammar.hpp"
+#include "semantic/sema.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <unordered_set>
+
+namespace {
+
+// 三种分析器都能接受的 LL(1) 语句文法
+const auto statement_grammar = R"(program -> stmts
+stmts -> stmt stmts | E
+stmt -> ID = expr ; | { stmts } | while ( expr ) stmt
+expr -> term exprp
+exprp -> + term exprp | - term exprp | E
+term -> factor termp
+termp -> * factor termp | / factor termp | E
+factor -> ( expr ) | ID | NUM
+)";
+
+const grammar::context& statement_context() {
+    static const auto ctx = [] {
+        grammar::context c;
+        c.set_epsilon_str("E");
+        c.set_terminal_rule([](const std::string& str) {
+            static const std::unordered_set<std::string> terms{"ID", "NUM", "=", ";", "{", "}", "(", ")", "+", "-", "*", "/", "while"};
+            return terms.contains(str);
+        });
+        return c;
+    }();
+    return ctx;
+}
+
+template <typename Grammar>
+void BM_build_statement(benchmark::State& state) {
+    const grammar::context_scope scope(statement_context());
+    for (auto _ : state) {
+        Grammar g(statement_grammar);
+        g.build();
+        benchmark::DoNotOptimize(g);
+    }
+}
+BENCHMARK(BM_build_statement<grammar::LL1>)->Name("BM_build_statement/LL1");
+BENCHMARK(BM_build_statement<grammar::SLR<>>)->Name("BM_build_statement/SLR");
+BENCHMARK(BM_build_statement<grammar::LR1>)->Name("BM_build_statement/LR1");
+
+// simple_cc 的完整文法，LL1 无法处理其中的公共前缀
+template <typename Grammar>
+void BM_build_simple_cc(benchmark::State& state) {
+    const auto productions = semantic::to_productions(build_grammar());
+    for (auto _ : state) {
+        Grammar g(productions);
+        g.build();
+        benchmark::DoNotOptimize(g);
+    }
+    state.counters["productions"] = static_cast<double>(productions.size());
+}
+BENCHMARK(BM_build_simple_cc<grammar::SLR<>>)->Name("BM_build_simple_cc/SLR")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_build_simple_cc<grammar::LR1>)->Name("BM_build_simple_cc/LR1")->Unit(benchmark::kMillisecond);
+
+// LR(1) 语法分析并构建语法树，不含语义计算
+void BM_parse(benchmark::State& state) {
+    const auto& parser = bench::cc_parser();
+    compile_unit unit;
+    const auto tokens = lex(bench::cc_lexer(), bench::synthetic_program(state.range(0)), unit);
+    for (auto _ : state) {
+        std::stringstream raw_il;
+        benchmark::DoNotOptimize(parser.parse(tokens, raw_il));
+    }
+    state.counters["tokens/s"] = benchmark::Counter(static_cast<double>(state.iterations() * tokens.size()), benchmark::Counter::kIsRate);
+    state.counters["tokens"] = static_cast<double>(tokens.size());
+}
+BENCHMARK(BM_parse)->RangeMultiplier(8)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMillisecond);
+
+} // namespace
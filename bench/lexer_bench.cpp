@@ -0,0 +1,34 @@
+#include "program.hpp"
+#include "lexer/lexer.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+// 词法分析吞吐量，输入为合成程序
+void BM_lexer_parse(benchmark::State& state) {
+    const auto& lex_ = bench::cc_lexer();
+    const auto input = bench::synthetic_program(state.range(0));
+    std::size_t tokens = 0;
+    for (auto _ : state) {
+        const auto result = lex_.parse(input);
+        tokens = result.size();
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+    state.counters["tokens"] = static_cast<double>(tokens);
+}
+BENCHMARK(BM_lexer_parse)->RangeMultiplier(8)->Range(1 << 10, 1 << 23);
+
+void BM_lexer_parse_parallel(benchmark::State& state) {
+    const auto& lex_ = bench::cc_lexer();
+    const auto input = bench::synthetic_program(1 << 23);
+    for (auto _ : state) {
+        const auto result = lex_.parse_parallel(input, state.range(0));
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+BENCHMARK(BM_lexer_parse_parallel)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,26 @@
+#include "program.hpp"
+#include "build_grammar.hpp"
+#include "generator.hpp"
+#include "lexer/lexer.hpp"
+
+namespace bench {
+
+std::string synthetic_program(const std::size_t bytes) {
+    return generator::generate({.bytes = bytes});
+}
+
+const lexer::lexer& cc_lexer() {
+    static const auto lex_ = build_lexer();
+    return lex_;
+}
+
+const parser_t& cc_parser() {
+    static const auto parser = [] {
+        parser_t p(build_grammar());
+        p.build();
+        return p;
+    }();
+    return parser;
+}
+
+} // namespace bench
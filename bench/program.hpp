@@ -0,0 +1,18 @@
+#pragma once
+
+#include "build_lexer.hpp"
+#include "driver.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace bench {
+
+// 用固定种子生成约 bytes 字节的 simple_cc 程序，不同运行之间可以直接比较
+std::string synthetic_program(std::size_t bytes);
+
+// simple_cc 的词法分析器和 LR(1) 分析器，首次使用时构建，之后只读共享
+const lexer::lexer& cc_lexer();
+const parser_t& cc_parser();
+
+} // namespace bench
@@ -0,0 +1,63 @@
+#include "program.hpp"
+#include "regex/regex.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace {
+
+std::string keyword_alternation(const std::size_t n) {
+    std::string pattern;
+    for (std::size_t i = 0; i < n; ++i) {
+        pattern += (i ? "|kw" : "kw") + std::to_string(i * 7919 % 100000);
+    }
+    return pattern;
+}
+
+void BM_regex_compile(benchmark::State& state, const std::string& pattern) {
+    for (auto _ : state) {
+        regex::regex re(pattern);
+        benchmark::DoNotOptimize(re);
+    }
+}
+BENCHMARK_CAPTURE(BM_regex_compile, identifier, std::string("[a-zA-Z_][a-zA-Z0-9_]*"));
+BENCHMARK_CAPTURE(BM_regex_compile, number, std::string("[0-9]+\\.[0-9]*"));
+BENCHMARK_CAPTURE(BM_regex_compile, string, std::string(R"("([^"]|(\\"))*")"));
+BENCHMARK_CAPTURE(BM_regex_compile, comment, std::string("(//[^\n]*)|(/\\*([^*]|\\*+[^*/])*\\*+/)"));
+BENCHMARK_CAPTURE(BM_regex_compile, counted, std::string("[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{12}"));
+
+// 关键字数量递增的选择模式
+void BM_regex_compile_keywords(benchmark::State& state) {
+    const auto pattern = keyword_alternation(state.range(0));
+    for (auto _ : state) {
+        regex::regex re(pattern);
+        benchmark::DoNotOptimize(re);
+    }
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_regex_compile_keywords)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+// 整串匹配：只有一个长单词，DFA 逐字节走完整个输入
+void BM_regex_match(benchmark::State& state) {
+    const regex::regex re("[a-zA-Z_][a-zA-Z0-9_]*");
+    const std::string input(state.range(0), 'a');
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(re.match(input));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_regex_match)->RangeMultiplier(8)->Range(1 << 6, 1 << 20);
+
+// 在合成程序中查找所有浮点常量
+void BM_regex_find_all(benchmark::State& state) {
+    const regex::regex re("[0-9]+\\.[0-9]*");
+    const auto input = bench::synthetic_program(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(re.find_all(input));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+BENCHMARK(BM_regex_find_all)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+} // namespace
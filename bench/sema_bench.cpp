@@ -0,0 +1,35 @@
+#include "program.hpp"
+#include "semantic/sema.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+
+namespace {
+
+// 在已构建的语法树上做语义计算，生成 LLVM IR
+void BM_sema_calc(benchmark::State& state) {
+    const auto& parser = bench::cc_parser();
+    compile_unit unit;
+    const auto tokens = lex(bench::cc_lexer(), bench::synthetic_program(state.range(0)), unit);
+    std::stringstream raw_il;
+    const auto tree = parser.parse(tokens, raw_il);
+
+    std::size_t nodes = 0;
+    tree->visit([&](const auto&) { ++nodes; });
+
+    for (auto _ : state) {
+        raw_il.str({});
+        const auto env = tree->calc(&unit);
+        benchmark::DoNotOptimize(env.errors.data());
+        if (!env.errors.empty()) {
+            state.SkipWithError(env.errors.front().c_str());
+            break;
+        }
+    }
+    state.counters["nodes/s"] = benchmark::Counter(static_cast<double>(state.iterations() * nodes), benchmark::Counter::kIsRate);
+    state.counters["nodes"] = static_cast<double>(nodes);
+}
+BENCHMARK(BM_sema_calc)->RangeMultiplier(8)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -5,6 +5,7 @@
 #include "exception.hpp"
 #include "grammar_base.hpp"
 #include "production.hpp"
+#include "trace.hpp"
 
 #ifdef DEBUG
 #include "utils.hpp"
@@ -16,6 +17,7 @@
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <ranges>
 #include <set>
 #include <stack>
@@ -99,6 +101,23 @@ public:
     void insert_symbol(std::size_t ridx, const production::symbol& sym);
 };
 
+// 记录一次 LR 分析的过程，供增量重新分析时复用
+struct parse_log {
+    // 持久化的状态栈，各位置的栈共享公共的栈底
+    struct frame {
+        std::size_t state;
+        std::shared_ptr<const frame> parent;
+    };
+    using stack_t = std::shared_ptr<const frame>;
+
+    // stacks[i] 为第 i 个 token 成为向前看符号时的状态栈，emitted[i] 为此前已产生的归约数
+    std::vector<stack_t> stacks;
+    std::vector<std::size_t> emitted;
+    std::vector<std::size_t> reductions;
+    // 上一次分析实际驱动的 token 数
+    std::size_t driven = 0;
+};
+
 template <typename Production = production::LR_production>
 class SLR : public grammar_base {
 public:
@@ -114,7 +133,15 @@ public:
 
     void build() override;
     void parse(const std::vector<lexer::token>& input) override;
+    void parse(const std::vector<lexer::token>& input, tree& out) const;
+    void parse(const std::vector<lexer::token>& input, tree& out, parse_log& log) const;
+    // input 为 lexer::relex 更新后的 token 序列，log 为上一次分析的记录
+    void reparse(const std::vector<lexer::token>& input, const lexer::lexer::damage& d, tree& out, parse_log& log) const;
     void print_steps() const;
+    // 分析表规模：项目集（状态）数、ACTION 表和 GOTO 表的表项数
+    [[nodiscard]] std::size_t state_count() const;
+    [[nodiscard]] std::size_t action_count() const;
+    [[nodiscard]] std::size_t goto_count() const;
     void init_error_handlers(std::function<void(action_table_t&, goto_table_t&, std::vector<error_handle_fn>&)> fn);
 
 protected:
@@ -136,6 +163,13 @@ protected:
     virtual void move_dot(std::size_t idx, const production::symbol& sym);
     void print_items_set() const;
     void print_tables() const;
+
+private:
+    using stop_fn = std::function<bool(std::size_t, const parse_log::stack_t&)>;
+
+    void parse_into(const std::vector<lexer::token>& input, tree& out, rightmost_step* record) const;
+    bool drive(const std::vector<lexer::token>& in, std::size_t pos, parse_log::stack_t stack, parse_log& log, const stop_fn& stop) const;
+    void build_tree(const std::vector<lexer::token>& in, const std::vector<std::size_t>& reductions, tree& out) const;
 };
 
 } // namespace grammar
@@ -185,6 +219,7 @@ SLR<Production>::SLR(const std::string& str) {
 
 template <typename Production>
 void SLR<Production>::build() {
+    const context_scope scope(context_);
     calc_first();
     calc_follow();
     build_items_set();
@@ -196,9 +231,22 @@ void SLR<Production>::build() {
 
 template <typename Production>
 void SLR<Production>::parse(const std::vector<lexer::token>& input) {
+    const context_scope scope(context_);
+    steps.set_input(input);
+    parse_into(input, *tree_, &steps);
+}
+
+template <typename Production>
+void SLR<Production>::parse(const std::vector<lexer::token>& input, tree& out) const {
+    parse_into(input, out, nullptr);
+}
+
+template <typename Production>
+void SLR<Production>::parse_into(const std::vector<lexer::token>& input, tree& out, rightmost_step* record) const {
+    const trace::span span("SLR::parse");
+    const context_scope scope(context_);
     auto in = input;
-    steps.set_input(in);
-    in.emplace_back(production::symbol::end_mark_str);
+    in.emplace_back(context::current().end_mark_str());
 
     std::stack<LR_stack_t> stack;
     stack.emplace(std::size_t{0});
@@ -211,12 +259,13 @@ void SLR<Production>::parse(const std::vector<lexer::token>& input) {
         auto& top = stack.top();
 
         assert(top.is_state());
-        auto row = action_table.at(top.get_state());
+        const auto& row = action_table.at(top.get_state());
 
-        if (!row.contains(cur_input)) {
+        const auto found = row.find(cur_input);
+        if (found == row.end()) {
             throw exception::grammar_error("Unexpected token: " + cur_input.name + " at line " + std::to_string(in[pos].line) + ", column " + std::to_string(in[pos].column));
         }
-        auto act = row[cur_input];
+        const auto act = found->second;
 
 #ifdef DEBUG
         std::cout << "------------------------\n";
@@ -231,10 +280,10 @@ void SLR<Production>::parse(const std::vector<lexer::token>& input) {
 #endif
         if (act.is_accept()) {
             for (const auto& prod : std::ranges::reverse_view(output)) {
-                tree_->add_r(prod);
+                out.add_r(prod);
             }
             for (const auto& tk : in) {
-                tree_->update_r(production::symbol{tk});
+                out.update_r(production::symbol{tk});
             }
             return;
         }
@@ -257,7 +306,9 @@ void SLR<Production>::parse(const std::vector<lexer::token>& input) {
             stack.push(prod.lhs);
             stack.push(new_state);
             output.emplace_back(prod);
-            steps.add(prod, in.size() - pos);
+            if (record) {
+                record->add(prod, in.size() - pos);
+            }
 #ifdef DEBUG
             std::cout << prod << '\n';
 #endif
@@ -272,11 +323,168 @@ void SLR<Production>::parse(const std::vector<lexer::token>& input) {
     }
 }
 
+template <typename Production>
+void SLR<Production>::parse(const std::vector<lexer::token>& input, tree& out, parse_log& log) const {
+    const context_scope scope(context_);
+    log = {};
+    if (!error_handlers.empty()) {
+        // 错误恢复会直接修改分析栈，无法记录为持久化的栈
+        parse_into(input, out, nullptr);
+        log.driven = input.size() + 1;
+        return;
+    }
+    const trace::span span("SLR::parse");
+    auto in = input;
+    in.emplace_back(context::current().end_mark_str());
+    drive(in, 0, std::make_shared<const parse_log::frame>(parse_log::frame{0, nullptr}), log, {});
+    log.driven = in.size();
+    build_tree(in, log.reductions, out);
+}
+
+template <typename Production>
+void SLR<Production>::reparse(const std::vector<lexer::token>& input, const lexer::lexer::damage& d, tree& out, parse_log& log) const {
+    const trace::span span("SLR::reparse");
+    const context_scope scope(context_);
+    if (log.stacks.size() <= d.first) {
+        parse(input, out, log);
+        return;
+    }
+
+    auto in = input;
+    in.emplace_back(context::current().end_mark_str());
+
+    parse_log next;
+    next.stacks.assign(log.stacks.begin(), log.stacks.begin() + d.first);
+    next.emitted.assign(log.emitted.begin(), log.emitted.begin() + d.first);
+    next.reductions.assign(log.reductions.begin(), log.reductions.begin() + log.emitted[d.first]);
+
+    // 越过修改区域后，若状态栈与旧分析在对应位置的栈相同，剩余的分析过程必然相同
+    auto same = [](const parse_log::frame* a, const parse_log::frame* b) {
+        while (a != b) {
+            if (!a || !b || a->state != b->state) {
+                return false;
+            }
+            a = a->parent.get();
+            b = b->parent.get();
+        }
+        return true;
+    };
+    std::size_t resume = log.stacks.size();
+    const bool accepted = drive(in, d.first, log.stacks[d.first], next, [&](const std::size_t pos, const parse_log::stack_t& stack) {
+        if (pos < d.new_end) {
+            return false;
+        }
+        const auto old_pos = pos - d.new_end + d.old_end;
+        if (old_pos >= log.stacks.size() || !same(stack.get(), log.stacks[old_pos].get())) {
+            return false;
+        }
+        resume = old_pos;
+        return true;
+    });
+
+    if (!accepted) {
+        next.driven = next.stacks.size() - d.first;
+        const auto base = log.emitted[resume];
+        const auto offset = next.reductions.size();
+        next.reductions.insert(next.reductions.end(), log.reductions.begin() + base, log.reductions.end());
+        for (auto i = resume; i < log.stacks.size(); ++i) {
+            next.stacks.push_back(log.stacks[i]);
+            next.emitted.push_back(log.emitted[i] - base + offset);
+        }
+    } else {
+        next.driven = in.size() - d.first;
+    }
+    log = std::move(next);
+    build_tree(in, log.reductions, out);
+}
+
+template <typename Production>
+bool SLR<Production>::drive(const std::vector<lexer::token>& in, std::size_t pos, parse_log::stack_t stack, parse_log& log,
+                            const stop_fn& stop) const {
+    auto lookahead = [&] {
+        if (stop && stop(pos, stack)) {
+            return false;
+        }
+        log.stacks.push_back(stack);
+        log.emitted.push_back(log.reductions.size());
+        return true;
+    };
+    if (!lookahead()) {
+        return false;
+    }
+
+    while (true) {
+        const auto cur_input = production::symbol{in[pos]};
+        const auto& row = action_table.at(stack->state);
+        const auto found = row.find(cur_input);
+        if (found == row.end() || found->second.action_type == action::type::error) {
+            throw exception::grammar_error("Unexpected token: " + cur_input.name + " at line " + std::to_string(in[pos].line) + ", column " + std::to_string(in[pos].column));
+        }
+        const auto act = found->second;
+
+        if (act.is_accept()) {
+            return true;
+        }
+        if (act.is_shift()) {
+            stack = std::make_shared<const parse_log::frame>(parse_log::frame{act.val, std::move(stack)});
+            pos++;
+            if (!lookahead()) {
+                return false;
+            }
+        } else {
+            const auto& prod = productions.at(act.val);
+            auto r = prod.rhs.size();
+            if (prod.rhs.size() == 1 && prod.rhs[0].is_epsilon()) {
+                r = 0;
+            }
+            for (std::size_t i = 0; i < r; ++i) {
+                stack = stack->parent;
+            }
+            const auto new_state = goto_table.at(stack->state).at(prod.lhs);
+            stack = std::make_shared<const parse_log::frame>(parse_log::frame{new_state, std::move(stack)});
+            log.reductions.push_back(act.val);
+        }
+    }
+}
+
+template <typename Production>
+void SLR<Production>::build_tree(const std::vector<lexer::token>& in, const std::vector<std::size_t>& reductions, tree& out) const {
+    for (const auto id : std::ranges::reverse_view(reductions)) {
+        out.add_r(productions.at(id));
+    }
+    for (const auto& tk : in) {
+        out.update_r(production::symbol{tk});
+    }
+}
+
 template <typename Production>
 void SLR<Production>::print_steps() const {
     steps.print();
 }
 
+template <typename Production>
+std::size_t SLR<Production>::state_count() const {
+    return items_set.size();
+}
+
+template <typename Production>
+std::size_t SLR<Production>::action_count() const {
+    std::size_t count = 0;
+    for (const auto& row : action_table | std::views::values) {
+        count += row.size();
+    }
+    return count;
+}
+
+template <typename Production>
+std::size_t SLR<Production>::goto_count() const {
+    std::size_t count = 0;
+    for (const auto& row : goto_table | std::views::values) {
+        count += row.size();
+    }
+    return count;
+}
+
 template <typename Production>
 void SLR<Production>::init_error_handlers(std::function<void(action_table_t&, goto_table_t&, std::vector<error_handle_fn>&)> fn) {
     init_error_handlers_fn = std::move(fn);
@@ -290,6 +498,7 @@ void SLR<Production>::init_first_item_set() {
 
 template <typename Production>
 void SLR<Production>::build_items_set() {
+    const trace::span span("SLR::build_items_set");
     items_set.reserve(productions.size() * 2);
     after_dot_set.reserve(productions.size() * 2);
 
@@ -344,8 +553,8 @@ void SLR<Production>::build_acc_and_reduce(const items_t& current_items, const s
     for (const auto& item : current_items) {
         if (item.is_end()) {
             if (item.lhs == productions[0].lhs) {
-                assert(!action_table[idx].contains(production::symbol::end_mark));
-                action_table[idx][production::symbol::end_mark] = action::accept();
+                assert(!action_table[idx].contains(production::symbol::end_mark()));
+                action_table[idx][production::symbol::end_mark()] = action::accept();
             } else {
                 std::size_t pid = -1;
                 for (const auto id : symbol_map[item.lhs]) {
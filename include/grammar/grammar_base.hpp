@@ -26,6 +26,7 @@ protected:
     std::unordered_map<production::symbol, symbol_set> follow;
     std::unordered_map<production::symbol, std::vector<std::size_t>> symbol_map;
     std::shared_ptr<tree> tree_ = std::make_shared<tree>();
+    context context_ = context::current();
 
     void calc_first();
     symbol_set& calc_first(const production::symbol& sym);
@@ -8,6 +8,10 @@
 #include <string>
 #include <vector>
 
+namespace grammar {
+class context;
+} // namespace grammar
+
 namespace grammar::production {
 
 struct symbol {
@@ -25,12 +29,6 @@ struct symbol {
     std::size_t line = 0;
     std::size_t column = 0;
 
-    static std::string epsilon_str;
-    static std::string end_mark_str;
-    static symbol epsilon;
-    static symbol end_mark;
-    static std::function<bool(const std::string&)> terminal_rule;
-
     symbol();
     explicit symbol(const std::string& str);
     explicit symbol(const lexer::token& token);
@@ -49,7 +47,14 @@ struct symbol {
     bool operator<(const symbol& other) const;
     bool operator!=(const symbol& other) const;
 
+    static const symbol& epsilon();
+    static const symbol& end_mark();
+
 private:
+    friend class grammar::context;
+
+    symbol(enum type type, const std::string& str);
+
     static std::string trim(const std::string& str);
 };
 
@@ -153,6 +158,44 @@ struct hash<grammar::production::LR1_production> {
 } // namespace std
 
 namespace grammar {
+
+class context {
+public:
+    context();
+
+    void set_epsilon_str(const std::string& str);
+    void set_end_mark_str(const std::string& str);
+    void set_terminal_rule(std::function<bool(const std::string&)> rule);
+
+    [[nodiscard]] const std::string& epsilon_str() const;
+    [[nodiscard]] const std::string& end_mark_str() const;
+    [[nodiscard]] bool is_terminal(const std::string& str) const;
+    [[nodiscard]] const production::symbol& epsilon() const;
+    [[nodiscard]] const production::symbol& end_mark() const;
+
+    static const context& current();
+    static context& thread_default();
+
+private:
+    std::string epsilon_str_ = "ε";
+    std::string end_mark_str_ = "$";
+    std::function<bool(const std::string&)> terminal_rule_;
+    production::symbol epsilon_;
+    production::symbol end_mark_;
+};
+
+class context_scope {
+public:
+    explicit context_scope(const context& ctx);
+    ~context_scope();
+
+    context_scope(const context_scope&) = delete;
+    context_scope& operator=(const context_scope&) = delete;
+
+private:
+    const context* previous;
+};
+
 void set_epsilon_str(const std::string& str);
 void set_end_mark_str(const std::string& str);
 void set_terminal_rule(const std::function<bool(const std::string&)>& rule);
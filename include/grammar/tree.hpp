@@ -13,7 +13,8 @@ namespace grammar {
 struct tree_node {
     std::shared_ptr<production::symbol> symbol;
     std::vector<std::shared_ptr<tree_node>> children;
-    std::shared_ptr<tree_node> parent = nullptr;
+    // 弱引用，避免父子结点互相持有导致整棵树无法释放
+    std::weak_ptr<tree_node> parent;
 
     virtual ~tree_node() = default;
     explicit tree_node(const production::symbol& sym);
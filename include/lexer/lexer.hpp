@@ -8,8 +8,11 @@
 #include "regex/regex.hpp"
 #endif
 
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -22,6 +25,9 @@ class regex_wrapper {
 public:
     explicit regex_wrapper(const std::string& pattern);
     std::size_t match_max(const std::string& input) const;
+    std::size_t match_max(std::string_view input, std::size_t& scanned) const;
+    // std::regex 不公开自动机，总是返回 0
+    [[nodiscard]] std::size_t state_count() const;
 
 private:
     std::regex regex_;
@@ -35,6 +41,10 @@ struct token {
     std::string value;
     std::size_t line;
     std::size_t column;
+    const std::string* name = nullptr;
+    std::size_t offset = 0;
+    // 产生该 token 及其后被跳过的 token 时读取到的最远位置（不含），用于增量词法分析
+    std::size_t reach = 0;
 
     template <typename TokenType>
     token(const TokenType type, std::string value, const std::size_t line, const std::size_t column)
@@ -49,10 +59,30 @@ struct token {
     friend std::ostream& operator<<(std::ostream& os, const token& t);
 };
 
+// 输入中所有换行符的位置，用于由字节偏移计算行列
+class line_index {
+public:
+    explicit line_index(std::string_view input);
+
+    // 返回从 1 开始的行号和列号
+    [[nodiscard]] std::pair<std::size_t, std::size_t> locate(std::size_t offset) const;
+    // 按偏移填写 tokens[from..] 的行列，tokens 须按偏移有序
+    void resolve(std::vector<token>& tokens, std::size_t from = 0) const;
+
+private:
+    std::vector<std::size_t> newlines;
+};
+
 class lexer {
 public:
     using tokens_t = std::vector<token>;
-    using keyword_t = std::pair<regex_wrapper, int>;
+    using token_names_t = std::unordered_map<int, std::string>;
+
+    struct keyword_t {
+        regex_wrapper pattern;
+        int token;
+        const std::string* name;
+    };
 
     template <typename TokenType>
     struct input_keyword {
@@ -67,16 +97,43 @@ public:
     template <typename TokenType>
     using input_keywords_t = std::vector<input_keyword<TokenType>>;
 
-    static int whitespace;
-    static std::unordered_map<int, std::string> token_names;
+    struct edit {
+        std::size_t offset;
+        std::size_t removed;
+        std::size_t inserted;
+    };
+
+    // 旧序列中 [first, old_end) 的 token 被替换为新序列中的 [first, new_end)
+    struct damage {
+        std::size_t first;
+        std::size_t old_end;
+        std::size_t new_end;
+    };
+
+    template <typename TokenType>
+    lexer(input_keywords_t<TokenType> key_words, TokenType whitespace_type);
 
     template <typename TokenType>
-    lexer(input_keywords_t<TokenType> key_words, TokenType whitespace_);
+    void skip(TokenType type);
 
     [[nodiscard]] tokens_t parse(const std::string& input, bool skip_whitespace = true) const;
+    // 把输入切成 jobs 块并行分析，结果与 parse 相同；输入较小时退化为 parse
+    [[nodiscard]] tokens_t parse_parallel(const std::string& input, std::size_t jobs, bool skip_whitespace = true) const;
+    damage relex(const std::string& input, tokens_t& tokens, const edit& e, bool skip_whitespace = true) const;
+    [[nodiscard]] int whitespace() const;
+    [[nodiscard]] const token_names_t& token_names() const;
+    // 所有词法规则的自动机状态数之和
+    [[nodiscard]] std::size_t dfa_states() const;
 
 private:
     std::vector<keyword_t> key_words;
+    int whitespace_;
+    std::vector<int> skipped;
+    std::shared_ptr<token_names_t> token_names_ = std::make_shared<token_names_t>();
+
+    // 分析过程只记录偏移，行列由调用者通过 line_index 统一填写
+    std::size_t scan(const std::string& input, std::size_t start, bool skip_whitespace, tokens_t& tokens,
+                     const std::function<bool(const token&)>& stop) const;
 };
 
 } // namespace lexer
@@ -86,19 +143,25 @@ private:
 namespace lexer {
 
 template <typename TokenType>
-lexer::lexer(const input_keywords_t<TokenType> key_words, TokenType whitespace_) {
+lexer::lexer(const input_keywords_t<TokenType> key_words, TokenType whitespace_type)
+    : whitespace_(static_cast<int>(whitespace_type)), skipped{static_cast<int>(whitespace_type)} {
     static_assert(std::is_enum_v<TokenType> || std::is_convertible_v<TokenType, int>, "token_type must be an enum type");
-    whitespace = static_cast<int>(whitespace_);
 
     for (const auto& keyword : key_words) {
-        const auto& pattern_str = keyword.pattern_str;
-        const auto& token = keyword.token;
-        const auto& name = keyword.name;
-        token_names.insert({static_cast<int>(token), name});
-        this->key_words.emplace_back(regex_wrapper(pattern_str), static_cast<int>(token));
+        token_names_->insert({static_cast<int>(keyword.token), keyword.name});
+    }
+    for (const auto& keyword : key_words) {
+        const auto type = static_cast<int>(keyword.token);
+        this->key_words.push_back({regex_wrapper(keyword.pattern_str), type, &token_names_->at(type)});
     }
 }
 
+template <typename TokenType>
+void lexer::skip(const TokenType type) {
+    static_assert(std::is_enum_v<TokenType> || std::is_convertible_v<TokenType, int>, "token_type must be an enum type");
+    skipped.push_back(static_cast<int>(type));
+}
+
 } // namespace lexer
 
 #pragma endregion
@@ -6,56 +6,78 @@
 #include "token.hpp"
 #include "tree.hpp"
 
+#include <array>
+#include <bitset>
 #include <cstddef>
-#include <unordered_map>
-#include <unordered_set>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
 
 
 namespace regex::dfa {
 
+// 一类字节的连续出现，skip 一次跳过整段；DFA 的自环和 regex::find 的首字节预过滤共用
+struct run_class {
+    std::bitset<256> member;
+    // 成员（negated 时为非成员）可表示为不超过 4 个区间时使用 SIMD 扫描
+    std::array<std::pair<unsigned char, unsigned char>, 4> ranges{};
+    std::size_t range_count = 0;
+    bool negated = false;
+
+    static run_class of(const std::bitset<256>& member);
+
+    // 返回从 pos 开始第一个不属于该类的位置
+    [[nodiscard]] std::size_t skip(std::string_view str, std::size_t pos) const;
+};
+
 class dfa {
 public:
-    using state_t = std::size_t;
-    using token_t = token::token_type;
-    using token_t_hash = token::token_type_hash;
-    using transition_t = std::unordered_map<token_t, state_t, token_t_hash>;
-    using dfa_state_t = std::unordered_map<state_t, transition_t>;
+    using state_t = std::uint32_t;
+    using class_t = std::uint16_t;
+
+    // 每个状态的附加信息，run 为 runs 中的下标，-1 表示没有可跳过的自环
+    struct state_info {
+        bool accepting = false;
+        // 没有任何转移，读到下一个字符之前就可以结束
+        bool final = true;
+        std::int32_t run = -1;
+    };
 
     dfa() = delete;
 
     explicit dfa(const tree::regex_tree& tree);
     explicit dfa(const std::string& regex);
 
-    void add_transition(state_t from, const token_t& token, state_t to);
     bool match(const std::string& str) const;
     std::size_t match_max(const std::string& str) const;
+    // scanned 为决定匹配结果所读取的字符数，读到输入末尾时为 str.size() + 1
+    std::size_t match_max(std::string_view str, std::size_t& scanned) const;
+
+    // 单步转移，0 表示没有转移；起始状态为 1
+    [[nodiscard]] state_t next(state_t from, char ch) const;
+    [[nodiscard]] bool accepts(state_t state) const;
+    // 不含死状态 0，状态编号为 1..state_count()
+    [[nodiscard]] std::size_t state_count() const;
+    [[nodiscard]] std::size_t class_count() const;
 
-    const dfa_state_t& get_transitions() const;
     void print() const;
 
 private:
-    dfa_state_t transitions;
-    std::unordered_set<state_t> accept_states;
-
-    struct d_state_t {
-        std::unordered_set<state_t> states;
-        state_t id;
-        bool operator==(const d_state_t& other) const {
-            return states == other.states;
-        }
-    };
-
-    struct d_state_t_hash {
-        std::size_t operator()(const d_state_t& s) const {
-            std::size_t h = 0;
-            for (auto v : s.states) {
-                h ^= std::hash<state_t>{}(v);
-            }
-            return h;
-        }
-    };
+    // 转移表按字节类压缩：转移相同的字节归为一类，table[state * classes + class] 为目标状态
+    std::array<class_t, 256> byte_class{};
+    std::size_t classes = 1;
+    std::vector<state_t> table;
+    std::vector<state_info> states;
+    std::vector<run_class> runs;
 
     void init(const tree::regex_tree& tree);
+    void minimize();
+    void merge_classes();
+    void build_runs();
+    [[nodiscard]] state_t step(const state_t from, const char ch) const {
+        return table[from * classes + byte_class[static_cast<unsigned char>(ch)]];
+    }
 };
 
 } // namespace regex::dfa
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef REGEX_LAZY_DFA_HPP
+#define REGEX_LAZY_DFA_HPP
+
+#include "position_set.hpp"
+#include "tree.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace regex::dfa {
+
+// 按需构建的 DFA：状态和转移在匹配时第一次用到才计算，缓存超过 cache_bytes 时整体清空后继续
+// 匹配结果与 dfa 相同；缓存由互斥锁保护，可以在多个线程中共享
+class lazy_dfa {
+public:
+    using state_t = std::uint32_t;
+
+    static constexpr std::size_t default_cache_bytes = std::size_t{1} << 20;
+
+    explicit lazy_dfa(const tree::regex_tree& tree, std::size_t cache_bytes = default_cache_bytes);
+    explicit lazy_dfa(const std::string& regex, std::size_t cache_bytes = default_cache_bytes);
+    lazy_dfa(const lazy_dfa&) = delete;
+    lazy_dfa& operator=(const lazy_dfa&) = delete;
+
+    bool match(const std::string& str) const;
+    std::size_t match_max(const std::string& str) const;
+    // scanned 的含义与 dfa::match_max 相同
+    std::size_t match_max(std::string_view str, std::size_t& scanned) const;
+
+    [[nodiscard]] std::size_t cached_states() const;
+    [[nodiscard]] std::size_t flushes() const;
+
+private:
+    static constexpr state_t dead = 0;
+    static constexpr state_t start = 1;
+    static constexpr state_t unknown = UINT32_MAX;
+
+    enum flag : std::uint8_t {
+        accepting = 1,
+        // 只剩结束标记，不会再有任何转移
+        final = 2,
+    };
+
+    // 每个字节所属的字节类，同一类的字节命中完全相同的位置
+    std::array<std::uint8_t, 256> byte_class{};
+    std::vector<tree::position_set> class_positions;
+    std::vector<tree::position_set> followpos;
+    tree::position_set start_set;
+    std::size_t end_position = 0;
+    std::size_t state_bytes = 0;
+    std::size_t cache_bytes;
+
+    struct cache_t {
+        std::unordered_map<tree::position_set, state_t, tree::position_set_hash> ids;
+        std::vector<const tree::position_set*> sets;
+        std::vector<std::uint8_t> flags;
+        std::vector<state_t> next;
+        std::size_t flushes = 0;
+    };
+
+    mutable std::mutex mutex;
+    mutable cache_t cache;
+
+    void init(const tree::regex_tree& tree);
+    void flush() const;
+    state_t add_state(tree::position_set set) const;
+    state_t step(state_t from, char ch) const;
+};
+
+} // namespace regex::dfa
+
+#endif // REGEX_LAZY_DFA_HPP
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef REGEX_POSITION_SET_HPP
+#define REGEX_POSITION_SET_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace regex::tree {
+
+// 正则位置集合，按位存储；末尾不保留全零的字，因此相等的集合有相同的表示
+class position_set {
+public:
+    using word_t = std::uint64_t;
+    static constexpr std::size_t word_bits = 64;
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::size_t*;
+        using reference = std::size_t;
+
+        iterator() = default;
+        iterator(const std::vector<word_t>* words, std::size_t index);
+
+        std::size_t operator*() const { return index * word_bits + std::countr_zero(rest); }
+        iterator& operator++();
+        iterator operator++(int);
+        bool operator==(const iterator& other) const { return index == other.index && rest == other.rest; }
+
+    private:
+        const std::vector<word_t>* words = nullptr;
+        std::size_t index = 0;
+        word_t rest = 0;
+
+        void settle();
+    };
+
+    position_set() = default;
+
+    void insert(std::size_t pos);
+    [[nodiscard]] bool contains(std::size_t pos) const;
+    [[nodiscard]] bool empty() const { return words.empty(); }
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] bool intersects(const position_set& other) const;
+
+    position_set& operator|=(const position_set& other);
+    bool operator==(const position_set& other) const = default;
+
+    [[nodiscard]] iterator begin() const { return {&words, 0}; }
+    [[nodiscard]] iterator end() const { return {&words, words.size()}; }
+
+    [[nodiscard]] std::size_t hash() const;
+
+private:
+    std::vector<word_t> words;
+};
+
+struct position_set_hash {
+    std::size_t operator()(const position_set& s) const { return s.hash(); }
+};
+
+} // namespace regex::tree
+
+#endif // REGEX_POSITION_SET_HPP
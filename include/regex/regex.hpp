@@ -3,19 +3,66 @@
 #define REGEX_REGEX_HPP
 
 #include "dfa.hpp"
+#include "lazy_dfa.hpp"
+
+#include <bitset>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace regex {
 
+// 惰性模式：不预先构建完整的 DFA，状态在匹配时按需构建并缓存
+struct lazy {
+    std::size_t cache_bytes = dfa::lazy_dfa::default_cache_bytes;
+};
+
+// find 的结果：text 中从 position 开始、长度为 length 的一段
+struct match_result {
+    std::size_t position;
+    std::size_t length;
+
+    bool operator==(const match_result& other) const = default;
+};
+
 class regex {
 public:
+    // 位置数超过该值的模式自动使用惰性模式
+    static constexpr std::size_t lazy_positions = 4096;
+
     regex() = delete;
     explicit regex(const std::string& regex);
+    regex(const std::string& regex, lazy mode);
 
     bool match(const std::string& str) const;
     std::size_t match_max(const std::string& str) const;
+    std::size_t match_max(std::string_view str, std::size_t& scanned) const;
+
+    // 非锚定搜索：从 from 开始最左的非空匹配，同一起点取最长
+    std::optional<match_result> find(std::string_view text, std::size_t from = 0) const;
+    // 所有互不重叠的非空匹配，每次从上一个匹配的末尾继续
+    std::vector<match_result> find_all(std::string_view text) const;
+
+    [[nodiscard]] bool is_lazy() const;
+    // 自动机的状态数，惰性模式下为当前缓存的状态数
+    [[nodiscard]] std::size_t state_count() const;
 
 private:
-    dfa::dfa dfa_;
+    std::optional<dfa::dfa> dfa_;
+    std::shared_ptr<const dfa::lazy_dfa> lazy_;
+
+    // 首字节预过滤：匹配只可能从 first_bytes 中的字节开始
+    std::bitset<256> first_bytes;
+    // 只有一个可能的首字节时用 memchr，否则用 SIMD 跳过不可能的字节
+    int first_byte = -1;
+    dfa::run_class non_first;
+
+    // 反向扫描一次标出所有匹配起点；逐个候选起点匹配的开销超出线性时 find 改用它
+    class start_finder;
+    std::shared_ptr<const start_finder> starts_;
+
+    void init_prefilter(const tree::regex_tree& tree);
+    [[nodiscard]] std::size_t next_candidate(std::string_view text, std::size_t pos) const;
 };
 
 } // namespace regex
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef REGEX_REGEX_SET_HPP
+#define REGEX_REGEX_SET_HPP
+
+#include "dfa.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace regex {
+
+// 多个模式合成一个乘积 DFA，一次扫描得到所有完整匹配输入的模式编号
+class regex_set {
+public:
+    // 乘积状态数超过该值时抛出 invalid_regex_exception
+    static constexpr std::size_t max_states = std::size_t{1} << 16;
+
+    explicit regex_set(const std::vector<std::string>& patterns);
+
+    // 返回完整匹配 str 的模式编号（按构造时的顺序），结果写入 out 可以避免重复分配
+    std::vector<std::size_t> match(std::string_view str) const;
+    void match(std::string_view str, std::vector<std::size_t>& out) const;
+    bool match_any(std::string_view str) const;
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t state_count() const;
+
+private:
+    using state_t = std::uint32_t;
+    static constexpr state_t dead = 0;
+    static constexpr state_t start = 1;
+
+    std::size_t patterns = 0;
+    std::size_t classes = 0;
+    std::size_t words = 0;
+    std::array<std::uint32_t, 256> byte_class{};
+    std::vector<state_t> table;
+    // 每个状态 words 个字，第 k 位表示第 k 个模式在该状态接受
+    std::vector<std::uint64_t> accepting;
+
+    [[nodiscard]] state_t run(std::string_view str) const;
+};
+
+} // namespace regex
+
+#endif // REGEX_REGEX_SET_HPP
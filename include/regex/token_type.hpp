@@ -2,10 +2,12 @@
 #ifndef REGEX_TOKEN_TYPE_HPP
 #define REGEX_TOKEN_TYPE_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 
 #if __cplusplus >= 201703L
@@ -23,6 +25,8 @@ enum class op {
     alt,
     star,
     plus,
+    // 只由计数重复 {m,n} 展开产生，'?' 本身仍是普通字符
+    optional,
     left_par,
     right_par,
     backslash
@@ -33,8 +37,9 @@ extern const std::unordered_map<op, std::string> op_map;
 
 enum class nothing {};
 
+// 以 unsigned char 取值为下标的 256 位位图；is_negative 时表示位图之外的字符
 struct char_set {
-    std::unordered_set<char> chars;
+    std::array<std::uint64_t, 4> bits{};
     bool is_negative;
 
     char_set();
@@ -46,7 +51,21 @@ struct char_set {
     void add(const char_set& other);
     void add(char from, char to);
 
-    bool operator==(const char_set& other) const;
+    // 只查位图，不考虑 is_negative
+    [[nodiscard]] bool contains(char ch) const {
+        const auto c = static_cast<unsigned char>(ch);
+        return (bits[c >> 6] >> (c & 63) & 1) != 0;
+    }
+    [[nodiscard]] bool matches(char ch) const { return contains(ch) != is_negative; }
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t hash() const;
+
+    char_set& operator|=(const char_set& other);
+    char_set& operator&=(const char_set& other);
+    // 翻转位图，is_negative 不变
+    [[nodiscard]] char_set operator~() const;
+
+    bool operator==(const char_set& other) const = default;
 };
 
 extern const char_set words;
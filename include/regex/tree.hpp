@@ -3,14 +3,16 @@
 #ifndef REGEX_TREE_HPP
 #define REGEX_TREE_HPP
 
+#include "position_set.hpp"
 #include "token.hpp"
 
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 namespace regex::tree {
 
@@ -22,15 +24,17 @@ public:
         alt,
         star,
         plus,
+        optional,
     };
 
-    using node_ptr_t = std::shared_ptr<regex_node>;
+    // 节点由所属的 regex_tree 分配和释放
+    using node_ptr_t = regex_node*;
 
     type type;
 
     bool nullable;
-    std::unordered_set<std::size_t> firstpos;
-    std::unordered_set<std::size_t> lastpos;
+    position_set firstpos;
+    position_set lastpos;
 
     virtual ~regex_node() = default;
 
@@ -49,39 +53,51 @@ public:
 class concat_node final : public regex_node {
 public:
     node_ptr_t left, right;
-    explicit concat_node(const node_ptr_t& left, const node_ptr_t& right);
+    explicit concat_node(node_ptr_t left, node_ptr_t right);
 };
 
 class star_node final : public regex_node {
 public:
     node_ptr_t child;
-    explicit star_node(const node_ptr_t& child);
+    explicit star_node(node_ptr_t child);
 };
 
 class plus_node final : public regex_node {
 public:
     node_ptr_t child;
-    explicit plus_node(const node_ptr_t& child);
+    explicit plus_node(node_ptr_t child);
+};
+
+class optional_node final : public regex_node {
+public:
+    node_ptr_t child;
+    explicit optional_node(node_ptr_t child);
 };
 
 class alt_node final : public regex_node {
 public:
     node_ptr_t left, right;
-    explicit alt_node(const node_ptr_t& left, const node_ptr_t& right);
+    explicit alt_node(node_ptr_t left, node_ptr_t right);
 };
 
 class regex_tree {
 public:
-    regex_node::node_ptr_t root;
+    regex_node::node_ptr_t root = nullptr;
 
-    using token_map_t = std::unordered_map<token::token_type, std::unordered_set<std::size_t>, token::token_type_hash>;
+    using token_map_t = std::unordered_map<token::token_type, position_set, token::token_type_hash>;
 
     token_map_t token_map;
 
-    std::unordered_map<std::size_t, std::unordered_set<std::size_t>> followpos;
+    // 按位置编号索引，下标 0 不使用
+    std::vector<position_set> followpos;
 
     explicit regex_tree(regex_node& root);
     explicit regex_tree(const std::string& s);
+    regex_tree(const regex_tree&) = delete;
+    regex_tree(regex_tree&&) noexcept = default;
+    regex_tree& operator=(const regex_tree&) = delete;
+    regex_tree& operator=(regex_tree&&) = delete;
+    ~regex_tree();
 
     void visit(const std::function<void(regex_node&)>& func) const;
     void print() const;
@@ -90,9 +106,12 @@ private:
     static void visit(const regex_node::node_ptr_t& node, const std::function<void(regex_node&)>& func);
     static void print(const regex_node::node_ptr_t& node, int indent = 0);
 
-    struct unordered_set_hash {
-        std::size_t operator()(const std::unordered_set<std::size_t>& s) const;
-    };
+    // 节点从 arena 中连续分配，随树一起释放
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+    std::vector<regex_node*> nodes;
+
+    template <class T, class... Args>
+    T* make(Args&&... args);
 
     static token_map_t disjoint_token_sets(const token_map_t& original);
 };
@@ -18,6 +18,11 @@ class sema : public T {
 public:
     static_assert(std::is_base_of<grammar::grammar_base, T>::value, "T must be a subclass of grammar::grammar_base");
     explicit sema(const std::vector<sema_production>& productions, std::ostream& oss = std::cout);
+
+    using T::parse;
+    std::shared_ptr<sema_tree> parse(const std::vector<lexer::token>& input, std::ostream& oss) const;
+    std::shared_ptr<sema_tree> parse(const std::vector<lexer::token>& input, grammar::parse_log& log, std::ostream& oss) const;
+    std::shared_ptr<sema_tree> reparse(const std::vector<lexer::token>& input, const lexer::lexer::damage& d, grammar::parse_log& log, std::ostream& oss) const;
 };
 } // namespace semantic
 
@@ -28,6 +33,27 @@ semantic::sema<T>::sema(const std::vector<sema_production>& productions, std::os
     this->tree_ = std::make_shared<sema_tree>(productions, oss);
 }
 
+template <typename T>
+std::shared_ptr<semantic::sema_tree> semantic::sema<T>::parse(const std::vector<lexer::token>& input, std::ostream& oss) const {
+    auto tree = std::make_shared<sema_tree>(*std::static_pointer_cast<sema_tree>(this->tree_), oss);
+    T::parse(input, *tree);
+    return tree;
+}
+
+template <typename T>
+std::shared_ptr<semantic::sema_tree> semantic::sema<T>::parse(const std::vector<lexer::token>& input, grammar::parse_log& log, std::ostream& oss) const {
+    auto tree = std::make_shared<sema_tree>(*std::static_pointer_cast<sema_tree>(this->tree_), oss);
+    T::parse(input, *tree, log);
+    return tree;
+}
+
+template <typename T>
+std::shared_ptr<semantic::sema_tree> semantic::sema<T>::reparse(const std::vector<lexer::token>& input, const lexer::lexer::damage& d, grammar::parse_log& log, std::ostream& oss) const {
+    auto tree = std::make_shared<sema_tree>(*std::static_pointer_cast<sema_tree>(this->tree_), oss);
+    T::reparse(input, d, *tree, log);
+    return tree;
+}
+
 #pragma endregion
 
 #endif
\ No newline at end of file
@@ -3,7 +3,9 @@
 #define SEMANTIC_SEMA_PRODUCTION_HPP
 
 #include "grammar/production.hpp"
+#include "ssa.hpp"
 
+#include <any>
 #include <functional>
 #include <memory>
 #include <unordered_map>
@@ -44,9 +46,11 @@ public:
     std::vector<std::string> errors;
     std::vector<std::unordered_map<std::string, std::shared_ptr<sema_symbol>>> symbols;
     symbol_table table;
+    ssa_builder ssa;
     std::size_t label_counter{0};
     std::size_t temp_counter{0};
     std::ostream* os;
+    std::any context;
 
     void error(const std::string& msg);
     sema_symbol& symbol(const std::string& name);
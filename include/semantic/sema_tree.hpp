@@ -5,6 +5,7 @@
 #include "grammar/tree.hpp"
 #include "sema_production.hpp"
 
+#include <any>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -27,17 +28,18 @@ struct sema_tree_node final : grammar::tree_node {
 class sema_tree final : public grammar::tree {
     using production = grammar::production::production;
 
-    std::unordered_map<production, sema_production> prod_map;
+    std::shared_ptr<const std::unordered_map<production, sema_production>> prod_map;
     std::ostream* os;
 
 public:
     explicit sema_tree(const std::vector<sema_production>& productions, std::ostream& oss = std::cout);
+    sema_tree(const sema_tree& other, std::ostream& oss);
 
     void add(const production& prod) override;
     void add_r(const production& prod) override;
     void print_node(const std::shared_ptr<grammar::tree_node>& node, int depth) const override;
 
-    sema_env calc() const;
+    sema_env calc(std::any context = {}) const;
 
 private:
     static void calc_node(const std::shared_ptr<grammar::tree_node>& node, sema_env& env);
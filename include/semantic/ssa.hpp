@@ -0,0 +1,63 @@
+#pragma once
+#ifndef SEMANTIC_SSA_HPP
+#define SEMANTIC_SSA_HPP
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace semantic {
+// 在语义动作中直接构造 SSA（Braun 等人，"Simple and Efficient Construction of Static Single Assignment Form"）
+// 变量和基本块都用名字标识，phi 命名为 "<变量>.<块>"
+class ssa_builder {
+public:
+    struct phi {
+        std::string name;
+        std::string var;
+        std::string type;
+        std::string block;
+        std::vector<std::pair<std::string, std::string>> operands; // (值, 前驱块)
+    };
+
+    inline static const std::string undef = "undef";
+
+    void declare(const std::string& var, const std::string& type);
+    void enter_block(const std::string& block);
+    [[nodiscard]] const std::string& current_block() const;
+    void add_predecessor(const std::string& block, const std::string& pred);
+    void seal_block(const std::string& block);
+    [[nodiscard]] bool is_sealed(const std::string& block) const;
+
+    void write_variable(const std::string& var, const std::string& value);
+    void write_variable(const std::string& var, const std::string& block, const std::string& value);
+    std::string read_variable(const std::string& var);
+    std::string read_variable(const std::string& var, const std::string& block);
+
+    [[nodiscard]] std::string resolve(const std::string& value) const;
+    [[nodiscard]] bool has_aliases() const;
+    [[nodiscard]] std::vector<phi> phis(const std::string& block) const;
+
+private:
+    std::string current;
+    std::unordered_map<std::string, std::string> types;
+    std::unordered_map<std::string, std::vector<std::string>> preds;
+    std::unordered_set<std::string> sealed;
+    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> defs;
+    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> incomplete;
+    std::unordered_map<std::string, phi> phi_map;
+    std::unordered_map<std::string, std::vector<std::string>> block_phis;
+    std::unordered_set<std::string> pending;
+    std::unordered_map<std::string, std::string> aliases;
+    // 值 -> 以它为操作数的 phi，删除平凡 phi 时只需检查这些 phi
+    std::unordered_multimap<std::string, std::string> users;
+
+    std::string read_variable_recursive(const std::string& var, const std::string& block);
+    std::string new_phi(const std::string& var, const std::string& block);
+    std::string add_phi_operands(const std::string& name);
+    std::string try_remove_trivial_phi(const std::string& name);
+};
+} // namespace semantic
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// 可选的 Chrome trace_event 记录，输出可以直接在 Perfetto 或 chrome://tracing 中打开
+// 未调用 start 时每个 span 只有一次原子读取的开销
+namespace trace {
+
+namespace detail {
+extern std::atomic<bool> active;
+}
+
+// 清空之前的记录并开始收集；action_sample 为 n 时每 n 个语义动作记录一个，为 0 时不记录语义动作
+void start(std::size_t action_sample = 0);
+void stop();
+
+inline bool enabled() {
+    return detail::active.load(std::memory_order_relaxed);
+}
+
+// 是否记录当前执行的语义动作
+bool sample_action();
+
+// 以 {"traceEvents": [...]} 的格式输出已收集的事件
+void write(std::ostream& os);
+
+// 作用域内的一段耗时，析构时记为一个完整事件（ph = "X"）
+class span {
+public:
+    explicit span(const char* name);
+    explicit span(std::string name);
+    ~span();
+    span(const span&) = delete;
+    span& operator=(const span&) = delete;
+
+private:
+    std::string name;
+    bool recording;
+    std::chrono::steady_clock::time_point begin;
+};
+
+} // namespace trace
+
+#endif
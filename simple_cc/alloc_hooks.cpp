@@ -0,0 +1,50 @@
+#include "time_report.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// 替换全局的 operator new / delete 以统计分配；只链接进 simple_cc，性能测试等其他程序使用标准库的分配器
+// 对齐版本仍使用标准库的实现
+
+namespace {
+
+void* allocate(const std::size_t size) {
+    ++time_report::detail::allocated_count;
+    time_report::detail::allocated_bytes += size;
+    while (true) {
+        if (void* p = std::malloc(size ? size : 1)) {
+            return p;
+        }
+        const auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+} // namespace
+
+void* operator new(const std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](const std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
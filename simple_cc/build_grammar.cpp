@@ -18,7 +18,7 @@ std::vector<semantic::sema_production> build_grammar() {
              env.emit("; ModuleID = 'main'");
              env.emit("");
 
-             for (const auto& [content, var_name] : strings) {
+             for (const auto& [content, var_name] : unit_of(env).strings) {
                  size_t str_len = content.length() + 1; // +1 for null terminator
                  env.emit("@" + var_name + " = private unnamed_addr constant ["
                           + std::to_string(str_len) + " x i8] c" + to_llvmstr(content) + ", align 1");
@@ -29,7 +29,8 @@ std::vector<semantic::sema_production> build_grammar() {
              env.emit("declare i32 @scanf(i8*, ...)");
              env.emit("");
              env.emit("define i32 @main() {");
-             env.emit("entry:");
+             emit_label(env, "entry");
+             env.ssa.seal_block("entry");
          ),
          "compoundstmt",
          ACT(
@@ -70,15 +71,21 @@ std::vector<semantic::sema_production> build_grammar() {
              std::string var_type = type.syn["type"];
              // 使用唯一的变量名（在符号表中存储原名，在LLVM IR中使用唯一名）
              std::string unique_var_name = "%" + ID.lexval + "_" + env.temp();
-             env.table.insert(ID.lexval, {{"type", var_type}, {"llvm_name", unique_var_name}});
+             bool is_ssa = !unit_of(env).address_taken.contains(ID.lexval);
+             env.table.insert(ID.lexval, {{"type", var_type}, {"llvm_name", unique_var_name}, {"ssa", is_ssa ? "true" : "false"}});
              std::string expr_reg = expr.syn["reg"];
              std::string expr_type = expr.syn["type"];
 
              // 类型转换
              expr_reg = convert_type(env, expr_reg, expr_type, var_type);
 
-             emit_alloca(env, unique_var_name, var_type);
-             emit_store(env, expr_reg, unique_var_name, var_type);
+             if (is_ssa) {
+                 env.ssa.declare(unique_var_name, var_type);
+                 env.ssa.write_variable(unique_var_name, expr_reg);
+             } else {
+                 emit_alloca(env, unique_var_name, var_type);
+                 emit_store(env, expr_reg, unique_var_name, var_type);
+             }
          )
         },
 
@@ -90,10 +97,15 @@ std::vector<semantic::sema_production> build_grammar() {
              std::string var_type = type.syn["type"];
              // 使用唯一的变量名
              std::string unique_var_name = "%" + ID.lexval + "_" + env.temp();
-             env.table.insert(ID.lexval, {{"type", var_type}, {"llvm_name", unique_var_name}});
+             bool is_ssa = !unit_of(env).address_taken.contains(ID.lexval);
+             env.table.insert(ID.lexval, {{"type", var_type}, {"llvm_name", unique_var_name}, {"ssa", is_ssa ? "true" : "false"}});
 
              // 只分配内存，不进行初始化
-             emit_alloca(env, unique_var_name, var_type);
+             if (is_ssa) {
+                 env.ssa.declare(unique_var_name, var_type);
+             } else {
+                 emit_alloca(env, unique_var_name, var_type);
+             }
          )
         },
 
@@ -137,24 +149,27 @@ std::vector<semantic::sema_production> build_grammar() {
 
              auto cond = convert_to_i1(env, expr.syn["reg"], expr.syn["type"]);
 
-             env.emit("  br i1 " + cond + ", label %" + then_label + ", label %" + else_label);
-             env.emit(then_label + ":");
+             emit_cond_br(env, cond, then_label, else_label);
+             emit_label(env, then_label);
+             env.ssa.seal_block(then_label);
          ),
          "stmt",
          ACT(
              GET(stmt);
              std::string else_label = stmt.inh["else"];
              std::string end_label = stmt.inh["end"];
-             env.emit("  br label %" + end_label);
-             env.emit(else_label + ":");
+             emit_br(env, end_label);
+             emit_label(env, else_label);
+             env.ssa.seal_block(else_label);
          ),
          "else",
          "stmt",
          ACT(
              GETI(stmt, 1);
              std::string end_label = stmt_1.inh["end"];
-             env.emit("  br label %" + end_label);
-             env.emit(end_label + ":");
+             emit_br(env, end_label);
+             emit_label(env, end_label);
+             env.ssa.seal_block(end_label);
          )
         },
 
@@ -170,15 +185,17 @@ std::vector<semantic::sema_production> build_grammar() {
 
              auto cond = convert_to_i1(env, expr.syn["reg"], expr.syn["type"]);
 
-             env.emit("  br i1 " + cond + ", label %" + then_label + ", label %" + end_label);
-             env.emit(then_label + ":");
+             emit_cond_br(env, cond, then_label, end_label);
+             emit_label(env, then_label);
+             env.ssa.seal_block(then_label);
          ),
          "stmt",
          ACT(
              GET(stmt);
              std::string end_label = stmt.inh["end"];
-             env.emit("  br label %" + end_label);
-             env.emit(end_label + ":");
+             emit_br(env, end_label);
+             emit_label(env, end_label);
+             env.ssa.seal_block(end_label);
          )
         },
 
@@ -209,8 +226,8 @@ std::vector<semantic::sema_production> build_grammar() {
              GET(forinit);
              auto cond_label = forinit.inh["cond_label"];
 
-             env.emit("  br label %" + cond_label);
-             env.emit(cond_label + ":");
+             emit_br(env, cond_label);
+             emit_label(env, cond_label);
          ),
          "expr", ";",
          ACT(
@@ -221,9 +238,9 @@ std::vector<semantic::sema_production> build_grammar() {
 
              // test expr
              auto cond = convert_to_i1(env, expr.syn["reg"], expr.syn["type"]);
-             env.emit("  br i1 " + cond + ", label %" + body_label + ", label %" + end_label);
+             emit_cond_br(env, cond, body_label, end_label);
 
-             env.emit(update_label + ":");
+             emit_label(env, update_label);
          ),
          "forupdate", ")",
          ACT(
@@ -231,9 +248,11 @@ std::vector<semantic::sema_production> build_grammar() {
              auto cond_label = stmt.inh["cond_label"];
              auto body_label = stmt.inh["body_label"];
 
-             env.emit("  br label %" + cond_label);
+             emit_br(env, cond_label);
+             env.ssa.seal_block(cond_label);
 
-             env.emit(body_label + ":");
+             emit_label(env, body_label);
+             env.ssa.seal_block(body_label);
          ),
          "stmt",
          ACT(
@@ -242,8 +261,10 @@ std::vector<semantic::sema_production> build_grammar() {
              std::string end_label = stmt.inh["end_label"];
 
              // 跳转到更新部分
-             env.emit("  br label %" + update_label);
-             env.emit(end_label + ":");
+             emit_br(env, update_label);
+             env.ssa.seal_block(update_label);
+             emit_label(env, end_label);
+             env.ssa.seal_block(end_label);
 
              env.table.exit_scope();
          )
@@ -271,7 +292,11 @@ std::vector<semantic::sema_production> build_grammar() {
 
              expr_reg = convert_type(env, expr_reg, expr_type, var_type);
 
-             emit_store(env, expr_reg, var_name, var_type);
+             if (table_ID->at("ssa") == "true") {
+                 env.ssa.write_variable(var_name, expr_reg);
+             } else {
+                 emit_store(env, expr_reg, var_name, var_type);
+             }
          )
         },
 
@@ -287,8 +312,8 @@ std::vector<semantic::sema_production> build_grammar() {
              whilestmt.syn["body_label"] = body_label;
              whilestmt.syn["end_label"] = end_label;
 
-             env.emit("  br label %" + cond_label);
-             env.emit(cond_label + ":");
+             emit_br(env, cond_label);
+             emit_label(env, cond_label);
          ),
          "(", "expr", ")",
          ACT(
@@ -298,9 +323,10 @@ std::vector<semantic::sema_production> build_grammar() {
              auto end_label = whilestmt.syn["end_label"];
 
              auto cond = convert_to_i1(env, expr.syn["reg"], expr.syn["type"]);
-             env.emit("  br i1 " + cond + ", label %" + body_label + ", label %" + end_label);
+             emit_cond_br(env, cond, body_label, end_label);
 
-             env.emit(body_label + ":");
+             emit_label(env, body_label);
+             env.ssa.seal_block(body_label);
          ),
          "stmt",
          ACT(
@@ -309,8 +335,10 @@ std::vector<semantic::sema_production> build_grammar() {
              std::string end_label = whilestmt.syn["end_label"];
 
              // 循环体执行完后跳回条件检查
-             env.emit("  br label %" + cond_label);
-             env.emit(end_label + ":");
+             emit_br(env, cond_label);
+             env.ssa.seal_block(cond_label);
+             emit_label(env, end_label);
+             env.ssa.seal_block(end_label);
          )
         },
 
@@ -331,7 +359,11 @@ std::vector<semantic::sema_production> build_grammar() {
 
              expr_reg = convert_type(env, expr_reg, expr_type, var_type);
 
-             emit_store(env, expr_reg, var_name, var_type);
+             if (table_ID->at("ssa") == "true") {
+                 env.ssa.write_variable(var_name, expr_reg);
+             } else {
+                 emit_store(env, expr_reg, var_name, var_type);
+             }
          )
         },
 
@@ -377,12 +409,17 @@ std::vector<semantic::sema_production> build_grammar() {
              std::string left_i1 = convert_to_i1(env, left_reg, left_type);
              std::string right_i1 = convert_to_i1(env, right_reg, right_type);
 
-             // 逻辑或运算
-             env.emit("  " + result_reg + " = or i1 " + left_i1 + ", " + right_i1);
+             std::string final_reg;
+             if (is_const(left_i1) && is_const(right_i1)) {
+                 final_reg = (left_i1 == "true" || right_i1 == "true") ? "1" : "0";
+             } else {
+                 // 逻辑或运算
+                 env.emit("  " + result_reg + " = or i1 " + left_i1 + ", " + right_i1);
 
-             // 将结果扩展为i32
-             std::string final_reg = "%" + env.temp();
-             env.emit("  " + final_reg + " = zext i1 " + result_reg + " to i32");
+                 // 将结果扩展为i32
+                 final_reg = "%" + env.temp();
+                 env.emit("  " + final_reg + " = zext i1 " + result_reg + " to i32");
+             }
 
              // 为下一个logorprime设置继承属性
              GETI(logorprime, 1);
@@ -437,12 +474,17 @@ std::vector<semantic::sema_production> build_grammar() {
              std::string left_i1 = convert_to_i1(env, left_reg, left_type);
              std::string right_i1 = convert_to_i1(env, right_reg, right_type);
 
-             // 逻辑与运算
-             env.emit("  " + result_reg + " = and i1 " + left_i1 + ", " + right_i1);
+             std::string final_reg;
+             if (is_const(left_i1) && is_const(right_i1)) {
+                 final_reg = (left_i1 == "true" && right_i1 == "true") ? "1" : "0";
+             } else {
+                 // 逻辑与运算
+                 env.emit("  " + result_reg + " = and i1 " + left_i1 + ", " + right_i1);
 
-             // 将结果扩展为i32
-             std::string final_reg = "%" + env.temp();
-             env.emit("  " + final_reg + " = zext i1 " + result_reg + " to i32");
+                 // 将结果扩展为i32
+                 final_reg = "%" + env.temp();
+                 env.emit("  " + final_reg + " = zext i1 " + result_reg + " to i32");
+             }
 
              // 为下一个logandprime设置继承属性
              GETI(logandprime, 1);
@@ -498,7 +540,11 @@ std::vector<semantic::sema_production> build_grammar() {
              left_reg = convert_type(env, left_reg, left_type, result_type);
              right_reg = convert_type(env, right_reg, right_type, result_type);
 
-             emit_bitor(env, result_reg, left_reg, right_reg, result_type);
+             if (auto folded = fold_binary("|", left_reg, right_reg, result_type); !folded.empty()) {
+                 result_reg = folded;
+             } else {
+                 emit_bitor(env, result_reg, left_reg, right_reg, result_type);
+             }
 
              GETI(bitorprime, 1);
              bitorprime_1.inh["reg"] = result_reg;
@@ -553,7 +599,11 @@ std::vector<semantic::sema_production> build_grammar() {
              left_reg = convert_type(env, left_reg, left_type, result_type);
              right_reg = convert_type(env, right_reg, right_type, result_type);
 
-             emit_bitxor(env, result_reg, left_reg, right_reg, result_type);
+             if (auto folded = fold_binary("^", left_reg, right_reg, result_type); !folded.empty()) {
+                 result_reg = folded;
+             } else {
+                 emit_bitxor(env, result_reg, left_reg, right_reg, result_type);
+             }
 
              // 为下一个bitxorprime设置继承属性
              GETI(bitxorprime, 1);
@@ -609,7 +659,11 @@ std::vector<semantic::sema_production> build_grammar() {
              left_reg = convert_type(env, left_reg, left_type, result_type);
              right_reg = convert_type(env, right_reg, right_type, result_type);
 
-             emit_bitand(env, result_reg, left_reg, right_reg, result_type);
+             if (auto folded = fold_binary("&", left_reg, right_reg, result_type); !folded.empty()) {
+                 result_reg = folded;
+             } else {
+                 emit_bitand(env, result_reg, left_reg, right_reg, result_type);
+             }
 
              // 为下一个bitandprime设置继承属性
              GETI(bitandprime, 1);
@@ -663,6 +717,12 @@ std::vector<semantic::sema_production> build_grammar() {
              std::string op = relop.syn["op"];
 
              std::string result_type = convert_operands(env, lhs_reg, rhs_reg, lhs_type, rhs_type);
+             if (auto folded = fold_compare(op, lhs_reg, rhs_reg, result_type); !folded.empty()) {
+                 relprime.syn["reg"] = folded;
+                 relprime.syn["type"] = "int";
+                 return;
+             }
+
              std::string cmp_op;
              if (op == "<")
                  cmp_op = "lt";
@@ -746,7 +806,11 @@ std::vector<semantic::sema_production> build_grammar() {
              // 使用通用操作数转换函数
              std::string result_type = convert_operands(env, left_reg, right_reg, left_type, right_type);
 
-             emit_add(env, result_reg, left_reg, right_reg, result_type);
+             if (auto folded = fold_binary("+", left_reg, right_reg, result_type); !folded.empty()) {
+                 result_reg = folded;
+             } else {
+                 emit_add(env, result_reg, left_reg, right_reg, result_type);
+             }
 
              // 为下一个arithexprprime设置继承属性
              GETI(arithexprprime, 1);
@@ -776,7 +840,11 @@ std::vector<semantic::sema_production> build_grammar() {
              // 使用通用操作数转换函数
              std::string result_type = convert_operands(env, left_reg, right_reg, left_type, right_type);
 
-             emit_sub(env, result_reg, left_reg, right_reg, result_type);
+             if (auto folded = fold_binary("-", left_reg, right_reg, result_type); !folded.empty()) {
+                 result_reg = folded;
+             } else {
+                 emit_sub(env, result_reg, left_reg, right_reg, result_type);
+             }
 
              // 为下一个arithexprprime设置继承属性
              GETI(arithexprprime, 1);
@@ -831,7 +899,11 @@ std::vector<semantic::sema_production> build_grammar() {
 
              std::string result_type = convert_operands(env, left_reg, right_reg, left_type, right_type);
 
-             emit_mul(env, result_reg, left_reg, right_reg, result_type);
+             if (auto folded = fold_binary("*", left_reg, right_reg, result_type); !folded.empty()) {
+                 result_reg = folded;
+             } else {
+                 emit_mul(env, result_reg, left_reg, right_reg, result_type);
+             }
 
              // 为下一个multexprprime设置继承属性
              GETI(multexprprime, 1);
@@ -861,7 +933,11 @@ std::vector<semantic::sema_production> build_grammar() {
              // 使用通用操作数转换函数
              std::string result_type = convert_operands(env, left_reg, right_reg, left_type, right_type);
 
-             emit_div(env, result_reg, left_reg, right_reg, result_type);
+             if (auto folded = fold_binary("/", left_reg, right_reg, result_type); !folded.empty()) {
+                 result_reg = folded;
+             } else {
+                 emit_div(env, result_reg, left_reg, right_reg, result_type);
+             }
 
              // 为下一个multexprprime设置继承属性
              GETI(multexprprime, 1);
@@ -905,6 +981,13 @@ std::vector<semantic::sema_production> build_grammar() {
              std::string operand_type = unaryexpr_1.syn["type"];
              std::string result_reg = "%" + env.temp();
 
+             std::string zero = operand_type == "double" ? make_const(0.0) : "0";
+             if (auto folded = fold_binary("-", zero, operand_reg, operand_type); !folded.empty()) {
+                 unaryexpr.syn["reg"] = folded;
+                 unaryexpr.syn["type"] = operand_type;
+                 return;
+             }
+
              // 一元负号：根据类型生成相应的LLVM IR
              if (operand_type == "int") {
                  env.emit("  " + result_reg + " = sub nsw i32 0, " + operand_reg);
@@ -936,6 +1019,11 @@ std::vector<semantic::sema_production> build_grammar() {
 
              // 逻辑取反：先转换为i1，然后取反，再扩展为i32
              std::string i1_reg = convert_to_i1(env, operand_reg, operand_type);
+             if (is_const(i1_reg)) {
+                 unaryexpr.syn["reg"] = i1_reg == "true" ? "0" : "1";
+                 unaryexpr.syn["type"] = "int";
+                 return;
+             }
              std::string not_reg = "%" + env.temp();
              env.emit("  " + not_reg + " = xor i1 " + i1_reg + ", true");
              env.emit("  " + result_reg + " = zext i1 " + not_reg + " to i32");
@@ -954,6 +1042,14 @@ std::vector<semantic::sema_production> build_grammar() {
              std::string operand_type = unaryexpr_1.syn["type"];
              std::string result_reg = "%" + env.temp();
 
+             if (operand_type == "int" || operand_type == "long") {
+                 if (auto folded = fold_binary("^", operand_reg, "-1", operand_type); !folded.empty()) {
+                     unaryexpr.syn["reg"] = folded;
+                     unaryexpr.syn["type"] = operand_type;
+                     return;
+                 }
+             }
+
              // 按位取反，支持整数类型
              if (operand_type == "int") {
                  env.emit("  " + result_reg + " = xor i32 " + operand_reg + ", -1");
@@ -1015,11 +1111,16 @@ std::vector<semantic::sema_production> build_grammar() {
                  env.error(ID.lexval + " is not defined");
                  return;
              }
-             std::string result_reg = "%" + env.temp();
+             std::string result_reg;
              std::string var_name = table_entry->at("llvm_name");
              std::string var_type = table_entry->at("type");
 
-             emit_load(env, result_reg, var_name, var_type);
+             if (table_entry->at("ssa") == "true") {
+                 result_reg = env.ssa.read_variable(var_name);
+             } else {
+                 result_reg = "%" + env.temp();
+                 emit_load(env, result_reg, var_name, var_type);
+             }
              simpleexpr.syn["reg"] = result_reg;
              simpleexpr.syn["type"] = var_type;
 
@@ -1035,9 +1136,7 @@ std::vector<semantic::sema_production> build_grammar() {
          ACT(
              GET(simpleexpr);
              GET(INTNUM);
-             std::string result_reg = "%" + env.temp();
-             env.emit("  " + result_reg + " = add i32 0, " + INTNUM.lexval);
-             simpleexpr.syn["reg"] = result_reg;
+             simpleexpr.syn["reg"] = make_const(std::stoll(INTNUM.lexval), "int");
              simpleexpr.syn["type"] = "int";
          )
         },
@@ -1047,9 +1146,7 @@ std::vector<semantic::sema_production> build_grammar() {
          ACT(
              GET(simpleexpr);
              GET(DOUBLENUM);
-             std::string result_reg = "%" + env.temp();
-             env.emit("  " + result_reg + " = fadd double 0.0, " + DOUBLENUM.lexval);
-             simpleexpr.syn["reg"] = result_reg;
+             simpleexpr.syn["reg"] = make_const(std::stod(DOUBLENUM.lexval));
              simpleexpr.syn["type"] = "double";
          )
         },
@@ -1062,7 +1159,7 @@ std::vector<semantic::sema_production> build_grammar() {
 
              // 处理字符串字面量
              std::string content = process_string_literal(STRING.lexval);
-             std::string str_label = strings[content];
+             std::string str_label = unit_of(env).strings.at(content);
              std::string str_size = std::to_string(content.length() + 1);
 
              // 创建指向字符串的指针
@@ -1,6 +1,7 @@
 #include "include/build_lexer.hpp"
 #include "lexer/lexer.hpp"
-#include <ranges>
+
+#include <thread>
 
 const lexer::lexer::input_keywords_t<token_type> keywords = {
     {"int", token_type::INT, "int"},
@@ -46,8 +47,6 @@ const std::unordered_set<std::string> terminals{
     "/", "<", "<=", ">", ">=", "==", "!=", "=", "ID", "INTNUM", "DOUBLENUM",
     "&", "|", "^", "&&", "||", ",", "STRING", "!", "~"};
 
-std::map<std::string, std::string> strings;
-
 std::string process_string_literal(const std::string& literal) {
     if (literal.length() < 2) return "";
 
@@ -100,24 +99,30 @@ std::string trim_zero(std::string s) {
     return s;
 }
 
-std::vector<lexer::token> lex(const std::string& str) {
-    std::vector<lexer::token> tokens;
-
-    const lexer::lexer lex_(keywords, token_type::WHITESPACE);
-
-    auto filtered = lex_.parse(str)
-        | std::views::filter([](const lexer::token& t) { return t.type != static_cast<int>(token_type::WHITESPACE)
-                                                             && t.type != static_cast<int>(token_type::COMMENT); });
+lexer::lexer build_lexer() {
+    lexer::lexer lex_{keywords, token_type::WHITESPACE};
+    lex_.skip(token_type::COMMENT);
+    return lex_;
+}
 
+void collect_unit(const std::vector<lexer::token>& tokens, compile_unit& unit) {
     int string_counter = 0;
-    for (auto& token : filtered) {
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        const auto& token = tokens[i];
         if (token.type == static_cast<int>(token_type::STRING)) {
-            if (std::string content = process_string_literal(token.value); !strings.contains(content)) {
-                strings[content] = ".str." + std::to_string(string_counter++);
+            if (std::string content = process_string_literal(token.value); !unit.strings.contains(content)) {
+                unit.strings[content] = ".str." + std::to_string(string_counter++);
             }
+        } else if (token.type == static_cast<int>(token_type::ID) && i > 0
+                   && tokens[i - 1].type == static_cast<int>(token_type::BITAND)) {
+            unit.address_taken.insert(token.value);
         }
-        tokens.emplace_back(token);
     }
+}
 
+std::vector<lexer::token> lex(const lexer::lexer& lex_, const std::string& str, compile_unit& unit) {
+    // 输入较小时 parse_parallel 直接顺序分析
+    auto tokens = lex_.parse_parallel(str, std::thread::hardware_concurrency());
+    collect_unit(tokens, unit);
     return tokens;
 }
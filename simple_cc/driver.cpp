@@ -0,0 +1,107 @@
+#include "driver.hpp"
+#include "build_lexer.hpp"
+#include "helper.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+bool finish_frontend(const std::shared_ptr<semantic::sema_tree>& tree, compile_unit& unit, std::stringstream& raw_il,
+                     std::ostream& il, std::vector<std::string>& diagnostics, time_report::report* report = nullptr) {
+    if (report) {
+        std::size_t nodes = 0;
+        tree->visit([&](const auto&) { ++nodes; });
+        report->count("tree_nodes", nodes);
+    }
+
+    auto env = [&] {
+        const time_report::scope scope(report, "semantic");
+        return tree->calc(&unit);
+    }();
+
+    if (!env.errors.empty()) {
+        diagnostics.insert(diagnostics.end(), env.errors.begin(), env.errors.end());
+        return false;
+    }
+
+    const time_report::scope scope(report, "phi");
+    insert_phis(env, raw_il, il);
+    return true;
+}
+
+} // namespace
+
+bool compile_frontend(const std::string& source, const lexer::lexer& lex_, const parser_t& parser,
+                      std::ostream& il, std::vector<std::string>& diagnostics, time_report::report* report) {
+    compile_unit unit;
+    std::stringstream raw_il;
+    std::shared_ptr<semantic::sema_tree> tree;
+    try {
+        std::vector<lexer::token> tokens;
+        {
+            const time_report::scope scope(report, "lex");
+            tokens = lex(lex_, source, unit);
+        }
+        if (report) {
+            report->count("tokens", tokens.size());
+        }
+        const time_report::scope scope(report, "parse");
+        tree = parser.parse(tokens, raw_il);
+    } catch (const std::exception& e) {
+        diagnostics.emplace_back(e.what());
+        return false;
+    }
+    return finish_frontend(tree, unit, raw_il, il, diagnostics, report);
+}
+
+void open_document(document& doc, std::string source, const lexer::lexer& lex_) {
+    doc.source = std::move(source);
+    doc.tokens = lex_.parse(doc.source);
+    doc.log = {};
+    doc.pending.reset();
+    doc.relexed = doc.tokens.size();
+}
+
+void edit_document(document& doc, const std::size_t offset, const std::size_t length, const std::string& text,
+                   const lexer::lexer& lex_) {
+    if (offset > doc.source.size() || length > doc.source.size() - offset) {
+        throw std::out_of_range("edit out of range");
+    }
+    doc.source.replace(offset, length, text);
+    const auto d = lex_.relex(doc.source, doc.tokens, {offset, length, text.size()});
+    doc.relexed = d.new_end - d.first;
+
+    if (!doc.pending) {
+        doc.pending = d;
+        return;
+    }
+    // 合并两次修改：取两段修改区域在中间序列上的并集
+    const auto& prev = *doc.pending;
+    const auto end = std::max(prev.new_end, d.old_end);
+    doc.pending = lexer::lexer::damage{std::min(prev.first, d.first), end - prev.new_end + prev.old_end,
+                                       end - d.old_end + d.new_end};
+}
+
+bool compile_frontend(document& doc, const parser_t& parser, std::ostream& il, std::vector<std::string>& diagnostics) {
+    compile_unit unit;
+    collect_unit(doc.tokens, unit);
+    std::stringstream raw_il;
+    std::shared_ptr<semantic::sema_tree> tree;
+    try {
+        if (!doc.log.stacks.empty()) {
+            const auto n = doc.tokens.size();
+            tree = parser.reparse(doc.tokens, doc.pending.value_or(lexer::lexer::damage{n, n, n}), doc.log, raw_il);
+        } else {
+            tree = parser.parse(doc.tokens, doc.log, raw_il);
+        }
+    } catch (const std::exception& e) {
+        doc.log = {};
+        doc.pending.reset();
+        diagnostics.emplace_back(e.what());
+        return false;
+    }
+    doc.pending.reset();
+    return finish_frontend(tree, unit, raw_il, il, diagnostics);
+}
@@ -0,0 +1,328 @@
+#include "generator.hpp"
+
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace generator {
+
+namespace {
+
+enum class type {
+    int_,
+    long_,
+    double_
+};
+
+const char* type_name(const type t) {
+    switch (t) {
+    case type::int_: return "int";
+    case type::long_: return "long";
+    default: return "double";
+    }
+}
+
+const char* format_of(const type t) {
+    switch (t) {
+    case type::int_: return "%d";
+    case type::long_: return "%ld";
+    default: return "%f";
+    }
+}
+
+struct variable {
+    std::string name;
+    type t;
+    // 循环变量只读，保证循环一定结束
+    bool assignable;
+};
+
+// 表达式文本及其在 C 语义下的类型
+struct expr_t {
+    std::string text;
+    type t;
+    bool leaf;
+};
+
+class writer {
+public:
+    writer(std::ostream& os, const options& opts) : os(os), opts(opts), rng(opts.seed) {}
+
+    void run() {
+        line("int main() {");
+        ++indent;
+        // 主函数体由逐级增大的语句块组成，每块至多 block_size 条语句，stmts 链的长度因此有界
+        for (std::size_t level = 0; !full(); ++level) {
+            region(level);
+        }
+        --indent;
+        line("}");
+        flush();
+    }
+
+private:
+    static constexpr std::size_t flush_bytes = 1 << 16;
+
+    std::ostream& os;
+    const options& opts;
+    // 只使用 mt19937_64 的原始输出，标准库的分布在不同实现下结果不同
+    std::mt19937_64 rng;
+    std::string buf;
+    std::size_t written = 0;
+    std::size_t indent = 0;
+    std::size_t next_id = 0;
+    std::vector<variable> vars;
+    std::vector<std::size_t> scopes;
+
+    std::size_t below(const std::size_t n) { return rng() % n; }
+    bool chance(const std::size_t percent) { return below(100) < percent; }
+
+    [[nodiscard]] bool full() const { return written + buf.size() + 2 >= opts.bytes; }
+
+    void flush() {
+        os.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        written += buf.size();
+        buf.clear();
+    }
+
+    void line(const std::string& s) {
+        buf.append(indent * 4, ' ');
+        buf += s;
+        buf += '\n';
+        if (buf.size() >= flush_bytes) {
+            flush();
+        }
+    }
+
+    std::string fresh(const char* prefix) { return prefix + std::to_string(next_id++); }
+
+    void enter() { scopes.push_back(vars.size()); }
+    void exit() {
+        vars.resize(scopes.back());
+        scopes.pop_back();
+    }
+
+    // 随机选取一个可见变量，没有符合条件的变量时返回 nullptr
+    const variable* pick(const bool integral, const bool assignable) {
+        std::size_t count = 0;
+        const variable* chosen = nullptr;
+        for (const auto& v : vars) {
+            if ((integral && v.t == type::double_) || (assignable && !v.assignable)) {
+                continue;
+            }
+            // 蓄水池抽样
+            if (below(++count) == 0) {
+                chosen = &v;
+            }
+        }
+        return chosen;
+    }
+
+    static std::string wrap(const expr_t& e) { return e.leaf ? e.text : "(" + e.text + ")"; }
+
+    static type promote(const type a, const type b) {
+        if (a == type::double_ || b == type::double_) {
+            return type::double_;
+        }
+        return a == type::long_ || b == type::long_ ? type::long_ : type::int_;
+    }
+
+    expr_t leaf(const bool integral) {
+        if (!integral && chance(40)) {
+            return {std::to_string(below(100)) + "." + std::to_string(below(100)), type::double_, true};
+        }
+        if (chance(60)) {
+            if (const auto* v = pick(integral, false)) {
+                return {v->name, v->t, true};
+            }
+        }
+        return {std::to_string(below(1000)), type::int_, true};
+    }
+
+    // integral 为 true 时只使用整型操作数，位运算和取反只出现在整型表达式中
+    expr_t expr(const bool integral, const std::size_t depth) {
+        if (depth == 0 || chance(25)) {
+            return leaf(integral);
+        }
+        const auto lhs = expr(integral, depth - 1);
+        switch (below(integral ? 8 : 5)) {
+        case 0: {
+            static const char* ops[] = {"+", "-", "*"};
+            const auto rhs = expr(integral, depth - 1);
+            return {wrap(lhs) + " " + ops[below(3)] + " " + wrap(rhs), promote(lhs.t, rhs.t), false};
+        }
+        case 1: {
+            // 除数总是非零常量
+            const auto divisor = lhs.t == type::double_ ? std::to_string(below(9) + 1) + ".5" : std::to_string(below(9) + 1);
+            return {wrap(lhs) + " / " + divisor, lhs.t, false};
+        }
+        case 2: {
+            static const char* ops[] = {"<", "<=", ">", ">=", "==", "!="};
+            const auto rhs = expr(integral, depth - 1);
+            return {wrap(lhs) + " " + ops[below(6)] + " " + wrap(rhs), type::int_, false};
+        }
+        case 3: return {"-" + wrap(lhs), lhs.t, false};
+        case 4: {
+            static const char* ops[] = {"&&", "||"};
+            const auto rhs = expr(integral, depth - 1);
+            return {wrap(lhs) + " " + ops[below(2)] + " " + wrap(rhs), type::int_, false};
+        }
+        case 5: {
+            static const char* ops[] = {"&", "|", "^"};
+            const auto rhs = expr(integral, depth - 1);
+            return {wrap(lhs) + " " + ops[below(3)] + " " + wrap(rhs), promote(lhs.t, rhs.t), false};
+        }
+        case 6: return {"~" + wrap(lhs), lhs.t, false};
+        default: return {"!" + wrap(lhs), type::int_, false};
+        }
+    }
+
+    expr_t value_of(const type t) { return expr(t != type::double_, below(opts.expr_depth + 1)); }
+
+    void declaration() {
+        const auto t = static_cast<type>(below(3));
+        const auto name = fresh("v");
+        if (chance(20)) {
+            line(std::string(type_name(t)) + " " + name + ";");
+            line(name + " = " + value_of(t).text + ";");
+        } else {
+            line(std::string(type_name(t)) + " " + name + " = " + value_of(t).text + ";");
+        }
+        vars.push_back({name, t, true});
+    }
+
+    void assignment() {
+        const auto* v = pick(false, true);
+        if (!v) {
+            declaration();
+            return;
+        }
+        line(v->name + " = " + value_of(v->t).text + ";");
+    }
+
+    void call() {
+        const auto id = fresh("p");
+        std::string format = id + ":";
+        std::string args;
+        for (std::size_t i = 0, n = below(3) + 1; i < n; ++i) {
+            const auto e = value_of(chance(30) ? type::double_ : type::int_);
+            format += std::string(" ") + format_of(e.t);
+            args += ", " + e.text;
+        }
+        line("printf(\"" + format + "\\n\"" + args + ");");
+    }
+
+    void comment() {
+        if (chance(50)) {
+            line("// " + fresh("note "));
+        } else {
+            line("/* " + fresh("block ") + " * " + std::to_string(below(1000)) + " */");
+        }
+    }
+
+    // 以 { 开始、} 结束的语句块，语句数在 1 到 limit 之间
+    void block(const std::size_t depth, const std::size_t limit) {
+        line("{");
+        ++indent;
+        enter();
+        for (std::size_t i = 0, n = below(limit) + 1; i < n && !full(); ++i) {
+            stmt(depth);
+        }
+        exit();
+        --indent;
+        line("}");
+    }
+
+    // 控制语句的语句体较短，保证嵌套展开的期望大小有限
+    void body(const std::size_t depth) { block(depth + 1, 4); }
+
+    void if_stmt(const std::size_t depth) {
+        line("if (" + value_of(type::int_).text + ")");
+        body(depth);
+        if (chance(50)) {
+            line("else");
+            body(depth);
+        }
+    }
+
+    void for_stmt(const std::size_t depth) {
+        const auto i = fresh("i");
+        const auto trips = std::to_string(below(4) + 1);
+        line("for (int " + i + " = 0; " + i + " < " + trips + "; " + i + " = " + i + " + 1)");
+        enter();
+        vars.push_back({i, type::int_, false});
+        body(depth);
+        exit();
+    }
+
+    void while_stmt(const std::size_t depth) {
+        const auto w = fresh("w");
+        line("int " + w + " = 0;");
+        vars.push_back({w, type::int_, false});
+        line("while (" + w + " < " + std::to_string(below(4) + 1) + ") {");
+        ++indent;
+        enter();
+        for (std::size_t i = 0, n = below(3) + 1; i < n && !full(); ++i) {
+            stmt(depth + 1);
+        }
+        exit();
+        line(w + " = " + w + " + 1;");
+        --indent;
+        line("}");
+    }
+
+    void stmt(const std::size_t depth) {
+        const bool nested = depth < opts.max_depth && chance(depth == 0 ? 30 : 15);
+        if (nested) {
+            switch (below(4)) {
+            case 0: if_stmt(depth); return;
+            case 1: for_stmt(depth); return;
+            case 2: while_stmt(depth); return;
+            default: block(depth + 1, 4); return;
+            }
+        }
+        switch (below(10)) {
+        case 0:
+        case 1:
+        case 2: declaration(); return;
+        case 3:
+        case 4:
+        case 5: assignment(); return;
+        case 6:
+        case 7: call(); return;
+        case 8: comment(); return;
+        default: line(";"); return;
+        }
+    }
+
+    // level 为 0 时是普通语句块，否则由至多 block_size 个下一级的块组成
+    void region(const std::size_t level) {
+        line("{");
+        ++indent;
+        enter();
+        for (std::size_t i = 0; i < opts.block_size && !full(); ++i) {
+            if (level == 0) {
+                stmt(0);
+            } else {
+                region(level - 1);
+            }
+        }
+        exit();
+        --indent;
+        line("}");
+    }
+};
+
+} // namespace
+
+void generate(std::ostream& os, const options& opts) {
+    writer(os, opts).run();
+}
+
+std::string generate(const options& opts) {
+    std::ostringstream os;
+    generate(os, opts);
+    return os.str();
+}
+
+} // namespace generator
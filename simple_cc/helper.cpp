@@ -1,13 +1,119 @@
 #include "helper.hpp"
+#include "build_lexer.hpp"
 #include "semantic/sema_production.hpp"
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
 
+compile_unit& unit_of(semantic::sema_env& env) {
+    return *std::any_cast<compile_unit*>(env.context);
+}
+
+bool is_const(const std::string& reg) {
+    return !reg.empty() && reg[0] != '%' && reg[0] != '@' && reg != "undef";
+}
+
+std::string make_const(long long value, const std::string& type) {
+    if (type == "int") {
+        value = static_cast<std::int32_t>(value);
+    }
+    return std::to_string(value);
+}
+
+std::string make_const(double value) {
+    std::stringstream ss;
+    ss << "0x" << std::uppercase << std::hex << std::setw(16) << std::setfill('0')
+       << std::bit_cast<std::uint64_t>(value);
+    return ss.str();
+}
+
+long long const_int(const std::string& reg) {
+    if (reg == "true") return 1;
+    if (reg == "false") return 0;
+    if (reg.find_first_of(".eEx") != std::string::npos) return static_cast<long long>(const_double(reg));
+    return std::stoll(reg);
+}
+
+double const_double(const std::string& reg) {
+    if (reg.starts_with("0x")) {
+        return std::bit_cast<double>(std::stoull(reg.substr(2), nullptr, 16));
+    }
+    return std::stod(reg);
+}
+
+std::string fold_binary(const std::string& op, const std::string& left_reg, const std::string& right_reg, const std::string& type) {
+    if (!is_const(left_reg) || !is_const(right_reg)) return "";
+
+    if (type == "double") {
+        double a = const_double(left_reg);
+        double b = const_double(right_reg);
+        if (op == "+") return make_const(a + b);
+        if (op == "-") return make_const(a - b);
+        if (op == "*") return make_const(a * b);
+        if (op == "/") return make_const(a / b);
+        return "";
+    }
+
+    // 按无符号数运算以获得补码回绕语义
+    long long a = const_int(left_reg);
+    long long b = const_int(right_reg);
+    auto ua = static_cast<unsigned long long>(a);
+    auto ub = static_cast<unsigned long long>(b);
+    long long min = type == "int" ? std::numeric_limits<std::int32_t>::min() : std::numeric_limits<long long>::min();
+    if (op == "+") return make_const(static_cast<long long>(ua + ub), type);
+    if (op == "-") return make_const(static_cast<long long>(ua - ub), type);
+    if (op == "*") return make_const(static_cast<long long>(ua * ub), type);
+    if (op == "&") return make_const(a & b, type);
+    if (op == "|") return make_const(a | b, type);
+    if (op == "^") return make_const(a ^ b, type);
+    if (op == "/" && b != 0 && !(a == min && b == -1)) return make_const(a / b, type);
+    return "";
+}
+
+std::string fold_compare(const std::string& op, const std::string& left_reg, const std::string& right_reg, const std::string& type) {
+    if (!is_const(left_reg) || !is_const(right_reg)) return "";
+
+    bool result;
+    if (type == "double") {
+        double a = const_double(left_reg);
+        double b = const_double(right_reg);
+        // 与生成的有序比较 (fcmp oXX) 保持一致
+        if (std::isnan(a) || std::isnan(b)) return "0";
+        result = op == "<" ? a < b : op == ">" ? a > b : op == "<=" ? a <= b : op == ">=" ? a >= b : op == "==" ? a == b : a != b;
+    } else {
+        long long a = const_int(left_reg);
+        long long b = const_int(right_reg);
+        result = op == "<" ? a < b : op == ">" ? a > b : op == "<=" ? a <= b : op == ">=" ? a >= b : op == "==" ? a == b : a != b;
+    }
+    return result ? "1" : "0";
+}
+
 std::string convert_type(semantic::sema_env& env, const std::string& reg,
                          const std::string& from_type, const std::string& to_type) {
     if (from_type == to_type) return reg;
 
+    if (is_const(reg)) {
+        if (from_type == "double") {
+            // 超出范围的 fptosi 结果是 poison，不做折叠
+            double value = const_double(reg);
+            if (to_type == "int" && value > -2147483649.0 && value < 2147483648.0) {
+                return make_const(static_cast<long long>(value), to_type);
+            }
+            if (to_type == "long" && value >= -9223372036854775808.0 && value < 9223372036854775808.0) {
+                return make_const(static_cast<long long>(value), to_type);
+            }
+        } else if (to_type == "double") {
+            return make_const(static_cast<double>(const_int(reg)));
+        } else {
+            return make_const(const_int(reg), to_type);
+        }
+    }
+
     std::string conv_reg = "%" + env.temp();
     if (from_type == "int" && to_type == "double") {
         env.emit("  " + conv_reg + " = sitofp i32 " + reg + " to double");
@@ -50,6 +156,14 @@ std::string convert_operands(semantic::sema_env& env,
 }
 
 std::string convert_to_i1(semantic::sema_env& env, const std::string& reg, const std::string& type) {
+    if (is_const(reg)) {
+        if (type == "double") {
+            double value = const_double(reg);
+            return !std::isnan(value) && value != 0.0 ? "true" : "false";
+        }
+        return const_int(reg) != 0 ? "true" : "false";
+    }
+
     std::string i1_reg = "%" + env.temp();
     if (type == "long") {
         env.emit("  " + i1_reg + " = icmp ne i64 " + reg + ", 0");
@@ -91,6 +205,65 @@ void emit_load(const semantic::sema_env& env, const std::string& result_reg, con
     }
 }
 
+void emit_label(semantic::sema_env& env, const std::string& label) {
+    env.emit(label + ":");
+    env.ssa.enter_block(label);
+}
+
+void emit_br(semantic::sema_env& env, const std::string& target) {
+    env.emit("  br label %" + target);
+    env.ssa.add_predecessor(target, env.ssa.current_block());
+}
+
+void emit_cond_br(semantic::sema_env& env, const std::string& cond, const std::string& then_label, const std::string& else_label) {
+    env.emit("  br i1 " + cond + ", label %" + then_label + ", label %" + else_label);
+    env.ssa.add_predecessor(then_label, env.ssa.current_block());
+    env.ssa.add_predecessor(else_label, env.ssa.current_block());
+}
+
+static std::string llvm_type(const std::string& type) {
+    if (type == "int") return "i32";
+    if (type == "long") return "i64";
+    return "double";
+}
+
+static std::string rewrite_aliases(const semantic::sema_env& env, const std::string& line) {
+    std::string result;
+    for (size_t i = 0; i < line.size();) {
+        if (line[i] != '%') {
+            result += line[i++];
+            continue;
+        }
+        size_t j = i + 1;
+        while (j < line.size() && (std::isalnum(static_cast<unsigned char>(line[j])) || line[j] == '_' || line[j] == '.')) {
+            j++;
+        }
+        result += env.ssa.resolve(line.substr(i, j - i));
+        i = j;
+    }
+    return result;
+}
+
+void insert_phis(const semantic::sema_env& env, std::istream& is, std::ostream& os) {
+    std::string line;
+    while (std::getline(is, line)) {
+        if (env.ssa.has_aliases()) {
+            line = rewrite_aliases(env, line);
+        }
+        os << line << '\n';
+        if (line.empty() || line.back() != ':' || line.front() == ' ') {
+            continue;
+        }
+        for (const auto& phi : env.ssa.phis(line.substr(0, line.size() - 1))) {
+            os << "  " << phi.name << " = phi " << llvm_type(phi.type);
+            for (size_t i = 0; i < phi.operands.size(); ++i) {
+                os << (i == 0 ? " " : ", ") << "[ " << phi.operands[i].first << ", %" << phi.operands[i].second << " ]";
+            }
+            os << '\n';
+        }
+    }
+}
+
 void emit_add(const semantic::sema_env& env, const std::string& result_reg, const std::string& left_reg, const std::string& right_reg, const std::string& result_type) {
     if (result_type == "double") {
         env.emit("  " + result_reg + " = fadd double " + left_reg + ", " + right_reg);
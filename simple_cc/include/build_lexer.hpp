@@ -7,6 +7,7 @@
 
 namespace lexer {
 class token;
+class lexer;
 }
 
 enum class token_type {
@@ -51,9 +52,18 @@ enum class token_type {
 };
 
 extern const std::unordered_set<std::string> terminals;
-extern std::map<std::string, std::string> strings;
+// 单个编译单元在词法分析阶段收集的信息，各文件互不共享，可以并行编译
+struct compile_unit {
+    std::map<std::string, std::string> strings;
+    // 被取地址的变量名，这些变量仍然分配在栈上，其余变量直接构造为 SSA 形式
+    std::unordered_set<std::string> address_taken;
+};
 
 std::string process_string_literal(const std::string& literal);
 std::string trim_zero(std::string s);
 
-std::vector<lexer::token> lex(const std::string& str);
\ No newline at end of file
+// 词法分析器只构建一次，之后只读共享
+lexer::lexer build_lexer();
+// 从 token 序列收集字符串常量和被取地址的变量
+void collect_unit(const std::vector<lexer::token>& tokens, compile_unit& unit);
+std::vector<lexer::token> lex(const lexer::lexer& lex_, const std::string& str, compile_unit& unit);
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "semantic/sema.hpp"
+#include "time_report.hpp"
+
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using parser_t = semantic::sema<grammar::LR1>;
+
+// 前端：词法、语法、语义分析并插入 phi，把 LLVM IR 文本写入 il
+// 失败时返回 false，诊断信息追加到 diagnostics；report 非空时记录各阶段的开销和 token、语法树结点数
+bool compile_frontend(const std::string& source, const lexer::lexer& lex_, const parser_t& parser,
+                      std::ostream& il, std::vector<std::string>& diagnostics, time_report::report* report = nullptr);
+
+// 编译服务中常驻的文档，修改后只重新做受影响部分的词法分析和 LR 分析
+// 语法树构建和语义分析仍然对整个文档进行
+struct document {
+    std::string source;
+    std::vector<lexer::token> tokens;
+    grammar::parse_log log;
+    // 自上次语法分析以来 token 序列的变化
+    std::optional<lexer::lexer::damage> pending;
+    std::size_t relexed = 0;
+};
+
+void open_document(document& doc, std::string source, const lexer::lexer& lex_);
+// 把 source[offset, offset + length) 替换为 text；越界时抛出 std::out_of_range
+void edit_document(document& doc, std::size_t offset, std::size_t length, const std::string& text, const lexer::lexer& lex_);
+bool compile_frontend(document& doc, const parser_t& parser, std::ostream& il, std::vector<std::string>& diagnostics);
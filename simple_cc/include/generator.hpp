@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// 随机生成符合 build_grammar() 语言的程序，用于性能测试和压力测试
+// 生成的程序语法和语义均合法：变量先声明后使用，循环次数有上限，除数都是非零常量
+namespace generator {
+
+struct options {
+    // 目标大小（字节），实际输出会略微超出
+    std::size_t bytes = 4096;
+    // 相同的种子和选项在任何平台上生成相同的程序
+    std::uint64_t seed = 1;
+    // if / for / while 的嵌套层数上限
+    std::size_t max_depth = 6;
+    // 表达式的嵌套层数上限
+    std::size_t expr_depth = 5;
+    // 每个语句块的语句数上限，stmts 是右递归的，它决定了分析栈和语法树的深度
+    std::size_t block_size = 32;
+};
+
+// 流式输出，生成大程序时不需要把整个程序留在内存中
+void generate(std::ostream& os, const options& opts);
+std::string generate(const options& opts);
+
+} // namespace generator
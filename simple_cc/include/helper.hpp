@@ -1,11 +1,26 @@
 #pragma once
 
+#include <iostream>
 #include <string>
 
 // 前向声明
 namespace semantic {
 class sema_env;
 }
+struct compile_unit;
+
+// 语义动作通过 env.context 取得当前编译单元
+compile_unit& unit_of(semantic::sema_env& env);
+
+// 常量折叠函数：常量直接以 LLVM 字面量的形式保存在 reg 属性中
+bool is_const(const std::string& reg);
+std::string make_const(long long value, const std::string& type);
+std::string make_const(double value);
+long long const_int(const std::string& reg);
+double const_double(const std::string& reg);
+// 无法折叠时返回空串
+std::string fold_binary(const std::string& op, const std::string& left_reg, const std::string& right_reg, const std::string& type);
+std::string fold_compare(const std::string& op, const std::string& left_reg, const std::string& right_reg, const std::string& type);
 
 // LLVM IR 类型转换函数
 std::string convert_type(semantic::sema_env& env, const std::string& reg,
@@ -24,6 +39,14 @@ void emit_alloca(const semantic::sema_env& env, const std::string& var_name, con
 void emit_store(const semantic::sema_env& env, const std::string& value_reg, const std::string& var_name, const std::string& var_type);
 void emit_load(const semantic::sema_env& env, const std::string& result_reg, const std::string& var_name, const std::string& var_type);
 
+// 控制流代码生成函数，同时维护 SSA 构造所需的控制流图
+void emit_label(semantic::sema_env& env, const std::string& label);
+void emit_br(semantic::sema_env& env, const std::string& target);
+void emit_cond_br(semantic::sema_env& env, const std::string& cond, const std::string& then_label, const std::string& else_label);
+
+// 在各基本块开头插入 phi 指令，并替换被消去的平凡 phi
+void insert_phis(const semantic::sema_env& env, std::istream& is, std::ostream& os);
+
 // 算术运算函数
 void emit_add(const semantic::sema_env& env, const std::string& result_reg, const std::string& left_reg, const std::string& right_reg, const std::string& result_type);
 void emit_sub(const semantic::sema_env& env, const std::string& result_reg, const std::string& left_reg, const std::string& right_reg, const std::string& result_type);
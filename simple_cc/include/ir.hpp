@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// simple_cc 生成的 LLVM IR 子集的内存表示
+namespace ir {
+
+struct type {
+    enum class kind {
+        void_,
+        i1,
+        i8,
+        i32,
+        i64,
+        f64
+    };
+
+    kind base = kind::void_;
+    bool is_ptr = false;
+
+    [[nodiscard]] bool is_int() const;
+    [[nodiscard]] bool is_float() const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::string to_string() const;
+
+    bool operator==(const type& other) const = default;
+
+    static type parse(const std::string& str);
+};
+
+struct value {
+    enum class kind {
+        reg,
+        imm,
+        fimm,
+        global,
+        undef
+    };
+
+    kind k = kind::undef;
+    std::string name;
+    std::int64_t imm = 0;
+    double fimm = 0.0;
+
+    [[nodiscard]] bool is_reg() const;
+    [[nodiscard]] bool is_const() const;
+    [[nodiscard]] std::string to_string(const type& ty) const;
+
+    bool operator==(const value& other) const;
+
+    static value reg(const std::string& name);
+    static value constant(std::int64_t v);
+    static value constant(double v);
+    static value parse(const std::string& str);
+};
+
+enum class opcode {
+    alloca_,
+    load,
+    store,
+    add,
+    sub,
+    mul,
+    sdiv,
+    fadd,
+    fsub,
+    fmul,
+    fdiv,
+    and_,
+    or_,
+    xor_,
+    icmp,
+    fcmp,
+    zext,
+    sext,
+    trunc,
+    sitofp,
+    fptosi,
+    ptrtoint,
+    inttoptr,
+    gep,
+    call,
+    phi,
+    br,
+    cond_br,
+    ret
+};
+
+struct instruction {
+    opcode op;
+    std::string result;
+    // 运算/比较的操作数类型；load/alloca 的元素类型；转换的源类型；call 的返回类型
+    type ty;
+    // 转换的目标类型；store/load/ptrtoint 的指针类型
+    type to;
+    std::vector<value> operands;
+    // br 的目标块；phi 中与 operands 一一对应的前驱块
+    std::vector<std::string> labels;
+    std::string pred;
+    std::string callee;
+    std::vector<type> arg_types;
+    std::size_t array_size = 0;
+    bool nsw = false;
+    std::string comment;
+
+    [[nodiscard]] bool has_result() const;
+    [[nodiscard]] bool is_terminator() const;
+    [[nodiscard]] bool has_side_effect() const;
+    [[nodiscard]] type result_type() const;
+    [[nodiscard]] std::string to_string() const;
+};
+
+struct block {
+    std::string label;
+    std::vector<instruction> insts;
+
+    [[nodiscard]] const instruction& terminator() const;
+    [[nodiscard]] std::vector<std::string> successors() const;
+};
+
+struct function {
+    std::string name;
+    type ret;
+    std::vector<block> blocks;
+
+    [[nodiscard]] std::unordered_map<std::string, std::vector<std::string>> predecessors() const;
+    [[nodiscard]] std::unordered_map<std::string, std::size_t> block_index() const;
+    [[nodiscard]] std::vector<std::size_t> reverse_post_order() const;
+    void replace_uses(const std::unordered_map<std::string, value>& replacements);
+};
+
+struct global {
+    std::string name;
+    std::string data;
+};
+
+struct module {
+    std::vector<std::string> header;
+    std::vector<global> globals;
+    std::vector<std::string> declarations;
+    std::vector<function> functions;
+};
+
+class parse_error final : public std::exception {
+public:
+    explicit parse_error(const std::string& line);
+    [[nodiscard]] const char* what() const noexcept override;
+
+private:
+    std::string msg;
+};
+
+module parse(std::istream& is);
+void print(std::ostream& os, const module& mod);
+
+std::ostream& operator<<(std::ostream& os, const instruction& inst);
+
+} // namespace ir
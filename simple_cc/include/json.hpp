@@ -0,0 +1,46 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
+// 最小的 JSON 实现，用于编译服务的行协议
+namespace json {
+
+struct value;
+using array = std::vector<value>;
+using object = std::map<std::string, value>;
+
+struct value {
+    std::variant<std::nullptr_t, bool, double, std::string, array, object> data;
+
+    value() : data(nullptr) {}
+    value(std::nullptr_t) : data(nullptr) {}
+    value(bool b) : data(b) {}
+    value(int n) : data(static_cast<double>(n)) {}
+    value(double n) : data(n) {}
+    value(const char* s) : data(std::string(s)) {}
+    value(std::string s) : data(std::move(s)) {}
+    value(array a) : data(std::move(a)) {}
+    value(object o) : data(std::move(o)) {}
+
+    [[nodiscard]] bool is_null() const { return std::holds_alternative<std::nullptr_t>(data); }
+    [[nodiscard]] bool is_number() const { return std::holds_alternative<double>(data); }
+    [[nodiscard]] bool is_string() const { return std::holds_alternative<std::string>(data); }
+    [[nodiscard]] bool is_object() const { return std::holds_alternative<object>(data); }
+
+    [[nodiscard]] double as_number() const { return std::get<double>(data); }
+    [[nodiscard]] const std::string& as_string() const { return std::get<std::string>(data); }
+    [[nodiscard]] const object& as_object() const { return std::get<object>(data); }
+
+    // 对象中不存在的键返回 null
+    [[nodiscard]] const value& operator[](const std::string& key) const;
+};
+
+// 语法错误时抛出 std::runtime_error
+value parse(const std::string& text);
+std::string dump(const value& v);
+std::string quote(const std::string& s);
+
+} // namespace json
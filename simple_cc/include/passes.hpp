@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ir.hpp"
+
+// 内置优化 pass，替代外部的 opt 调用
+namespace ir::passes {
+
+// 将只被 load/store 使用的 alloca 提升为 SSA 寄存器，其余 alloca 移到入口块
+void mem2reg(function& func);
+
+// 常量折叠与简单的代数化简
+bool fold_constants(function& func);
+
+// 删除没有副作用且结果未被使用的指令
+bool dce(function& func);
+
+// 折叠常量分支、删除不可达块、合并直线块
+bool simplify_cfg(function& func);
+
+// 按 -O 级别运行 pass 流水线，0 表示不做任何优化
+void optimize(module& mod, int level);
+
+} // namespace ir::passes
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "driver.hpp"
+
+#include <iostream>
+#include <map>
+#include <string>
+
+// 常驻编译服务：词法分析器和 LR(1) 分析表只构建一次，每个请求只需词法、语法、语义分析和优化
+// 行协议，每行一个 JSON 对象：
+//   请求 {"id": 任意值, "source": "源码", "opt": 0-3, "emit": "ir" | "asm"}
+//        {"id": ..., "doc": "名称", "source": "源码"}                         打开或替换文档并编译
+//        {"id": ..., "doc": "名称", "edit": {"offset": 0, "length": 0, "text": ""}}  增量修改文档并编译
+//        {"cmd": "ping"} / {"cmd": "shutdown"} / {"cmd": "close", "doc": "名称"}
+//   响应 {"id": ..., "ok": true, "output": "...", "elapsed_ms": ...}
+//        {"id": ..., "ok": false, "diagnostics": ["..."], "elapsed_ms": ...}
+//        文档请求另外返回 relexed / reparsed：重新词法分析的 token 数和 LR 分析实际驱动的 token 数
+namespace server {
+
+// 文档只在同一个连接内可见
+struct session {
+    std::map<std::string, document> documents;
+};
+
+// 处理一行请求，返回一行响应；shutdown 置为 true 表示收到了关闭请求
+std::string handle(const std::string& line, const lexer::lexer& lex_, const parser_t& parser, session& state, bool& shutdown);
+
+// 从 is 读取请求，把响应写到 os，直到输入结束或收到 shutdown
+int serve(std::istream& is, std::ostream& os, const lexer::lexer& lex_, const parser_t& parser);
+
+// 监听 Unix 域套接字，每个连接一个线程，连接内的请求按顺序处理
+int serve_unix(const std::string& path, const lexer::lexer& lex_, const parser_t& parser);
+
+} // namespace server
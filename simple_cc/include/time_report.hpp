@@ -0,0 +1,69 @@
+#pragma once
+
+#include "trace.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// -ftime-report：按阶段统计墙钟时间、CPU 时间、内存分配和峰值常驻内存，并记录分析表规模、token 数等计数
+namespace time_report {
+
+struct phase {
+    std::string name;
+    double wall_ms = 0;
+    // 当前线程的 CPU 时间，调用外部命令的耗时只计入墙钟时间
+    double cpu_ms = 0;
+    std::size_t allocs = 0;
+    std::size_t alloc_bytes = 0;
+    // 阶段结束时整个进程的峰值常驻内存
+    long peak_rss_kb = 0;
+};
+
+class report {
+public:
+    // 同名的阶段和计数累加，保留第一次出现的顺序
+    void add(const phase& p);
+    void count(const std::string& name, std::size_t n);
+    void merge(const report& other);
+
+    void print(std::ostream& os) const;
+    void print_json(std::ostream& os) const;
+
+private:
+    std::vector<phase> phases;
+    std::vector<std::pair<std::string, std::size_t>> counts;
+};
+
+// 统计所在作用域的开销并在析构时记入 r，r 为空时什么也不做；开启 trace 时同时记为一个 span
+class scope {
+public:
+    scope(report* r, const char* name);
+    ~scope();
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+private:
+    report* r;
+    const char* name;
+    std::chrono::steady_clock::time_point wall;
+    double cpu = 0;
+    std::size_t allocs = 0;
+    std::size_t alloc_bytes = 0;
+    trace::span span;
+};
+
+// 当前线程累计的 operator new 调用次数和申请的字节数，未链接 alloc_hooks.cpp 时始终为 0
+std::size_t thread_allocs();
+std::size_t thread_alloc_bytes();
+
+namespace detail {
+// 由 alloc_hooks.cpp 中替换的 operator new 累加；计数器是平凡类型的 thread_local，不需要动态初始化
+extern thread_local std::size_t allocated_count;
+extern thread_local std::size_t allocated_bytes;
+} // namespace detail
+
+} // namespace time_report
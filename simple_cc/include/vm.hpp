@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ir.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 基于寄存器的字节码解释器，用于 --run 模式直接执行程序
+namespace ir::vm {
+
+enum class op : std::uint16_t {
+    mov,
+    add_i32,
+    sub_i32,
+    mul_i32,
+    sdiv_i32,
+    add_i64,
+    sub_i64,
+    mul_i64,
+    sdiv_i64,
+    and_,
+    or_,
+    xor_,
+    fadd,
+    fsub,
+    fmul,
+    fdiv,
+    icmp_eq,
+    icmp_ne,
+    icmp_slt,
+    icmp_sle,
+    icmp_sgt,
+    icmp_sge,
+    fcmp_oeq,
+    fcmp_one,
+    fcmp_olt,
+    fcmp_ole,
+    fcmp_ogt,
+    fcmp_oge,
+    zext_i1,
+    zext_i32,
+    sext_i1,
+    trunc_i1,
+    trunc_i32,
+    sitofp,
+    fptosi_i32,
+    fptosi_i64,
+    load_i32,
+    load_i64,
+    load_f64,
+    store_i32,
+    store_i64,
+    store_f64,
+    call,
+    jmp,
+    br,
+    ret
+};
+
+// 每条指令 16 字节：dst/a/b 都是寄存器编号；跳转指令中为目标地址，call 中 a 为调用表下标
+struct insn {
+    op code;
+    std::uint32_t dst = 0;
+    std::uint32_t a = 0;
+    std::uint32_t b = 0;
+};
+
+union reg {
+    std::int64_t i;
+    double f;
+};
+
+struct call_info {
+    std::string callee;
+    std::vector<std::uint32_t> args;
+    std::vector<type> types;
+};
+
+struct program {
+    std::vector<insn> code;
+    // 寄存器初值：常量、字符串和 alloca 的地址在编译时就放入寄存器
+    std::vector<reg> registers;
+    std::vector<call_info> calls;
+    std::vector<std::string> strings;
+    std::size_t frame_size = 0;
+    std::vector<std::pair<std::uint32_t, std::size_t>> frame_slots;
+    std::vector<std::pair<std::uint32_t, std::size_t>> string_slots;
+};
+
+program compile(const module& mod);
+int run(const program& prog);
+
+} // namespace ir::vm
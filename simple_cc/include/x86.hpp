@@ -0,0 +1,12 @@
+#pragma once
+
+#include "ir.hpp"
+
+#include <iostream>
+
+// x86-64 后端：System V ABI，输出 GNU as (AT&T 语法) 汇编，链接系统 libc
+namespace ir::x86 {
+
+void emit(std::ostream& os, const module& mod);
+
+} // namespace ir::x86
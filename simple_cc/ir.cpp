@@ -0,0 +1,731 @@
+#include "ir.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <unordered_set>
+
+namespace ir {
+
+bool type::is_int() const {
+    return !is_ptr && (base == kind::i1 || base == kind::i8 || base == kind::i32 || base == kind::i64);
+}
+
+bool type::is_float() const {
+    return !is_ptr && base == kind::f64;
+}
+
+std::size_t type::size() const {
+    if (is_ptr) {
+        return 8;
+    }
+    switch (base) {
+    case kind::i1:
+    case kind::i8: return 1;
+    case kind::i32: return 4;
+    case kind::i64:
+    case kind::f64: return 8;
+    default: return 0;
+    }
+}
+
+std::string type::to_string() const {
+    std::string res;
+    switch (base) {
+    case kind::void_: res = "void"; break;
+    case kind::i1: res = "i1"; break;
+    case kind::i8: res = "i8"; break;
+    case kind::i32: res = "i32"; break;
+    case kind::i64: res = "i64"; break;
+    case kind::f64: res = "double"; break;
+    }
+    if (is_ptr) {
+        res += '*';
+    }
+    return res;
+}
+
+type type::parse(const std::string& str) {
+    type res;
+    std::string base = str;
+    if (!base.empty() && base.back() == '*') {
+        res.is_ptr = true;
+        base.pop_back();
+    }
+    if (base == "void") {
+        res.base = kind::void_;
+    } else if (base == "i1") {
+        res.base = kind::i1;
+    } else if (base == "i8") {
+        res.base = kind::i8;
+    } else if (base == "i32") {
+        res.base = kind::i32;
+    } else if (base == "i64") {
+        res.base = kind::i64;
+    } else if (base == "double") {
+        res.base = kind::f64;
+    } else {
+        throw parse_error("unknown type " + str);
+    }
+    return res;
+}
+
+bool value::is_reg() const {
+    return k == kind::reg;
+}
+
+bool value::is_const() const {
+    return k == kind::imm || k == kind::fimm;
+}
+
+std::string value::to_string(const type& ty) const {
+    switch (k) {
+    case kind::reg: return "%" + name;
+    case kind::global: return "@" + name;
+    case kind::undef: return "undef";
+    case kind::imm:
+        if (ty.is_float()) {
+            return value::constant(static_cast<double>(imm)).to_string(ty);
+        }
+        if (ty == type{type::kind::i1}) {
+            return imm ? "true" : "false";
+        }
+        return std::to_string(imm);
+    case kind::fimm: {
+        std::ostringstream oss;
+        oss << "0x" << std::uppercase << std::hex << std::setw(16) << std::setfill('0')
+            << std::bit_cast<std::uint64_t>(fimm);
+        return oss.str();
+    }
+    }
+    return "undef";
+}
+
+bool value::operator==(const value& other) const {
+    if (k != other.k) {
+        return false;
+    }
+    switch (k) {
+    case kind::reg:
+    case kind::global: return name == other.name;
+    case kind::imm: return imm == other.imm;
+    case kind::fimm: return std::bit_cast<std::uint64_t>(fimm) == std::bit_cast<std::uint64_t>(other.fimm);
+    case kind::undef: return true;
+    }
+    return false;
+}
+
+value value::reg(const std::string& name) {
+    value v;
+    v.k = kind::reg;
+    v.name = name;
+    return v;
+}
+
+value value::constant(const std::int64_t v) {
+    value res;
+    res.k = kind::imm;
+    res.imm = v;
+    return res;
+}
+
+value value::constant(const double v) {
+    value res;
+    res.k = kind::fimm;
+    res.fimm = v;
+    return res;
+}
+
+value value::parse(const std::string& str) {
+    if (str.empty()) {
+        throw parse_error("empty value");
+    }
+    value res;
+    if (str[0] == '%') {
+        return reg(str.substr(1));
+    }
+    if (str[0] == '@') {
+        res.k = kind::global;
+        res.name = str.substr(1);
+        return res;
+    }
+    if (str == "undef") {
+        return res;
+    }
+    if (str == "true") {
+        return constant(std::int64_t{1});
+    }
+    if (str == "false") {
+        return constant(std::int64_t{0});
+    }
+    if (str.starts_with("0x")) {
+        return constant(std::bit_cast<double>(std::stoull(str.substr(2), nullptr, 16)));
+    }
+    if (str.find_first_of(".eE") != std::string::npos) {
+        return constant(std::stod(str));
+    }
+    return constant(static_cast<std::int64_t>(std::stoll(str)));
+}
+
+bool instruction::has_result() const {
+    return !result.empty();
+}
+
+bool instruction::is_terminator() const {
+    return op == opcode::br || op == opcode::cond_br || op == opcode::ret;
+}
+
+bool instruction::has_side_effect() const {
+    return op == opcode::store || op == opcode::call || is_terminator();
+}
+
+type instruction::result_type() const {
+    switch (op) {
+    case opcode::alloca_: return {ty.base, true};
+    case opcode::icmp:
+    case opcode::fcmp: return {type::kind::i1};
+    case opcode::zext:
+    case opcode::sext:
+    case opcode::trunc:
+    case opcode::sitofp:
+    case opcode::fptosi:
+    case opcode::ptrtoint:
+    case opcode::inttoptr: return to;
+    case opcode::gep: return {type::kind::i8, true};
+    default: return ty;
+    }
+}
+
+static const std::unordered_map<opcode, std::string> opcode_names = {
+    {opcode::alloca_, "alloca"},
+    {opcode::load, "load"},
+    {opcode::store, "store"},
+    {opcode::add, "add"},
+    {opcode::sub, "sub"},
+    {opcode::mul, "mul"},
+    {opcode::sdiv, "sdiv"},
+    {opcode::fadd, "fadd"},
+    {opcode::fsub, "fsub"},
+    {opcode::fmul, "fmul"},
+    {opcode::fdiv, "fdiv"},
+    {opcode::and_, "and"},
+    {opcode::or_, "or"},
+    {opcode::xor_, "xor"},
+    {opcode::icmp, "icmp"},
+    {opcode::fcmp, "fcmp"},
+    {opcode::zext, "zext"},
+    {opcode::sext, "sext"},
+    {opcode::trunc, "trunc"},
+    {opcode::sitofp, "sitofp"},
+    {opcode::fptosi, "fptosi"},
+    {opcode::ptrtoint, "ptrtoint"},
+    {opcode::inttoptr, "inttoptr"},
+    {opcode::gep, "getelementptr"},
+    {opcode::call, "call"},
+    {opcode::phi, "phi"},
+    {opcode::br, "br"},
+    {opcode::cond_br, "br"},
+    {opcode::ret, "ret"}};
+
+std::string instruction::to_string() const {
+    std::string res = "  ";
+    if (has_result()) {
+        res += "%" + result + " = ";
+    }
+    const auto& name = opcode_names.at(op);
+    switch (op) {
+    case opcode::alloca_:
+        res += "alloca " + ty.to_string() + ", align " + std::to_string(ty.size());
+        break;
+    case opcode::load:
+        res += "load " + ty.to_string() + ", " + to.to_string() + " " + operands[0].to_string(to)
+             + ", align " + std::to_string(ty.size());
+        break;
+    case opcode::store:
+        res += "store " + ty.to_string() + " " + operands[0].to_string(ty) + ", " + to.to_string() + " "
+             + operands[1].to_string(to) + ", align " + std::to_string(ty.size());
+        break;
+    case opcode::add:
+    case opcode::sub:
+    case opcode::mul:
+    case opcode::sdiv:
+    case opcode::fadd:
+    case opcode::fsub:
+    case opcode::fmul:
+    case opcode::fdiv:
+    case opcode::and_:
+    case opcode::or_:
+    case opcode::xor_:
+        res += name + (nsw ? " nsw " : " ") + ty.to_string() + " " + operands[0].to_string(ty) + ", "
+             + operands[1].to_string(ty);
+        break;
+    case opcode::icmp:
+    case opcode::fcmp:
+        res += name + " " + pred + " " + ty.to_string() + " " + operands[0].to_string(ty) + ", "
+             + operands[1].to_string(ty);
+        break;
+    case opcode::zext:
+    case opcode::sext:
+    case opcode::trunc:
+    case opcode::sitofp:
+    case opcode::fptosi:
+    case opcode::ptrtoint:
+    case opcode::inttoptr:
+        res += name + " " + ty.to_string() + " " + operands[0].to_string(ty) + " to " + to.to_string();
+        break;
+    case opcode::gep: {
+        const auto arr = "[" + std::to_string(array_size) + " x i8]";
+        res += "getelementptr inbounds " + arr + ", " + arr + "* " + operands[0].to_string(ty) + ", i64 0, i64 0";
+        break;
+    }
+    case opcode::call: {
+        res += "call " + ty.to_string() + " (i8*, ...) @" + callee + "(";
+        for (std::size_t i = 0; i < operands.size(); ++i) {
+            if (i != 0) {
+                res += ", ";
+            }
+            res += arg_types[i].to_string() + " " + operands[i].to_string(arg_types[i]);
+        }
+        res += ")";
+        break;
+    }
+    case opcode::phi:
+        res += "phi " + ty.to_string() + " ";
+        for (std::size_t i = 0; i < operands.size(); ++i) {
+            if (i != 0) {
+                res += ", ";
+            }
+            res += "[ " + operands[i].to_string(ty) + ", %" + labels[i] + " ]";
+        }
+        break;
+    case opcode::br:
+        res += "br label %" + labels[0];
+        break;
+    case opcode::cond_br:
+        res += "br i1 " + operands[0].to_string({type::kind::i1}) + ", label %" + labels[0] + ", label %" + labels[1];
+        break;
+    case opcode::ret:
+        res += "ret " + ty.to_string();
+        if (!operands.empty()) {
+            res += " " + operands[0].to_string(ty);
+        }
+        break;
+    }
+    if (!comment.empty()) {
+        res += "  ;" + comment;
+    }
+    return res;
+}
+
+std::ostream& operator<<(std::ostream& os, const instruction& inst) {
+    os << inst.to_string();
+    return os;
+}
+
+const instruction& block::terminator() const {
+    return insts.back();
+}
+
+std::vector<std::string> block::successors() const {
+    if (insts.empty() || !insts.back().is_terminator()) {
+        return {};
+    }
+    const auto& term = insts.back();
+    if (term.op == opcode::cond_br && term.labels[0] == term.labels[1]) {
+        return {term.labels[0]};
+    }
+    return term.labels;
+}
+
+std::unordered_map<std::string, std::vector<std::string>> function::predecessors() const {
+    std::unordered_map<std::string, std::vector<std::string>> preds;
+    for (const auto& b : blocks) {
+        preds[b.label];
+        for (const auto& succ : b.successors()) {
+            preds[succ].push_back(b.label);
+        }
+    }
+    return preds;
+}
+
+std::unordered_map<std::string, std::size_t> function::block_index() const {
+    std::unordered_map<std::string, std::size_t> index;
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        index[blocks[i].label] = i;
+    }
+    return index;
+}
+
+std::vector<std::size_t> function::reverse_post_order() const {
+    std::vector<std::size_t> order;
+    if (blocks.empty()) {
+        return order;
+    }
+    const auto index = block_index();
+    std::vector<bool> visited(blocks.size(), false);
+    std::function<void(std::size_t)> dfs = [&](const std::size_t i) {
+        visited[i] = true;
+        for (const auto& succ : blocks[i].successors()) {
+            if (const auto j = index.at(succ); !visited[j]) {
+                dfs(j);
+            }
+        }
+        order.push_back(i);
+    };
+    dfs(0);
+    std::ranges::reverse(order);
+    return order;
+}
+
+void function::replace_uses(const std::unordered_map<std::string, value>& replacements) {
+    if (replacements.empty()) {
+        return;
+    }
+    auto resolve = [&](value v) {
+        for (std::size_t depth = 0; v.is_reg() && depth <= replacements.size(); ++depth) {
+            const auto it = replacements.find(v.name);
+            if (it == replacements.end()) {
+                break;
+            }
+            v = it->second;
+        }
+        return v;
+    };
+    for (auto& b : blocks) {
+        for (auto& inst : b.insts) {
+            for (auto& op : inst.operands) {
+                op = resolve(op);
+            }
+        }
+    }
+}
+
+parse_error::parse_error(const std::string& line) : msg("IR parse error: " + line) {}
+
+const char* parse_error::what() const noexcept {
+    return msg.c_str();
+}
+
+namespace {
+
+std::vector<std::string> tokenize(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::string cur;
+    auto flush = [&] {
+        if (!cur.empty()) {
+            tokens.push_back(cur);
+            cur.clear();
+        }
+    };
+    for (const char ch : line) {
+        if (ch == ' ' || ch == '\t') {
+            flush();
+        } else if (ch == ',' || ch == '[' || ch == ']' || ch == '(' || ch == ')' || ch == '=') {
+            flush();
+            tokens.emplace_back(1, ch);
+        } else {
+            cur += ch;
+        }
+    }
+    flush();
+    return tokens;
+}
+
+class cursor {
+public:
+    cursor(std::vector<std::string> tokens, const std::string& line) : tokens(std::move(tokens)), line(line) {}
+
+    [[nodiscard]] bool done() const {
+        return pos >= tokens.size();
+    }
+
+    [[nodiscard]] const std::string& peek() const {
+        if (done()) {
+            throw parse_error(line);
+        }
+        return tokens[pos];
+    }
+
+    std::string next() {
+        auto tok = peek();
+        ++pos;
+        return tok;
+    }
+
+    void expect(const std::string& tok) {
+        if (next() != tok) {
+            throw parse_error(line);
+        }
+    }
+
+    bool accept(const std::string& tok) {
+        if (!done() && tokens[pos] == tok) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    // [N x i8]* 形式的数组指针类型，返回 N
+    std::size_t array_type() {
+        expect("[");
+        const auto n = std::stoull(next());
+        expect("x");
+        expect("i8");
+        expect("]");
+        accept("*");
+        return n;
+    }
+
+private:
+    std::vector<std::string> tokens;
+    std::size_t pos = 0;
+    const std::string& line;
+};
+
+const std::unordered_map<std::string, opcode> binary_ops = {
+    {"add", opcode::add},
+    {"sub", opcode::sub},
+    {"mul", opcode::mul},
+    {"sdiv", opcode::sdiv},
+    {"fadd", opcode::fadd},
+    {"fsub", opcode::fsub},
+    {"fmul", opcode::fmul},
+    {"fdiv", opcode::fdiv},
+    {"and", opcode::and_},
+    {"or", opcode::or_},
+    {"xor", opcode::xor_}};
+
+const std::unordered_map<std::string, opcode> cast_ops = {
+    {"zext", opcode::zext},
+    {"sext", opcode::sext},
+    {"trunc", opcode::trunc},
+    {"sitofp", opcode::sitofp},
+    {"fptosi", opcode::fptosi},
+    {"ptrtoint", opcode::ptrtoint},
+    {"inttoptr", opcode::inttoptr}};
+
+instruction parse_instruction(const std::string& text) {
+    instruction inst{};
+    std::string body = text;
+
+    if (const auto semi = body.find(';'); semi != std::string::npos) {
+        inst.comment = body.substr(semi + 1);
+        body = body.substr(0, semi);
+    }
+
+    cursor cur(tokenize(body), text);
+
+    if (cur.peek()[0] == '%') {
+        inst.result = cur.next().substr(1);
+        cur.expect("=");
+    }
+
+    const auto name = cur.next();
+    if (name == "alloca") {
+        inst.op = opcode::alloca_;
+        inst.ty = type::parse(cur.next());
+    } else if (name == "load") {
+        inst.op = opcode::load;
+        inst.ty = type::parse(cur.next());
+        cur.expect(",");
+        inst.to = type::parse(cur.next());
+        inst.operands.push_back(value::parse(cur.next()));
+    } else if (name == "store") {
+        inst.op = opcode::store;
+        inst.ty = type::parse(cur.next());
+        inst.operands.push_back(value::parse(cur.next()));
+        cur.expect(",");
+        inst.to = type::parse(cur.next());
+        inst.operands.push_back(value::parse(cur.next()));
+    } else if (binary_ops.contains(name)) {
+        inst.op = binary_ops.at(name);
+        inst.nsw = cur.accept("nsw");
+        inst.ty = type::parse(cur.next());
+        inst.operands.push_back(value::parse(cur.next()));
+        cur.expect(",");
+        inst.operands.push_back(value::parse(cur.next()));
+    } else if (name == "icmp" || name == "fcmp") {
+        inst.op = name == "icmp" ? opcode::icmp : opcode::fcmp;
+        inst.pred = cur.next();
+        inst.ty = type::parse(cur.next());
+        inst.operands.push_back(value::parse(cur.next()));
+        cur.expect(",");
+        inst.operands.push_back(value::parse(cur.next()));
+    } else if (cast_ops.contains(name)) {
+        inst.op = cast_ops.at(name);
+        inst.ty = type::parse(cur.next());
+        inst.operands.push_back(value::parse(cur.next()));
+        cur.expect("to");
+        inst.to = type::parse(cur.next());
+    } else if (name == "getelementptr") {
+        inst.op = opcode::gep;
+        cur.accept("inbounds");
+        inst.array_size = cur.array_type();
+        inst.ty = {type::kind::i8, true};
+        cur.expect(",");
+        cur.array_type();
+        inst.operands.push_back(value::parse(cur.next()));
+    } else if (name == "call") {
+        inst.op = opcode::call;
+        inst.ty = type::parse(cur.next());
+        cur.expect("(");
+        while (!cur.accept(")")) {
+            cur.next();
+        }
+        inst.callee = cur.next().substr(1);
+        cur.expect("(");
+        while (!cur.accept(")")) {
+            inst.arg_types.push_back(type::parse(cur.next()));
+            inst.operands.push_back(value::parse(cur.next()));
+            cur.accept(",");
+        }
+    } else if (name == "phi") {
+        inst.op = opcode::phi;
+        inst.ty = type::parse(cur.next());
+        while (cur.accept("[")) {
+            inst.operands.push_back(value::parse(cur.next()));
+            cur.expect(",");
+            inst.labels.push_back(cur.next().substr(1));
+            cur.expect("]");
+            cur.accept(",");
+        }
+    } else if (name == "br") {
+        if (cur.accept("label")) {
+            inst.op = opcode::br;
+            inst.labels.push_back(cur.next().substr(1));
+        } else {
+            inst.op = opcode::cond_br;
+            cur.expect("i1");
+            inst.operands.push_back(value::parse(cur.next()));
+            cur.expect(",");
+            cur.expect("label");
+            inst.labels.push_back(cur.next().substr(1));
+            cur.expect(",");
+            cur.expect("label");
+            inst.labels.push_back(cur.next().substr(1));
+        }
+    } else if (name == "ret") {
+        inst.op = opcode::ret;
+        inst.ty = type::parse(cur.next());
+        if (!cur.done()) {
+            inst.operands.push_back(value::parse(cur.next()));
+        }
+    } else {
+        throw parse_error(text);
+    }
+    return inst;
+}
+
+global parse_global(const std::string& line) {
+    global g;
+    const auto eq = line.find(" = ");
+    const auto quote = line.find("c\"");
+    if (eq == std::string::npos || quote == std::string::npos) {
+        throw parse_error(line);
+    }
+    g.name = line.substr(1, eq - 1);
+    const auto end = line.find('"', quote + 2);
+    for (std::size_t i = quote + 2; i < end; ++i) {
+        if (line[i] == '\\') {
+            g.data += static_cast<char>(std::stoi(line.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            g.data += line[i];
+        }
+    }
+    if (!g.data.empty() && g.data.back() == '\0') {
+        g.data.pop_back();
+    }
+    return g;
+}
+
+std::string escape(const std::string& data) {
+    std::string res;
+    for (const char c : data) {
+        if (c == '"' || c == '\\' || c < 32 || c > 126) {
+            char buf[4];
+            std::snprintf(buf, sizeof(buf), "\\%02X", static_cast<unsigned char>(c));
+            res += buf;
+        } else {
+            res += c;
+        }
+    }
+    return res + "\\00";
+}
+
+} // namespace
+
+module parse(std::istream& is) {
+    module mod;
+    function* func = nullptr;
+    std::string line;
+    while (std::getline(is, line)) {
+        const auto first = line.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            continue;
+        }
+        if (func == nullptr) {
+            if (line[0] == ';') {
+                mod.header.push_back(line);
+            } else if (line[0] == '@') {
+                mod.globals.push_back(parse_global(line));
+            } else if (line.starts_with("declare")) {
+                mod.declarations.push_back(line);
+            } else if (line.starts_with("define")) {
+                const auto at = line.find('@');
+                const auto par = line.find('(', at);
+                func = &mod.functions.emplace_back();
+                func->ret = type::parse(line.substr(7, at - 8));
+                func->name = line.substr(at + 1, par - at - 1);
+            } else {
+                throw parse_error(line);
+            }
+            continue;
+        }
+        if (line[first] == ';') {
+            continue;
+        }
+        if (line[first] == '}') {
+            func = nullptr;
+        } else if (line.back() == ':') {
+            func->blocks.push_back({line.substr(first, line.size() - first - 1), {}});
+        } else {
+            if (func->blocks.empty()) {
+                throw parse_error(line);
+            }
+            func->blocks.back().insts.push_back(parse_instruction(line.substr(first)));
+        }
+    }
+    return mod;
+}
+
+void print(std::ostream& os, const module& mod) {
+    for (const auto& line : mod.header) {
+        os << line << '\n';
+    }
+    os << '\n';
+    for (const auto& g : mod.globals) {
+        os << "@" << g.name << " = private unnamed_addr constant [" << g.data.size() + 1
+           << " x i8] c\"" << escape(g.data) << "\", align 1\n";
+    }
+    os << '\n';
+    for (const auto& decl : mod.declarations) {
+        os << decl << '\n';
+    }
+    for (const auto& func : mod.functions) {
+        os << "\ndefine " << func.ret.to_string() << " @" << func.name << "() {\n";
+        for (const auto& b : func.blocks) {
+            os << b.label << ":\n";
+            for (const auto& inst : b.insts) {
+                os << inst << '\n';
+            }
+        }
+        os << "}\n";
+    }
+}
+
+} // namespace ir
@@ -0,0 +1,359 @@
+#include "json.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace json {
+
+const value& value::operator[](const std::string& key) const {
+    static const value null;
+    if (!is_object()) {
+        return null;
+    }
+    const auto& obj = as_object();
+    const auto found = obj.find(key);
+    return found == obj.end() ? null : found->second;
+}
+
+namespace {
+
+class parser {
+public:
+    explicit parser(const std::string& text) : text(text) {}
+
+    value parse_document() {
+        auto result = parse_value();
+        skip_ws();
+        if (pos != text.size()) {
+            fail("trailing characters");
+        }
+        return result;
+    }
+
+private:
+    // 对象和数组的最大嵌套层数，防止递归下降耗尽栈
+    static constexpr std::size_t max_depth = 512;
+
+    const std::string& text;
+    std::size_t pos = 0;
+    std::size_t depth = 0;
+
+    [[noreturn]] void fail(const std::string& msg) const {
+        throw std::runtime_error(msg + " at offset " + std::to_string(pos));
+    }
+
+    void skip_ws() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            ++pos;
+        }
+    }
+
+    void expect(const char c) {
+        skip_ws();
+        if (pos >= text.size() || text[pos] != c) {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++pos;
+    }
+
+    bool consume(const std::string& word) {
+        if (text.compare(pos, word.size(), word) == 0) {
+            pos += word.size();
+            return true;
+        }
+        return false;
+    }
+
+    value parse_value() {
+        skip_ws();
+        if (pos >= text.size()) {
+            fail("unexpected end of input");
+        }
+        switch (text[pos]) {
+        case '{':
+        case '[': {
+            if (++depth > max_depth) {
+                fail("nesting too deep");
+            }
+            auto result = text[pos] == '{' ? parse_object() : parse_array();
+            --depth;
+            return result;
+        }
+        case '"': return parse_string();
+        default: break;
+        }
+        if (consume("true")) {
+            return true;
+        }
+        if (consume("false")) {
+            return false;
+        }
+        if (consume("null")) {
+            return nullptr;
+        }
+        return parse_number();
+    }
+
+    value parse_object() {
+        object result;
+        expect('{');
+        skip_ws();
+        if (pos < text.size() && text[pos] == '}') {
+            ++pos;
+            return result;
+        }
+        while (true) {
+            skip_ws();
+            auto key = parse_string();
+            expect(':');
+            result[std::move(key)] = parse_value();
+            skip_ws();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+                continue;
+            }
+            expect('}');
+            return result;
+        }
+    }
+
+    value parse_array() {
+        array result;
+        expect('[');
+        skip_ws();
+        if (pos < text.size() && text[pos] == ']') {
+            ++pos;
+            return result;
+        }
+        while (true) {
+            result.push_back(parse_value());
+            skip_ws();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+                continue;
+            }
+            expect(']');
+            return result;
+        }
+    }
+
+    unsigned parse_hex4() {
+        if (pos + 4 > text.size()) {
+            fail("bad unicode escape");
+        }
+        unsigned code = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = text[pos++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                code |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                code |= c - 'A' + 10;
+            } else {
+                fail("bad unicode escape");
+            }
+        }
+        return code;
+    }
+
+    static void append_utf8(std::string& out, const unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | code >> 6);
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | code >> 12);
+            out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | code >> 18);
+            out += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+            out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    std::string parse_string() {
+        if (pos >= text.size() || text[pos] != '"') {
+            fail("expected string");
+        }
+        ++pos;
+        std::string result;
+        while (pos < text.size() && text[pos] != '"') {
+            const char c = text[pos++];
+            if (c != '\\') {
+                result += c;
+                continue;
+            }
+            if (pos >= text.size()) {
+                break;
+            }
+            switch (const char e = text[pos++]) {
+            case '"':
+            case '\\':
+            case '/': result += e; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            case 't': result += '\t'; break;
+            case 'u': {
+                auto code = parse_hex4();
+                if (code >= 0xDC00 && code < 0xE000) {
+                    fail("unpaired surrogate");
+                }
+                // 高代理项后必须紧跟低代理项
+                if (code >= 0xD800 && code < 0xDC00) {
+                    if (!consume("\\u")) {
+                        fail("unpaired surrogate");
+                    }
+                    const auto low = parse_hex4();
+                    if (low < 0xDC00 || low >= 0xE000) {
+                        fail("unpaired surrogate");
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                append_utf8(result, code);
+                break;
+            }
+            default: fail("bad escape");
+            }
+        }
+        if (pos >= text.size()) {
+            fail("unterminated string");
+        }
+        ++pos;
+        return result;
+    }
+
+    bool digit_at(const std::size_t i) const {
+        return i < text.size() && text[i] >= '0' && text[i] <= '9';
+    }
+
+    // 先按 RFC 8259 的 number 语法确定范围，strtod 会额外接受 nan、inf、十六进制和前导 '+'
+    value parse_number() {
+        auto end = pos;
+        if (end < text.size() && text[end] == '-') {
+            ++end;
+        }
+        if (!digit_at(end)) {
+            fail("unexpected character");
+        }
+        if (text[end] == '0') {
+            ++end;
+        } else {
+            while (digit_at(end)) {
+                ++end;
+            }
+        }
+        if (end < text.size() && text[end] == '.') {
+            ++end;
+            if (!digit_at(end)) {
+                fail("bad number");
+            }
+            while (digit_at(end)) {
+                ++end;
+            }
+        }
+        if (end < text.size() && (text[end] == 'e' || text[end] == 'E')) {
+            ++end;
+            if (end < text.size() && (text[end] == '+' || text[end] == '-')) {
+                ++end;
+            }
+            if (!digit_at(end)) {
+                fail("bad number");
+            }
+            while (digit_at(end)) {
+                ++end;
+            }
+        }
+        const double n = std::strtod(text.substr(pos, end - pos).c_str(), nullptr);
+        if (!std::isfinite(n)) {
+            fail("number out of range");
+        }
+        pos = end;
+        return n;
+    }
+};
+
+void dump(std::string& out, const value& v) {
+    if (v.is_null()) {
+        out += "null";
+    } else if (const auto* b = std::get_if<bool>(&v.data)) {
+        out += *b ? "true" : "false";
+    } else if (const auto* n = std::get_if<double>(&v.data)) {
+        char buf[32];
+        if (std::isfinite(*n) && *n == std::floor(*n) && std::fabs(*n) < 1e15) {
+            std::snprintf(buf, sizeof(buf), "%.0f", *n);
+        } else {
+            std::snprintf(buf, sizeof(buf), "%.17g", *n);
+        }
+        out += buf;
+    } else if (const auto* s = std::get_if<std::string>(&v.data)) {
+        out += quote(*s);
+    } else if (const auto* a = std::get_if<array>(&v.data)) {
+        out += '[';
+        for (std::size_t i = 0; i < a->size(); ++i) {
+            if (i > 0) {
+                out += ',';
+            }
+            dump(out, (*a)[i]);
+        }
+        out += ']';
+    } else {
+        out += '{';
+        bool first = true;
+        for (const auto& [key, item] : v.as_object()) {
+            if (!first) {
+                out += ',';
+            }
+            first = false;
+            out += quote(key);
+            out += ':';
+            dump(out, item);
+        }
+        out += '}';
+    }
+}
+
+} // namespace
+
+value parse(const std::string& text) {
+    return parser(text).parse_document();
+}
+
+std::string dump(const value& v) {
+    std::string out;
+    dump(out, v);
+    return out;
+}
+
+std::string quote(const std::string& s) {
+    std::string out = "\"";
+    for (const char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+} // namespace json
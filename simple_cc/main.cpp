@@ -1,110 +1,394 @@
 #include "build_grammar.hpp"
 #include "build_lexer.hpp"
+#include "driver.hpp"
+#include "helper.hpp"
+#include "ir.hpp"
+#include "passes.hpp"
+#include "server.hpp"
+#include "time_report.hpp"
+#include "trace.hpp"
+#include "x86.hpp"
 #include "semantic/sema.hpp"
 #include "utils.hpp"
+#include "vm.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <sstream>
+#include <thread>
 #include <vector>
 
+struct options {
+    std::string optimize_arg;
+    std::string args_passed_to_clang;
+    bool keep = false;
+    bool llvm_opt = false;
+    bool native = false;
+    bool run = false;
+    // -ftime-report / -ftime-report=json
+    bool report_time = false;
+    bool report_json = false;
+    int level = 0;
+    std::size_t jobs = 1;
+};
+
+// 单个文件的编译结果；--run 模式下先保存字节码，全部编译完成后再按输入顺序执行
+struct compile_result {
+    int status = 0;
+    std::string diagnostics;
+    std::optional<ir::vm::program> program;
+    time_report::report report;
+};
+
+// 每个文件使用独立的编译单元、语法树、sema_env 和输出流，词法分析器和分析表只读共享
+compile_result compile_file(const std::string& input_file, const std::string& output_arg, const options& opts,
+                            const lexer::lexer& lex_, const parser_t& parser) {
+    const trace::span span("compile " + input_file);
+    compile_result result;
+    std::stringstream err;
+    auto* report = opts.report_time ? &result.report : nullptr;
+
+    std::string il_name = std::string{"./"} + input_file + ".ll";
+    std::string opt_name = std::string{"./"} + input_file + ".opt.ll";
+    std::string asm_name = std::string{"./"} + input_file + ".s";
+    std::string obj_name = std::string{"./"} + input_file + ".o";
+    std::stringstream il;
+    std::ifstream ifs(input_file);
+
+    if (!ifs) {
+        result.status = 1;
+        result.diagnostics = "cannot open " + input_file + ".\n";
+        return result;
+    }
+
+    std::string input;
+    std::string tmp;
+    while (std::getline(ifs, tmp)) {
+        input += tmp;
+        input += '\n';
+    }
+
+    ifs.close();
+
+    auto fail = [&](const std::string& msg) {
+        err << msg << std::endl;
+        result.status = 1;
+        result.diagnostics = err.str();
+        return result;
+    };
+
+    std::vector<std::string> diagnostics;
+    const bool ok = compile_frontend(input, lex_, parser, il, diagnostics, report);
+    for (const auto& msg : diagnostics) {
+        err << msg << std::endl;
+    }
+
+    if (!ok) {
+        return fail("errors occurred, not generating output.");
+    }
+
+    if (opts.llvm_opt || opts.keep) {
+        std::ofstream(il_name) << il.str();
+    }
+
+    // 外部命令的耗时单独记为一个阶段
+    auto run_command = [&](const char* phase, const std::string& cmd) {
+        const time_report::scope scope(report, phase);
+        return system(cmd.c_str()) == 0;
+    };
+
+    if (opts.llvm_opt) {
+        // call opt to optimize
+        std::string opt_cmd = std::string{"opt -S "} + opts.optimize_arg + " -o " + opt_name + " " + il_name;
+        if (!run_command("opt", opt_cmd)) {
+            return fail("opt failed.");
+        }
+    } else {
+        // optimize in process
+        auto mod = [&] {
+            const time_report::scope scope(report, "ir_parse");
+            return ir::parse(il);
+        }();
+        {
+            const time_report::scope scope(report, "optimize");
+            ir::passes::optimize(mod, opts.level);
+        }
+        {
+            const time_report::scope scope(report, "codegen");
+            if (opts.run) {
+                result.program = ir::vm::compile(mod);
+            } else if (opts.native) {
+                std::ofstream asm_file(asm_name);
+                ir::x86::emit(asm_file, mod);
+            } else {
+                std::ofstream opt_file(opt_name);
+                ir::print(opt_file, mod);
+            }
+        }
+        if (opts.run) {
+            return result;
+        }
+    }
+
+    if (opts.native) {
+        // call as to assemble and cc to link against libc
+        std::string as_cmd = std::string{"as -o "} + obj_name + " " + asm_name;
+        if (!run_command("as", as_cmd)) {
+            return fail("as failed.");
+        }
+
+        std::string link_cmd = std::string{"cc "} + output_arg + " " + obj_name + " " + opts.args_passed_to_clang;
+        if (!run_command("link", link_cmd)) {
+            return fail("cc failed.");
+        }
+    } else {
+        // call clang to generate executable
+        std::string clang_cmd = std::string{"clang "} + opts.optimize_arg + " " + output_arg + " " + opt_name + " " + opts.args_passed_to_clang;
+
+        if (!run_command("clang", clang_cmd)) {
+            return fail("clang failed.");
+        }
+    }
+
+    if (!opts.keep) {
+        std::remove(il_name.c_str());
+        std::remove(opt_name.c_str());
+        std::remove(asm_name.c_str());
+        std::remove(obj_name.c_str());
+    }
+
+    result.diagnostics = err.str();
+    return result;
+}
+
+// 解析命令行中的非负整数，为空、含有多余字符或超出范围时返回 nullopt
+std::optional<std::size_t> parse_count(const std::string& str) {
+    std::size_t value = 0;
+    const auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (str.empty() || ec != std::errc{} || end != str.data() + str.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
 int main(const int argc, const char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <file>"
+        std::cerr << "Usage: " << argv[0] << " <file>..."
                   << " [-o <output_file>]"
                   << " [-O <optimization_level>]"
+                  << " [-j <jobs>](compile multiple files concurrently)"
                   << " [--keep](keep intermediate files)"
+                  << " [--llvm-opt](optimize with external opt instead of built-in passes)"
+                  << " [--native](generate x86-64 assembly, assemble with as and link with cc)"
+                  << " [--run](interpret the program directly instead of producing an executable)"
+                  << " [--server[=<socket>]](serve line-delimited JSON requests on stdin/stdout or a Unix socket)"
+                  << " [-ftime-report[=json]](report time, allocations and peak RSS of each phase on stderr)"
+                  << " [--trace=<file>](write a Chrome trace_event JSON file, viewable in Perfetto)"
+                  << " [--trace-actions=<n>](with --trace, record every n-th semantic action)"
                   << " [-- <args_passed_to_clang>]" << std::endl;
         return 1;
     }
 
     std::vector<std::string> args(argv + 1, argv + argc);
-    std::string input_file = args[0];
-    std::string output_arg;
-    std::string optimize_arg;
-    std::string args_passed_to_clang;
-    bool keep = false;
-
-    if (const auto output_it = std::ranges::find(args, "-o");
-        output_it != args.end() && std::next(output_it) != args.end()) {
-        output_arg = "-o " + *std::next(output_it);
-    }
+    std::vector<std::string> input_files;
+    options opts;
 
-    if (const auto optimize_it = std::ranges::find(args, "-O");
-        optimize_it != args.end() && std::next(optimize_it) != args.end()) {
-        optimize_arg = "-O" + *std::next(optimize_it);
+    const auto clang_it = std::ranges::find(args, "--");
+    if (clang_it != args.end() && std::next(clang_it) != args.end()) {
+        opts.args_passed_to_clang = utils::join(std::vector(std::next(clang_it), args.end()), " ");
     }
 
-    if (optimize_arg.empty()) {
-        for (auto&& arg : args) {
-            if (arg.starts_with("-O")) {
-                optimize_arg = arg;
-                break;
+    std::string output_file;
+    bool server_mode = false;
+    std::string socket_path;
+    std::string trace_file;
+    std::size_t trace_actions = 0;
+    for (auto it = args.begin(); it != clang_it; ++it) {
+        const auto& arg = *it;
+        const bool has_value = std::next(it) != clang_it;
+        if (arg == "-o" && has_value) {
+            output_file = *++it;
+        } else if (arg == "-O" && has_value) {
+            opts.optimize_arg = "-O" + *++it;
+        } else if (arg.starts_with("-j") && (arg.size() > 2 || has_value)) {
+            const auto value = arg.size() > 2 ? arg.substr(2) : *++it;
+            const auto jobs = parse_count(value);
+            if (!jobs) {
+                std::cerr << "invalid number of jobs: " << value << "." << std::endl;
+                return 1;
+            }
+            opts.jobs = *jobs;
+        } else if (arg.starts_with("-O")) {
+            if (opts.optimize_arg.empty()) {
+                opts.optimize_arg = arg;
+            }
+        } else if (arg == "--keep") {
+            opts.keep = true;
+        } else if (arg == "--native") {
+            opts.native = true;
+        } else if (arg == "--run") {
+            opts.run = true;
+        } else if (arg == "--llvm-opt") {
+            opts.llvm_opt = true;
+        } else if (arg == "-ftime-report" || arg == "-ftime-report=text") {
+            opts.report_time = true;
+        } else if (arg == "-ftime-report=json") {
+            opts.report_time = true;
+            opts.report_json = true;
+        } else if (arg.starts_with("--trace=")) {
+            trace_file = arg.substr(8);
+        } else if (arg.starts_with("--trace-actions=")) {
+            const auto sample = parse_count(arg.substr(16));
+            if (!sample) {
+                std::cerr << "invalid value for --trace-actions: " << arg.substr(16) << "." << std::endl;
+                return 1;
             }
+            trace_actions = *sample;
+        } else if (arg == "--server") {
+            server_mode = true;
+        } else if (arg.starts_with("--server=")) {
+            server_mode = true;
+            socket_path = arg.substr(9);
+        } else if (!arg.starts_with("-")) {
+            input_files.push_back(arg);
         }
     }
 
-    if (const auto clang_it = std::ranges::find(args, "--");
-        clang_it != args.end() && std::next(clang_it) != args.end()) {
-        args_passed_to_clang = utils::join(std::vector(std::next(clang_it), args.end()), " ");
+    opts.llvm_opt = opts.llvm_opt && !opts.native && !opts.run;
+    opts.jobs = std::max<std::size_t>(opts.jobs, 1);
+    if (opts.optimize_arg.size() > 2) {
+        opts.level = std::isdigit(opts.optimize_arg[2]) ? opts.optimize_arg[2] - '0' : 2;
     }
 
-    if (std::ranges::find(args, "--keep") != args.end()) {
-        keep = true;
+    if (!trace_file.empty()) {
+        trace::start(trace_actions);
     }
+    // 正常结束时写出 trace，编译服务在收到 shutdown 后写出
+    auto write_trace = [&] {
+        if (trace_file.empty()) {
+            return;
+        }
+        trace::stop();
+        std::ofstream ofs(trace_file);
+        if (!ofs) {
+            std::cerr << "cannot open " << trace_file << "." << std::endl;
+            return;
+        }
+        trace::write(ofs);
+    };
 
-    std::string il_name = std::string{"./"} + input_file + ".ll";
-    std::string opt_name = std::string{"./"} + input_file + ".opt.ll";
-    std::ofstream il(il_name);
-    std::ifstream ifs(input_file);
-
-    std::string input;
-    std::string tmp;
-    while (std::getline(ifs, tmp)) {
-        input += tmp;
-        input += '\n';
+    if (server_mode) {
+        const auto lex_ = build_lexer();
+        parser_t parser(build_grammar());
+        parser.build();
+        const int status = socket_path.empty() ? server::serve(std::cin, std::cout, lex_, parser)
+                                               : server::serve_unix(socket_path, lex_, parser);
+        write_trace();
+        return status;
     }
 
-    ifs.close();
+    if (input_files.empty()) {
+        std::cerr << "no input files." << std::endl;
+        return 1;
+    }
 
-    auto tokens = lex(input);
-    auto prods = build_grammar();
-    auto parser = semantic::sema<grammar::LR1>(prods, il);
-    parser.build();
-    parser.parse(tokens);
+    const bool batch = input_files.size() > 1;
+    if (batch && !output_file.empty()) {
+        std::cerr << "-o cannot be used with multiple input files." << std::endl;
+        return 1;
+    }
 
-    auto tree = std::static_pointer_cast<semantic::sema_tree>(parser.get_tree());
-    auto env = tree->calc();
+    // 批量模式下每个输入文件输出到去掉扩展名的同名可执行文件
+    auto output_arg_of = [&](const std::string& input_file) -> std::string {
+        if (!batch) {
+            return output_file.empty() ? "" : "-o " + output_file;
+        }
+        const auto dot = input_file.find_last_of('.');
+        const auto slash = input_file.find_last_of('/');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return "-o " + input_file + ".out";
+        }
+        return "-o " + input_file.substr(0, dot);
+    };
 
-    il.close();
+    time_report::report report;
+    auto* timing = opts.report_time ? &report : nullptr;
 
-    for (const auto& err : env.errors) {
-        std::cerr << err << std::endl;
+    // 词法分析器和 LR(1) 分析表只构建一次
+    const auto lex_ = [&] {
+        const time_report::scope scope(timing, "build_lexer");
+        return build_lexer();
+    }();
+    auto parser = [&] {
+        const time_report::scope scope(timing, "build_grammar");
+        return parser_t(build_grammar());
+    }();
+    {
+        const time_report::scope scope(timing, "build_tables");
+        parser.build();
+    }
+    if (timing) {
+        report.count("dfa_states", lex_.dfa_states());
+        report.count("lr_states", parser.state_count());
+        report.count("action_entries", parser.action_count());
+        report.count("goto_entries", parser.goto_count());
     }
 
-    if (!env.errors.empty()) {
-        std::cerr << "errors occurred, not generating output." << std::endl;
-        return 1;
+    std::vector<compile_result> results(input_files.size());
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        for (std::size_t i; (i = next++) < input_files.size();) {
+            results[i] = compile_file(input_files[i], output_arg_of(input_files[i]), opts, lex_, parser);
+        }
+    };
+
+    if (opts.jobs == 1 || !batch) {
+        worker();
+    } else {
+        std::vector<std::jthread> workers;
+        for (std::size_t j = 0; j < std::min(opts.jobs, input_files.size()); ++j) {
+            workers.emplace_back(worker);
+        }
     }
 
-    // call opt to optimize
-    std::string opt_cmd = std::string{"opt -S "} + optimize_arg + " -o " + opt_name + " " + il_name;
-    if (system(opt_cmd.c_str()) != 0) {
-        std::cerr << "opt failed." << std::endl;
-        return 1;
+    int status = 0;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        auto& result = results[i];
+        if (!result.diagnostics.empty()) {
+            if (batch) {
+                std::cerr << input_files[i] << ":" << std::endl;
+            }
+            std::cerr << result.diagnostics;
+        }
+        if (result.status != 0 && status == 0) {
+            status = result.status;
+        }
     }
 
-    // call clang to generate executable
-    std::string clang_cmd = std::string{"clang "} + optimize_arg + " " + output_arg + " " + opt_name + " " + args_passed_to_clang;
+    if (timing) {
+        for (const auto& result : results) {
+            report.merge(result.report);
+        }
+    }
 
-    if (system(clang_cmd.c_str()) != 0) {
-        std::cerr << "clang failed." << std::endl;
-        return 1;
+    if (opts.run && status == 0) {
+        const time_report::scope scope(timing, "run");
+        for (const auto& result : results) {
+            if (const int code = ir::vm::run(*result.program); code != 0 && status == 0) {
+                status = code;
+            }
+        }
     }
 
-    if (!keep) {
-        std::remove(il_name.c_str());
-        std::remove(opt_name.c_str());
+    write_trace();
+    if (timing) {
+        opts.report_json ? report.print_json(std::cerr) : report.print(std::cerr);
     }
 
-    return 0;
+    return status;
 }
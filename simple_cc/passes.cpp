@@ -0,0 +1,754 @@
+#include "passes.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_set>
+
+namespace ir::passes {
+
+namespace {
+
+struct dominator_tree {
+    std::vector<std::size_t> idom;
+    std::vector<std::vector<std::size_t>> children;
+    std::vector<std::unordered_set<std::size_t>> frontier;
+
+    explicit dominator_tree(const function& func) {
+        const auto n = func.blocks.size();
+        const auto index = func.block_index();
+        const auto preds = func.predecessors();
+        const auto rpo = func.reverse_post_order();
+
+        constexpr auto undefined = std::numeric_limits<std::size_t>::max();
+        std::vector<std::size_t> rpo_num(n, undefined);
+        for (std::size_t i = 0; i < rpo.size(); ++i) {
+            rpo_num[rpo[i]] = i;
+        }
+
+        idom.assign(n, undefined);
+        idom[0] = 0;
+
+        auto intersect = [&](std::size_t a, std::size_t b) {
+            while (a != b) {
+                while (rpo_num[a] > rpo_num[b]) {
+                    a = idom[a];
+                }
+                while (rpo_num[b] > rpo_num[a]) {
+                    b = idom[b];
+                }
+            }
+            return a;
+        };
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (const auto b : rpo) {
+                if (b == 0) {
+                    continue;
+                }
+                auto new_idom = undefined;
+                for (const auto& p : preds.at(func.blocks[b].label)) {
+                    const auto pi = index.at(p);
+                    if (idom[pi] == undefined) {
+                        continue;
+                    }
+                    new_idom = new_idom == undefined ? pi : intersect(pi, new_idom);
+                }
+                if (new_idom != undefined && idom[b] != new_idom) {
+                    idom[b] = new_idom;
+                    changed = true;
+                }
+            }
+        }
+
+        children.assign(n, {});
+        for (const auto b : rpo) {
+            if (b != 0) {
+                children[idom[b]].push_back(b);
+            }
+        }
+
+        frontier.assign(n, {});
+        for (const auto b : rpo) {
+            const auto& bp = preds.at(func.blocks[b].label);
+            if (bp.size() < 2) {
+                continue;
+            }
+            for (const auto& p : bp) {
+                auto runner = index.at(p);
+                if (idom[runner] == undefined) {
+                    continue;
+                }
+                while (runner != idom[b]) {
+                    frontier[runner].insert(b);
+                    runner = idom[runner];
+                }
+            }
+        }
+    }
+};
+
+instruction make_br(const std::string& label) {
+    instruction br{};
+    br.op = opcode::br;
+    br.labels = {label};
+    return br;
+}
+
+void remove_incoming(block& b, const std::string& pred) {
+    for (auto& inst : b.insts) {
+        if (inst.op != opcode::phi) {
+            break;
+        }
+        for (std::size_t i = 0; i < inst.labels.size();) {
+            if (inst.labels[i] == pred) {
+                inst.labels.erase(inst.labels.begin() + static_cast<std::ptrdiff_t>(i));
+                inst.operands.erase(inst.operands.begin() + static_cast<std::ptrdiff_t>(i));
+            } else {
+                ++i;
+            }
+        }
+    }
+}
+
+bool remove_unreachable(function& func) {
+    if (func.blocks.empty()) {
+        return false;
+    }
+    const auto rpo = func.reverse_post_order();
+    if (rpo.size() == func.blocks.size()) {
+        return false;
+    }
+    std::vector<bool> reachable(func.blocks.size(), false);
+    for (const auto b : rpo) {
+        reachable[b] = true;
+    }
+    const auto index = func.block_index();
+    for (std::size_t i = 0; i < func.blocks.size(); ++i) {
+        if (reachable[i]) {
+            continue;
+        }
+        for (const auto& succ : func.blocks[i].successors()) {
+            remove_incoming(func.blocks[index.at(succ)], func.blocks[i].label);
+        }
+    }
+    std::vector<block> kept;
+    kept.reserve(rpo.size());
+    for (std::size_t i = 0; i < func.blocks.size(); ++i) {
+        if (reachable[i]) {
+            kept.push_back(std::move(func.blocks[i]));
+        }
+    }
+    func.blocks = std::move(kept);
+    return true;
+}
+
+// 把只有一个前驱且前驱无条件跳转过来的块合并进前驱，并让只含一条无条件跳转的块的前驱直接跳到目标
+// 前驱表随修改增量维护，被合并的 phi 的使用最后统一替换，删除的块最后统一移除
+bool merge_blocks(function& func) {
+    const auto index = func.block_index();
+    auto preds = func.predecessors();
+    std::vector<bool> removed(func.blocks.size(), false);
+    std::unordered_map<std::string, value> replacements;
+
+    // 按块的顺序处理，入口块不会被合并或绕过
+    std::vector<std::size_t> worklist;
+    for (std::size_t bi = func.blocks.size(); bi-- > 1;) {
+        worklist.push_back(bi);
+    }
+    bool changed = false;
+    while (!worklist.empty()) {
+        const auto bi = worklist.back();
+        worklist.pop_back();
+        if (bi == 0 || removed[bi]) {
+            continue;
+        }
+        auto& b = func.blocks[bi];
+
+        if (const auto& bp = preds.at(b.label); bp.size() == 1 && bp[0] != b.label) {
+            auto& p = func.blocks[index.at(bp[0])];
+            if (p.insts.back().op == opcode::br) {
+                p.insts.pop_back();
+                for (auto& inst : b.insts) {
+                    if (inst.op == opcode::phi) {
+                        replacements[inst.result] = inst.operands.empty() ? value{} : inst.operands[0];
+                    } else {
+                        p.insts.push_back(std::move(inst));
+                    }
+                }
+                for (const auto& succ : p.successors()) {
+                    for (auto& inst : func.blocks[index.at(succ)].insts) {
+                        if (inst.op != opcode::phi) {
+                            break;
+                        }
+                        std::ranges::replace(inst.labels, b.label, p.label);
+                    }
+                    std::ranges::replace(preds.at(succ), b.label, p.label);
+                    // 后继的前驱变成了 p，可能可以继续合并
+                    worklist.push_back(index.at(succ));
+                }
+                b.insts.clear();
+                removed[bi] = true;
+                preds.erase(b.label);
+                changed = true;
+                continue;
+            }
+        }
+
+        if (b.insts.size() != 1 || b.insts[0].op != opcode::br) {
+            continue;
+        }
+        const auto target = b.insts[0].labels[0];
+        const auto ti = index.at(target);
+        if (target == b.label || func.blocks[ti].insts.front().op == opcode::phi) {
+            continue;
+        }
+        auto& target_preds = preds.at(target);
+        std::erase(target_preds, b.label);
+        for (const auto& p : preds.at(b.label)) {
+            std::ranges::replace(func.blocks[index.at(p)].insts.back().labels, b.label, target);
+            if (std::ranges::find(target_preds, p) == target_preds.end()) {
+                target_preds.push_back(p);
+            }
+        }
+        // 绕过后 b 不可达
+        b.insts.clear();
+        removed[bi] = true;
+        preds.erase(b.label);
+        worklist.push_back(ti);
+        changed = true;
+    }
+
+    if (!changed) {
+        return false;
+    }
+    std::vector<block> kept;
+    kept.reserve(func.blocks.size());
+    for (std::size_t i = 0; i < func.blocks.size(); ++i) {
+        if (!removed[i]) {
+            kept.push_back(std::move(func.blocks[i]));
+        }
+    }
+    func.blocks = std::move(kept);
+    func.replace_uses(replacements);
+    return true;
+}
+
+std::int64_t wrap(const std::int64_t v, const type& ty) {
+    switch (ty.base) {
+    case type::kind::i1: return v & 1;
+    case type::kind::i8: return static_cast<std::int8_t>(v);
+    case type::kind::i32: return static_cast<std::int32_t>(v);
+    default: return v;
+    }
+}
+
+double as_double(const value& v) {
+    return v.k == value::kind::fimm ? v.fimm : static_cast<double>(v.imm);
+}
+
+std::optional<value> fold_int(const instruction& inst, const std::int64_t l, const std::int64_t r) {
+    const auto ul = static_cast<std::uint64_t>(l);
+    const auto ur = static_cast<std::uint64_t>(r);
+    switch (inst.op) {
+    case opcode::add: return value::constant(wrap(static_cast<std::int64_t>(ul + ur), inst.ty));
+    case opcode::sub: return value::constant(wrap(static_cast<std::int64_t>(ul - ur), inst.ty));
+    case opcode::mul: return value::constant(wrap(static_cast<std::int64_t>(ul * ur), inst.ty));
+    case opcode::and_: return value::constant(wrap(l & r, inst.ty));
+    case opcode::or_: return value::constant(wrap(l | r, inst.ty));
+    case opcode::xor_: return value::constant(wrap(l ^ r, inst.ty));
+    case opcode::sdiv:
+        if (r == 0 || (r == -1 && l == wrap(std::numeric_limits<std::int64_t>::min(), inst.ty))) {
+            return std::nullopt;
+        }
+        if (r == -1) {
+            return value::constant(wrap(static_cast<std::int64_t>(0 - ul), inst.ty));
+        }
+        return value::constant(wrap(l / r, inst.ty));
+    default: return std::nullopt;
+    }
+}
+
+std::optional<value> fold_float(const instruction& inst, const double l, const double r) {
+    switch (inst.op) {
+    case opcode::fadd: return value::constant(l + r);
+    case opcode::fsub: return value::constant(l - r);
+    case opcode::fmul: return value::constant(l * r);
+    case opcode::fdiv: return value::constant(l / r);
+    default: return std::nullopt;
+    }
+}
+
+std::optional<value> fold_icmp(const std::string& pred, const std::int64_t l, const std::int64_t r) {
+    const auto ul = static_cast<std::uint64_t>(l);
+    const auto ur = static_cast<std::uint64_t>(r);
+    bool res;
+    if (pred == "eq") {
+        res = l == r;
+    } else if (pred == "ne") {
+        res = l != r;
+    } else if (pred == "slt") {
+        res = l < r;
+    } else if (pred == "sle") {
+        res = l <= r;
+    } else if (pred == "sgt") {
+        res = l > r;
+    } else if (pred == "sge") {
+        res = l >= r;
+    } else if (pred == "ult") {
+        res = ul < ur;
+    } else if (pred == "ule") {
+        res = ul <= ur;
+    } else if (pred == "ugt") {
+        res = ul > ur;
+    } else if (pred == "uge") {
+        res = ul >= ur;
+    } else {
+        return std::nullopt;
+    }
+    return value::constant(std::int64_t{res});
+}
+
+std::optional<value> fold_fcmp(const std::string& pred, const double l, const double r) {
+    if (std::isnan(l) || std::isnan(r)) {
+        return pred.starts_with("o") ? std::optional(value::constant(std::int64_t{0})) : std::nullopt;
+    }
+    bool res;
+    if (pred == "oeq") {
+        res = l == r;
+    } else if (pred == "one") {
+        res = l != r;
+    } else if (pred == "olt") {
+        res = l < r;
+    } else if (pred == "ole") {
+        res = l <= r;
+    } else if (pred == "ogt") {
+        res = l > r;
+    } else if (pred == "oge") {
+        res = l >= r;
+    } else {
+        return std::nullopt;
+    }
+    return value::constant(std::int64_t{res});
+}
+
+std::optional<value> fold_cast(const instruction& inst, const value& v) {
+    switch (inst.op) {
+    case opcode::zext: {
+        // 按源类型的位宽取低位；i8 与 i1 的大小相同，必须按类型区分
+        const auto bits = static_cast<std::uint64_t>(v.imm);
+        switch (inst.ty.base) {
+        case type::kind::i1: return value::constant(static_cast<std::int64_t>(bits & 1));
+        case type::kind::i8: return value::constant(static_cast<std::int64_t>(bits & 0xff));
+        case type::kind::i32: return value::constant(static_cast<std::int64_t>(bits & 0xffffffff));
+        default: return value::constant(v.imm);
+        }
+    }
+    case opcode::sext: return value::constant(inst.ty.base == type::kind::i1 ? -(v.imm & 1) : wrap(v.imm, inst.ty));
+    case opcode::trunc: return value::constant(wrap(v.imm, inst.to));
+    case opcode::sitofp: return value::constant(static_cast<double>(v.imm));
+    case opcode::fptosi: {
+        const auto d = as_double(v);
+        const auto limit = inst.to.base == type::kind::i32 ? 2147483648.0 : 9223372036854775808.0;
+        if (std::isnan(d) || d >= limit || d < -limit) {
+            return std::nullopt;
+        }
+        return value::constant(static_cast<std::int64_t>(d));
+    }
+    default: return std::nullopt;
+    }
+}
+
+std::optional<value> fold(const instruction& inst, const std::unordered_map<std::string, const instruction*>& defs) {
+    const auto& ops = inst.operands;
+    switch (inst.op) {
+    case opcode::add:
+    case opcode::sub:
+    case opcode::mul:
+    case opcode::sdiv:
+    case opcode::and_:
+    case opcode::or_:
+    case opcode::xor_:
+        if (ops[0].k == value::kind::imm && ops[1].k == value::kind::imm) {
+            return fold_int(inst, ops[0].imm, ops[1].imm);
+        }
+        break;
+    case opcode::fadd:
+    case opcode::fsub:
+    case opcode::fmul:
+    case opcode::fdiv:
+        if (ops[0].is_const() && ops[1].is_const()) {
+            return fold_float(inst, as_double(ops[0]), as_double(ops[1]));
+        }
+        break;
+    case opcode::icmp:
+        if (ops[0].k == value::kind::imm && ops[1].k == value::kind::imm) {
+            return fold_icmp(inst.pred, ops[0].imm, ops[1].imm);
+        }
+        // icmp ne (zext i1 %x), 0 => %x，convert_to_i1 在比较结果上会产生这种模式
+        if (inst.pred == "ne" && ops[0].is_reg() && ops[1] == value::constant(std::int64_t{0})) {
+            if (const auto it = defs.find(ops[0].name); it != defs.end() && it->second->op == opcode::zext
+                                                         && it->second->ty == type{type::kind::i1}) {
+                return it->second->operands[0];
+            }
+        }
+        break;
+    case opcode::fcmp:
+        if (ops[0].is_const() && ops[1].is_const()) {
+            return fold_fcmp(inst.pred, as_double(ops[0]), as_double(ops[1]));
+        }
+        break;
+    case opcode::zext:
+    case opcode::sext:
+    case opcode::trunc:
+    case opcode::sitofp:
+        if (ops[0].k == value::kind::imm) {
+            return fold_cast(inst, ops[0]);
+        }
+        break;
+    case opcode::fptosi:
+        if (ops[0].is_const()) {
+            return fold_cast(inst, ops[0]);
+        }
+        break;
+    case opcode::phi: {
+        std::optional<value> same;
+        bool has_undef = false;
+        for (const auto& op : ops) {
+            if (op.is_reg() && op.name == inst.result) {
+                continue;
+            }
+            if (op.k == value::kind::undef) {
+                has_undef = true;
+                continue;
+            }
+            if (same && !(*same == op)) {
+                return std::nullopt;
+            }
+            same = op;
+        }
+        if (!same) {
+            return value{};
+        }
+        // undef 来源只能被常量替代，寄存器未必支配该 phi
+        if (has_undef && same->is_reg()) {
+            return std::nullopt;
+        }
+        return same;
+    }
+    default: break;
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+void mem2reg(function& func) {
+    if (func.blocks.empty()) {
+        return;
+    }
+    remove_unreachable(func);
+
+    std::unordered_map<std::string, type> allocas;
+    for (const auto& b : func.blocks) {
+        for (const auto& inst : b.insts) {
+            if (inst.op == opcode::alloca_) {
+                allocas[inst.result] = inst.ty;
+            }
+        }
+    }
+
+    std::unordered_set<std::string> escaped;
+    for (const auto& b : func.blocks) {
+        for (const auto& inst : b.insts) {
+            for (std::size_t i = 0; i < inst.operands.size(); ++i) {
+                const auto& op = inst.operands[i];
+                if (!op.is_reg() || !allocas.contains(op.name)) {
+                    continue;
+                }
+                const bool is_ptr_use = (inst.op == opcode::load && i == 0) || (inst.op == opcode::store && i == 1);
+                if (!is_ptr_use) {
+                    escaped.insert(op.name);
+                }
+            }
+        }
+    }
+
+    // 无法提升的 alloca 移到入口块，避免在循环中反复分配栈空间
+    std::vector<instruction> hoisted;
+    for (std::size_t bi = 0; bi < func.blocks.size(); ++bi) {
+        auto& insts = func.blocks[bi].insts;
+        for (auto it = insts.begin(); it != insts.end();) {
+            if (it->op == opcode::alloca_ && (bi != 0 || escaped.contains(it->result))) {
+                if (escaped.contains(it->result)) {
+                    hoisted.push_back(std::move(*it));
+                }
+                it = insts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    auto& entry = func.blocks[0].insts;
+    std::erase_if(entry, [&](const instruction& inst) {
+        return inst.op == opcode::alloca_ && !escaped.contains(inst.result);
+    });
+    entry.insert(entry.begin(), std::make_move_iterator(hoisted.begin()), std::make_move_iterator(hoisted.end()));
+
+    for (const auto& name : escaped) {
+        allocas.erase(name);
+    }
+    if (allocas.empty()) {
+        return;
+    }
+
+    const dominator_tree dom(func);
+    const auto index = func.block_index();
+
+    std::unordered_map<std::string, std::unordered_set<std::size_t>> def_blocks;
+    for (std::size_t bi = 0; bi < func.blocks.size(); ++bi) {
+        for (const auto& inst : func.blocks[bi].insts) {
+            if (inst.op == opcode::store && inst.operands[1].is_reg() && allocas.contains(inst.operands[1].name)) {
+                def_blocks[inst.operands[1].name].insert(bi);
+            }
+        }
+    }
+
+    // phi 结果名 -> 对应的 alloca
+    std::unordered_map<std::string, std::string> phi_var;
+    for (const auto& [var, ty] : allocas) {
+        std::vector<std::size_t> worklist(def_blocks[var].begin(), def_blocks[var].end());
+        std::unordered_set<std::size_t> has_phi;
+        while (!worklist.empty()) {
+            const auto b = worklist.back();
+            worklist.pop_back();
+            for (const auto d : dom.frontier[b]) {
+                if (!has_phi.insert(d).second) {
+                    continue;
+                }
+                instruction phi{};
+                phi.op = opcode::phi;
+                phi.ty = ty;
+                phi.result = var + "." + func.blocks[d].label;
+                phi_var[phi.result] = var;
+                auto& insts = func.blocks[d].insts;
+                insts.insert(insts.begin(), std::move(phi));
+                if (!def_blocks[var].contains(d)) {
+                    worklist.push_back(d);
+                }
+            }
+        }
+    }
+
+    std::unordered_map<std::string, value> replacements;
+    std::unordered_map<std::string, std::vector<value>> stacks;
+    auto current = [&](const std::string& var) {
+        const auto& st = stacks[var];
+        return st.empty() ? value{} : st.back();
+    };
+
+    struct frame {
+        std::size_t block;
+        bool exit;
+        std::vector<std::string> pushed;
+    };
+    std::vector<frame> work{{0, false, {}}};
+    while (!work.empty()) {
+        auto fr = std::move(work.back());
+        work.pop_back();
+        if (fr.exit) {
+            for (const auto& var : fr.pushed) {
+                stacks[var].pop_back();
+            }
+            continue;
+        }
+
+        auto& b = func.blocks[fr.block];
+        std::vector<std::string> pushed;
+        std::vector<instruction> kept;
+        kept.reserve(b.insts.size());
+        for (auto& inst : b.insts) {
+            if (inst.op == opcode::phi && phi_var.contains(inst.result)) {
+                const auto& var = phi_var.at(inst.result);
+                stacks[var].push_back(value::reg(inst.result));
+                pushed.push_back(var);
+            } else if (inst.op == opcode::load && inst.operands[0].is_reg() && allocas.contains(inst.operands[0].name)) {
+                replacements[inst.result] = current(inst.operands[0].name);
+                continue;
+            } else if (inst.op == opcode::store && inst.operands[1].is_reg() && allocas.contains(inst.operands[1].name)) {
+                stacks[inst.operands[1].name].push_back(inst.operands[0]);
+                pushed.push_back(inst.operands[1].name);
+                continue;
+            }
+            kept.push_back(std::move(inst));
+        }
+        b.insts = std::move(kept);
+
+        for (const auto& succ : b.successors()) {
+            for (auto& inst : func.blocks[index.at(succ)].insts) {
+                if (inst.op != opcode::phi) {
+                    break;
+                }
+                if (const auto it = phi_var.find(inst.result); it != phi_var.end()) {
+                    inst.operands.push_back(current(it->second));
+                    inst.labels.push_back(b.label);
+                }
+            }
+        }
+
+        work.push_back({fr.block, true, std::move(pushed)});
+        for (const auto child : dom.children[fr.block]) {
+            work.push_back({child, false, {}});
+        }
+    }
+
+    func.replace_uses(replacements);
+}
+
+bool fold_constants(function& func) {
+    bool changed_any = false;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        std::unordered_map<std::string, const instruction*> defs;
+        for (const auto& b : func.blocks) {
+            for (const auto& inst : b.insts) {
+                if (inst.has_result()) {
+                    defs[inst.result] = &inst;
+                }
+            }
+        }
+        std::unordered_map<std::string, value> replacements;
+        for (const auto& b : func.blocks) {
+            for (const auto& inst : b.insts) {
+                if (!inst.has_result() || inst.has_side_effect()) {
+                    continue;
+                }
+                auto folded = fold(inst, defs);
+                if (!folded) {
+                    continue;
+                }
+                // 互相引用的 phi 环没有外部定义，其值为 undef
+                auto target = *folded;
+                while (target.is_reg() && replacements.contains(target.name)) {
+                    if (target.name == inst.result) {
+                        break;
+                    }
+                    target = replacements.at(target.name);
+                }
+                replacements[inst.result] = target.is_reg() && target.name == inst.result ? value{} : *folded;
+            }
+        }
+        if (replacements.empty()) {
+            break;
+        }
+        for (auto& b : func.blocks) {
+            std::erase_if(b.insts, [&](const instruction& inst) {
+                return inst.has_result() && replacements.contains(inst.result);
+            });
+        }
+        func.replace_uses(replacements);
+        changed = true;
+        changed_any = true;
+    }
+    return changed_any;
+}
+
+bool dce(function& func) {
+    std::unordered_map<std::string, const instruction*> defs;
+    std::vector<const instruction*> worklist;
+    for (const auto& b : func.blocks) {
+        for (const auto& inst : b.insts) {
+            if (inst.has_result()) {
+                defs[inst.result] = &inst;
+            }
+            if (inst.has_side_effect()) {
+                worklist.push_back(&inst);
+            }
+        }
+    }
+
+    std::unordered_set<std::string> live;
+    while (!worklist.empty()) {
+        const auto* inst = worklist.back();
+        worklist.pop_back();
+        for (const auto& op : inst->operands) {
+            if (!op.is_reg() || live.contains(op.name)) {
+                continue;
+            }
+            live.insert(op.name);
+            if (const auto it = defs.find(op.name); it != defs.end()) {
+                worklist.push_back(it->second);
+            }
+        }
+    }
+
+    bool changed = false;
+    for (auto& b : func.blocks) {
+        changed |= std::erase_if(b.insts, [&](const instruction& inst) {
+                       return !inst.has_side_effect() && inst.has_result() && !live.contains(inst.result);
+                   })
+                 > 0;
+    }
+    return changed;
+}
+
+bool simplify_cfg(function& func) {
+    bool changed_any = false;
+    bool changed = true;
+    // 每一轮都是线性的；合并块后 phi 被替换为常量可能产生新的常量分支，由下一轮处理
+    while (changed && !func.blocks.empty()) {
+        changed = false;
+
+        const auto index = func.block_index();
+        for (auto& b : func.blocks) {
+            auto& term = b.insts.back();
+            if (term.op != opcode::cond_br) {
+                continue;
+            }
+            if (term.labels[0] == term.labels[1]) {
+                term = make_br(term.labels[0]);
+                changed = true;
+            } else if (term.operands[0].k == value::kind::imm) {
+                const auto taken = term.labels[term.operands[0].imm ? 0 : 1];
+                const auto dropped = term.labels[term.operands[0].imm ? 1 : 0];
+                remove_incoming(func.blocks[index.at(dropped)], b.label);
+                term = make_br(taken);
+                changed = true;
+            }
+        }
+
+        changed |= remove_unreachable(func);
+        changed |= merge_blocks(func);
+        changed_any |= changed;
+    }
+    return changed_any;
+}
+
+void optimize(module& mod, const int level) {
+    if (level <= 0) {
+        return;
+    }
+    for (auto& func : mod.functions) {
+        simplify_cfg(func);
+        mem2reg(func);
+        fold_constants(func);
+        dce(func);
+        simplify_cfg(func);
+        for (int i = 1; i < level; ++i) {
+            bool changed = fold_constants(func);
+            changed |= dce(func);
+            changed |= simplify_cfg(func);
+            if (!changed) {
+                break;
+            }
+        }
+    }
+}
+
+} // namespace ir::passes
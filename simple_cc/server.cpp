@@ -0,0 +1,298 @@
+#include "server.hpp"
+#include "ir.hpp"
+#include "json.hpp"
+#include "passes.hpp"
+#include "x86.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace server {
+
+namespace {
+
+// JSON 数字表示的非负整数，超出 size_t 的值饱和为最大值，由调用者按范围拒绝；非有限值、小数或负数返回 nullopt
+std::optional<std::size_t> as_count(const json::value& v) {
+    if (!v.is_number()) {
+        return std::nullopt;
+    }
+    const auto d = v.as_number();
+    if (!std::isfinite(d) || d < 0 || d != std::floor(d)) {
+        return std::nullopt;
+    }
+    if (d >= 18446744073709551616.0) {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    return static_cast<std::size_t>(d);
+}
+
+} // namespace
+
+std::string handle(const std::string& line, const lexer::lexer& lex_, const parser_t& parser, session& state, bool& shutdown) {
+    const trace::span span("server::handle");
+    const auto start = std::chrono::steady_clock::now();
+    json::object response;
+    json::array diagnostics;
+
+    auto finish = [&](const bool ok) {
+        response["ok"] = ok;
+        if (!ok) {
+            response["diagnostics"] = std::move(diagnostics);
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        response["elapsed_ms"] = elapsed.count();
+        return json::dump(response);
+    };
+
+    json::value request;
+    try {
+        request = json::parse(line);
+    } catch (const std::exception& e) {
+        diagnostics.emplace_back(std::string("invalid request: ") + e.what());
+        return finish(false);
+    }
+    if (!request.is_object()) {
+        diagnostics.emplace_back("invalid request: expected an object");
+        return finish(false);
+    }
+    response["id"] = request["id"];
+
+    const auto& cmd = request["cmd"];
+    if (cmd.is_string() && cmd.as_string() == "ping") {
+        return finish(true);
+    }
+    if (cmd.is_string() && cmd.as_string() == "shutdown") {
+        shutdown = true;
+        return finish(true);
+    }
+    const auto& doc_name = request["doc"];
+    if (cmd.is_string() && cmd.as_string() == "close") {
+        if (doc_name.is_string()) {
+            state.documents.erase(doc_name.as_string());
+        }
+        return finish(true);
+    }
+    if (!cmd.is_null() && !(cmd.is_string() && cmd.as_string() == "compile")) {
+        diagnostics.emplace_back("unknown cmd");
+        return finish(false);
+    }
+
+    const auto& source = request["source"];
+    const auto& edit = request["edit"];
+    if (!source.is_string() && !doc_name.is_string()) {
+        diagnostics.emplace_back("missing source");
+        return finish(false);
+    }
+    const auto level = request["opt"].is_null() ? std::optional<std::size_t>(0) : as_count(request["opt"]);
+    if (!level || *level > 3) {
+        diagnostics.emplace_back("invalid opt level");
+        return finish(false);
+    }
+    const auto emit = request["emit"].is_string() ? request["emit"].as_string() : "ir";
+    if (emit != "ir" && emit != "asm") {
+        diagnostics.emplace_back("unknown emit kind: " + emit);
+        return finish(false);
+    }
+
+    std::stringstream il;
+    std::vector<std::string> errors;
+    bool ok;
+    if (doc_name.is_string()) {
+        if (!source.is_string() && !state.documents.contains(doc_name.as_string())) {
+            diagnostics.emplace_back("unknown document: " + doc_name.as_string());
+            return finish(false);
+        }
+        auto& doc = state.documents[doc_name.as_string()];
+        try {
+            if (source.is_string()) {
+                open_document(doc, source.as_string(), lex_);
+            } else if (edit.is_object()) {
+                const auto& offset = edit["offset"];
+                const auto& length = edit["length"];
+                const auto& text = edit["text"];
+                const auto first = as_count(offset);
+                const auto len = length.is_null() ? std::optional<std::size_t>(0) : as_count(length);
+                if (!first || !len || !text.is_string()) {
+                    diagnostics.emplace_back("invalid edit");
+                    return finish(false);
+                }
+                edit_document(doc, *first, *len, text.as_string(), lex_);
+            }
+        } catch (const std::exception& e) {
+            diagnostics.emplace_back(e.what());
+            return finish(false);
+        }
+        ok = compile_frontend(doc, parser, il, errors);
+        response["relexed"] = static_cast<double>(doc.relexed);
+        response["reparsed"] = static_cast<double>(doc.log.driven);
+    } else {
+        ok = compile_frontend(source.as_string(), lex_, parser, il, errors);
+    }
+    if (!ok) {
+        for (auto& err : errors) {
+            diagnostics.emplace_back(std::move(err));
+        }
+        return finish(false);
+    }
+
+    std::stringstream out;
+    try {
+        auto mod = ir::parse(il);
+        ir::passes::optimize(mod, static_cast<int>(*level));
+        if (emit == "asm") {
+            ir::x86::emit(out, mod);
+        } else {
+            ir::print(out, mod);
+        }
+    } catch (const std::exception& e) {
+        diagnostics.emplace_back(std::string("internal error: ") + e.what());
+        return finish(false);
+    }
+    response["output"] = out.str();
+    return finish(true);
+}
+
+int serve(std::istream& is, std::ostream& os, const lexer::lexer& lex_, const parser_t& parser) {
+    session state;
+    bool shutdown = false;
+    std::string line;
+    while (!shutdown && std::getline(is, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        os << handle(line, lex_, parser, state, shutdown) << std::endl;
+    }
+    return 0;
+}
+
+namespace {
+
+bool send_all(const int fd, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        const auto n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+// 一个客户端连接；fd 在连接线程关闭后置为 -1，与主线程的 shutdown 由 mutex 互斥，避免作用到被复用的 fd
+struct connection {
+    int fd;
+    std::atomic<bool> done{false};
+    std::jthread thread;
+
+    explicit connection(const int fd) : fd(fd) {}
+};
+
+void serve_connection(connection& conn, std::mutex& mutex, const int listen_fd, std::atomic<bool>& stopping,
+                      const lexer::lexer& lex_, const parser_t& parser) {
+    const int fd = conn.fd;
+    session state;
+    std::string buffer;
+    char chunk[4096];
+    bool shutdown = false;
+    bool alive = true;
+    while (alive && !shutdown) {
+        const auto n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        buffer.append(chunk, n);
+        std::size_t newline;
+        while (alive && !shutdown && (newline = buffer.find('\n')) != std::string::npos) {
+            const auto line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty()) {
+                alive = send_all(fd, handle(line, lex_, parser, state, shutdown) + "\n");
+            }
+        }
+    }
+    {
+        const std::lock_guard lock(mutex);
+        ::close(fd);
+        conn.fd = -1;
+    }
+    if (shutdown) {
+        // 唤醒阻塞在 accept 上的主线程
+        stopping = true;
+        ::shutdown(listen_fd, SHUT_RDWR);
+    }
+    conn.done = true;
+}
+
+} // namespace
+
+int serve_unix(const std::string& path, const lexer::lexer& lex_, const parser_t& parser) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "socket path too long: " << path << std::endl;
+        return 1;
+    }
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, path.size());
+
+    const int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        std::perror("socket");
+        return 1;
+    }
+    ::unlink(path.c_str());
+    if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listen_fd, 16) < 0) {
+        std::perror("bind");
+        ::close(listen_fd);
+        return 1;
+    }
+
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;
+    // 连接线程引用 stopping、lex_ 和 parser，必须在返回前全部结束；list 保证元素地址不变
+    std::list<connection> connections;
+    while (!stopping) {
+        const int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (stopping || errno != EINTR) {
+                break;
+            }
+            continue;
+        }
+        // 回收已结束的连接
+        std::erase_if(connections, [](const connection& conn) { return conn.done.load(); });
+        auto& conn = connections.emplace_back(fd);
+        conn.thread = std::jthread(serve_connection, std::ref(conn), std::ref(mutex), listen_fd, std::ref(stopping),
+                                   std::cref(lex_), std::cref(parser));
+    }
+
+    // 关闭仍在等待请求的连接，使其 recv 返回，再等待所有连接线程结束
+    {
+        const std::lock_guard lock(mutex);
+        for (const auto& conn : connections) {
+            if (conn.fd >= 0) {
+                ::shutdown(conn.fd, SHUT_RDWR);
+            }
+        }
+    }
+    connections.clear();
+
+    ::close(listen_fd);
+    ::unlink(path.c_str());
+    return 0;
+}
+
+} // namespace server
@@ -0,0 +1,144 @@
+#include "time_report.hpp"
+#include "json.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+#include <sys/resource.h>
+
+namespace {
+
+double thread_cpu_ms() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) * 1e3 + static_cast<double>(ts.tv_nsec) / 1e6;
+}
+
+long peak_rss_kb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+} // namespace
+
+namespace time_report {
+
+namespace detail {
+thread_local std::size_t allocated_count = 0;
+thread_local std::size_t allocated_bytes = 0;
+} // namespace detail
+
+std::size_t thread_allocs() {
+    return detail::allocated_count;
+}
+
+std::size_t thread_alloc_bytes() {
+    return detail::allocated_bytes;
+}
+
+void report::add(const phase& p) {
+    const auto found = std::ranges::find(phases, p.name, &phase::name);
+    if (found == phases.end()) {
+        phases.push_back(p);
+        return;
+    }
+    found->wall_ms += p.wall_ms;
+    found->cpu_ms += p.cpu_ms;
+    found->allocs += p.allocs;
+    found->alloc_bytes += p.alloc_bytes;
+    found->peak_rss_kb = std::max(found->peak_rss_kb, p.peak_rss_kb);
+}
+
+void report::count(const std::string& name, const std::size_t n) {
+    const auto found = std::ranges::find(counts, name, &std::pair<std::string, std::size_t>::first);
+    if (found == counts.end()) {
+        counts.emplace_back(name, n);
+    } else {
+        found->second += n;
+    }
+}
+
+void report::merge(const report& other) {
+    for (const auto& p : other.phases) {
+        add(p);
+    }
+    for (const auto& [name, n] : other.counts) {
+        count(name, n);
+    }
+}
+
+void report::print(std::ostream& os) const {
+    phase total{"total"};
+    for (const auto& p : phases) {
+        total.wall_ms += p.wall_ms;
+        total.cpu_ms += p.cpu_ms;
+        total.allocs += p.allocs;
+        total.alloc_bytes += p.alloc_bytes;
+        total.peak_rss_kb = std::max(total.peak_rss_kb, p.peak_rss_kb);
+    }
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-16s %12s %12s %12s %14s %14s\n", "phase", "wall (ms)", "cpu (ms)", "allocs",
+                  "alloc (KB)", "peak RSS (KB)");
+    os << "Time report:\n" << line;
+    auto row = [&](const phase& p) {
+        std::snprintf(line, sizeof(line), "%-16s %12.3f %12.3f %12zu %14.1f %14ld\n", p.name.c_str(), p.wall_ms, p.cpu_ms,
+                      p.allocs, static_cast<double>(p.alloc_bytes) / 1024, p.peak_rss_kb);
+        os << line;
+    };
+    for (const auto& p : phases) {
+        row(p);
+    }
+    row(total);
+
+    if (!counts.empty()) {
+        os << "Counts:\n";
+        for (const auto& [name, n] : counts) {
+            std::snprintf(line, sizeof(line), "%-16s %12zu\n", name.c_str(), n);
+            os << line;
+        }
+    }
+    os.flush();
+}
+
+void report::print_json(std::ostream& os) const {
+    json::array phase_list;
+    for (const auto& p : phases) {
+        phase_list.emplace_back(json::object{
+            {"name", p.name},
+            {"wall_ms", p.wall_ms},
+            {"cpu_ms", p.cpu_ms},
+            {"allocs", static_cast<double>(p.allocs)},
+            {"alloc_bytes", static_cast<double>(p.alloc_bytes)},
+            {"peak_rss_kb", static_cast<double>(p.peak_rss_kb)},
+        });
+    }
+    json::object count_map;
+    for (const auto& [name, n] : counts) {
+        count_map[name] = static_cast<double>(n);
+    }
+    os << json::dump(json::object{{"phases", std::move(phase_list)}, {"counts", std::move(count_map)}}) << std::endl;
+}
+
+scope::scope(report* r, const char* name) : r(r), name(name), span(name) {
+    if (!r) {
+        return;
+    }
+    wall = std::chrono::steady_clock::now();
+    cpu = thread_cpu_ms();
+    allocs = thread_allocs();
+    alloc_bytes = thread_alloc_bytes();
+}
+
+scope::~scope() {
+    if (!r) {
+        return;
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - wall;
+    r->add({name, elapsed.count(), thread_cpu_ms() - cpu, thread_allocs() - allocs, thread_alloc_bytes() - alloc_bytes,
+            peak_rss_kb()});
+}
+
+} // namespace time_report
@@ -0,0 +1,461 @@
+#include "vm.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <ranges>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+
+namespace ir::vm {
+
+namespace {
+
+class compiler {
+public:
+    explicit compiler(const module& mod) : mod(mod) {}
+
+    program compile() {
+        for (std::size_t i = 0; i < mod.globals.size(); ++i) {
+            prog.strings.push_back(mod.globals[i].data);
+            const auto r = new_register();
+            globals[mod.globals[i].name] = r;
+            prog.string_slots.emplace_back(r, i);
+        }
+        const auto main = std::ranges::find(mod.functions, std::string{"main"}, &function::name);
+        if (main == mod.functions.end()) {
+            throw parse_error("no main function");
+        }
+        compile_function(*main);
+        return std::move(prog);
+    }
+
+private:
+    const module& mod;
+    program prog;
+    std::unordered_map<std::string, std::uint32_t> globals;
+    std::unordered_map<std::string, std::uint32_t> values;
+    std::unordered_map<std::int64_t, std::uint32_t> int_consts;
+    std::unordered_map<std::uint64_t, std::uint32_t> float_consts;
+    std::unordered_map<std::string, std::uint32_t> block_pc;
+    // 当前函数的块名 -> 下标，每个函数只构建一次
+    std::unordered_map<std::string, std::size_t> block_index;
+    // (指令下标, 是否为 b 字段, 目标块)
+    std::vector<std::tuple<std::size_t, bool, std::string>> fixups;
+    const function* func = nullptr;
+
+    std::uint32_t new_register() {
+        prog.registers.push_back({.i = 0});
+        return static_cast<std::uint32_t>(prog.registers.size() - 1);
+    }
+
+    std::uint32_t int_const(const std::int64_t v) {
+        if (const auto found = int_consts.find(v); found != int_consts.end()) {
+            return found->second;
+        }
+        const auto r = new_register();
+        prog.registers[r].i = v;
+        return int_consts[v] = r;
+    }
+
+    std::uint32_t float_const(const double v) {
+        const auto bits = std::bit_cast<std::uint64_t>(v);
+        if (const auto found = float_consts.find(bits); found != float_consts.end()) {
+            return found->second;
+        }
+        const auto r = new_register();
+        prog.registers[r].f = v;
+        return float_consts[bits] = r;
+    }
+
+    std::uint32_t result(const std::string& name) {
+        if (const auto found = values.find(name); found != values.end()) {
+            return found->second;
+        }
+        return values[name] = new_register();
+    }
+
+    // i32 值在寄存器中总是保持符号扩展后的形式
+    std::uint32_t operand(const value& v, const type& ty) {
+        switch (v.k) {
+        case value::kind::reg: return result(v.name);
+        case value::kind::global: return globals.at(v.name);
+        case value::kind::imm:
+            if (ty.is_float()) {
+                return float_const(static_cast<double>(v.imm));
+            }
+            if (ty.base == type::kind::i32 && !ty.is_ptr) {
+                return int_const(static_cast<std::int32_t>(v.imm));
+            }
+            return int_const(v.imm);
+        case value::kind::fimm: return float_const(v.fimm);
+        case value::kind::undef: return ty.is_float() ? float_const(0.0) : int_const(0);
+        }
+        return int_const(0);
+    }
+
+    void emit(const op code, const std::uint32_t dst = 0, const std::uint32_t a = 0, const std::uint32_t b = 0) {
+        prog.code.push_back({code, dst, a, b});
+    }
+
+    void jump_to(const std::string& label, const bool in_b) {
+        fixups.emplace_back(prog.code.size() - 1, in_b, label);
+    }
+
+    [[nodiscard]] bool has_phis(const std::string& label) const {
+        const auto& b = func->blocks[block_index.at(label)];
+        return !b.insts.empty() && b.insts.front().op == opcode::phi;
+    }
+
+    // 沿 from -> to 的边执行 phi 的并行复制
+    void emit_phi_copies(const std::string& from, const std::string& to) {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> copies;
+        for (const auto& inst : func->blocks[block_index.at(to)].insts) {
+            if (inst.op != opcode::phi) {
+                break;
+            }
+            for (std::size_t k = 0; k < inst.operands.size(); ++k) {
+                if (inst.labels[k] == from) {
+                    copies.emplace_back(result(inst.result), operand(inst.operands[k], inst.ty));
+                }
+            }
+        }
+        bool conflict = false;
+        for (const auto& dst : copies | std::views::keys) {
+            for (const auto& src : copies | std::views::values) {
+                conflict = conflict || dst == src;
+            }
+        }
+        if (!conflict) {
+            for (const auto& [dst, src] : copies) {
+                emit(op::mov, dst, src);
+            }
+            return;
+        }
+        std::vector<std::uint32_t> temps;
+        for (const auto& src : copies | std::views::values) {
+            temps.push_back(new_register());
+            emit(op::mov, temps.back(), src);
+        }
+        for (std::size_t k = 0; k < copies.size(); ++k) {
+            emit(op::mov, copies[k].first, temps[k]);
+        }
+    }
+
+    void compile_function(const function& f) {
+        func = &f;
+        block_index = f.block_index();
+        std::vector<std::tuple<std::string, std::string, std::size_t, bool>> trampolines;
+
+        for (const auto& b : f.blocks) {
+            for (const auto& inst : b.insts) {
+                if (inst.op == opcode::alloca_) {
+                    const auto count = inst.array_size == 0 ? 1 : inst.array_size;
+                    prog.frame_slots.emplace_back(result(inst.result), prog.frame_size);
+                    prog.frame_size += (inst.ty.size() * count + 7) / 8;
+                }
+            }
+        }
+
+        for (const auto& b : f.blocks) {
+            block_pc[b.label] = static_cast<std::uint32_t>(prog.code.size());
+            for (const auto& inst : b.insts) {
+                compile_instruction(inst, b.label, trampolines);
+            }
+        }
+
+        // 条件跳转到含 phi 的块时，先跳到边上的复制代码
+        for (const auto& [from, to, index, in_b] : trampolines) {
+            auto& target = in_b ? prog.code[index].b : prog.code[index].dst;
+            target = static_cast<std::uint32_t>(prog.code.size());
+            emit_phi_copies(from, to);
+            emit(op::jmp, 0);
+            jump_to(to, false);
+        }
+
+        for (const auto& [index, in_b, label] : fixups) {
+            (in_b ? prog.code[index].b : prog.code[index].dst) = block_pc.at(label);
+        }
+    }
+
+    void compile_instruction(const instruction& inst, const std::string& block,
+                             std::vector<std::tuple<std::string, std::string, std::size_t, bool>>& trampolines) {
+        const auto& ops = inst.operands;
+        const bool wide = inst.ty.is_ptr || inst.ty.base == type::kind::i64;
+        switch (inst.op) {
+        case opcode::alloca_:
+        case opcode::phi: return;
+        case opcode::add: emit(wide ? op::add_i64 : op::add_i32, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::sub: emit(wide ? op::sub_i64 : op::sub_i32, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::mul: emit(wide ? op::mul_i64 : op::mul_i32, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::sdiv: emit(wide ? op::sdiv_i64 : op::sdiv_i32, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::and_: emit(op::and_, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::or_: emit(op::or_, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::xor_: emit(op::xor_, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::fadd: emit(op::fadd, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::fsub: emit(op::fsub, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::fmul: emit(op::fmul, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::fdiv: emit(op::fdiv, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty)); return;
+        case opcode::icmp:
+        case opcode::fcmp: {
+            static const std::unordered_map<std::string, op> preds = {
+                {"eq", op::icmp_eq}, {"ne", op::icmp_ne}, {"slt", op::icmp_slt}, {"sle", op::icmp_sle},
+                {"sgt", op::icmp_sgt}, {"sge", op::icmp_sge}, {"oeq", op::fcmp_oeq}, {"one", op::fcmp_one},
+                {"olt", op::fcmp_olt}, {"ole", op::fcmp_ole}, {"ogt", op::fcmp_ogt}, {"oge", op::fcmp_oge}};
+            const auto found = preds.find(inst.pred);
+            if (found == preds.end()) {
+                throw parse_error("unsupported predicate " + inst.pred);
+            }
+            emit(found->second, result(inst.result), operand(ops[0], inst.ty), operand(ops[1], inst.ty));
+            return;
+        }
+        case opcode::zext:
+            emit(inst.ty.base == type::kind::i1 ? op::zext_i1 : op::zext_i32, result(inst.result), operand(ops[0], inst.ty));
+            return;
+        case opcode::sext:
+            emit(inst.ty.base == type::kind::i1 ? op::sext_i1 : op::mov, result(inst.result), operand(ops[0], inst.ty));
+            return;
+        case opcode::trunc:
+            emit(inst.to.base == type::kind::i1 ? op::trunc_i1 : op::trunc_i32, result(inst.result), operand(ops[0], inst.ty));
+            return;
+        case opcode::sitofp: emit(op::sitofp, result(inst.result), operand(ops[0], inst.ty)); return;
+        case opcode::fptosi:
+            emit(inst.to.base == type::kind::i64 ? op::fptosi_i64 : op::fptosi_i32, result(inst.result), operand(ops[0], inst.ty));
+            return;
+        case opcode::ptrtoint:
+        case opcode::inttoptr:
+        case opcode::gep: emit(op::mov, result(inst.result), operand(ops[0], inst.ty)); return;
+        case opcode::load: {
+            const auto code = inst.ty.is_float() ? op::load_f64 : inst.ty.base == type::kind::i64 || inst.ty.is_ptr ? op::load_i64 : op::load_i32;
+            emit(code, result(inst.result), operand(ops[0], inst.to));
+            return;
+        }
+        case opcode::store: {
+            const auto code = inst.ty.is_float() ? op::store_f64 : wide ? op::store_i64 : op::store_i32;
+            emit(code, 0, operand(ops[0], inst.ty), operand(ops[1], inst.to));
+            return;
+        }
+        case opcode::call: {
+            call_info info{inst.callee, {}, inst.arg_types};
+            for (std::size_t i = 0; i < ops.size(); ++i) {
+                info.args.push_back(operand(ops[i], inst.arg_types[i]));
+            }
+            prog.calls.push_back(std::move(info));
+            const auto dst = inst.has_result() ? result(inst.result) : new_register();
+            emit(op::call, dst, static_cast<std::uint32_t>(prog.calls.size() - 1));
+            return;
+        }
+        case opcode::br:
+            emit_phi_copies(block, inst.labels[0]);
+            emit(op::jmp, 0);
+            jump_to(inst.labels[0], false);
+            return;
+        case opcode::cond_br: {
+            emit(op::br, 0, operand(ops[0], {type::kind::i1}), 0);
+            const auto index = prog.code.size() - 1;
+            for (int k = 0; k < 2; ++k) {
+                if (has_phis(inst.labels[k])) {
+                    trampolines.emplace_back(block, inst.labels[k], index, k == 1);
+                } else {
+                    jump_to(inst.labels[k], k == 1);
+                }
+            }
+            return;
+        }
+        case opcode::ret:
+            emit(op::ret, 0, ops.empty() ? int_const(0) : operand(ops[0], inst.ty));
+            return;
+        }
+    }
+};
+
+std::int64_t wrap32(const std::int64_t v) {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(v));
+}
+
+template <typename T>
+std::int64_t fp_to_int(const double v) {
+    // 与 cvttsd2si 一致：越界或 NaN 时得到最小值
+    if (std::isnan(v) || v < static_cast<double>(std::numeric_limits<T>::min())
+        || v >= -static_cast<double>(std::numeric_limits<T>::min())) {
+        return std::numeric_limits<T>::min();
+    }
+    return static_cast<T>(v);
+}
+
+// 把格式串按转换说明拆开，每段最多包含一个转换，逐段交给 libc
+std::vector<std::string> split_format(const std::string& fmt) {
+    std::vector<std::string> pieces;
+    std::string cur;
+    for (std::size_t i = 0; i < fmt.size(); ++i) {
+        cur += fmt[i];
+        if (fmt[i] != '%') {
+            continue;
+        }
+        if (i + 1 < fmt.size() && fmt[i + 1] == '%') {
+            cur += fmt[++i];
+            continue;
+        }
+        while (++i < fmt.size()) {
+            cur += fmt[i];
+            if (std::isalpha(static_cast<unsigned char>(fmt[i])) && std::string_view("hlLqjzt").find(fmt[i]) == std::string_view::npos) {
+                break;
+            }
+        }
+        pieces.push_back(std::move(cur));
+        cur.clear();
+    }
+    if (!cur.empty()) {
+        pieces.push_back(std::move(cur));
+    }
+    return pieces;
+}
+
+bool has_conversion(const std::string& piece) {
+    for (std::size_t i = 0; i < piece.size(); ++i) {
+        if (piece[i] == '%') {
+            if (i + 1 < piece.size() && piece[i + 1] == '%') {
+                ++i;
+            } else {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::int64_t call_libc(const call_info& info, const std::vector<reg>& regs) {
+    const auto* fmt = reinterpret_cast<const char*>(regs[info.args[0]].i);
+    const auto pieces = split_format(fmt);
+    const bool is_printf = info.callee == "printf";
+    if (!is_printf && info.callee != "scanf") {
+        throw parse_error("unsupported function " + info.callee);
+    }
+
+    std::int64_t total = 0;
+    std::size_t next = 1;
+    for (const auto& piece : pieces) {
+        const char* p = piece.c_str();
+        if (!has_conversion(piece) || next >= info.args.size()) {
+            if (is_printf) {
+                std::string text;
+                for (std::size_t i = 0; i < piece.size(); ++i) {
+                    text += piece[i];
+                    if (piece[i] == '%' && i + 1 < piece.size() && piece[i + 1] == '%') {
+                        ++i;
+                    }
+                }
+                std::fputs(text.c_str(), stdout);
+                total += static_cast<std::int64_t>(text.size());
+            } else if (std::scanf(p) == EOF && total == 0) {
+                return EOF;
+            }
+            continue;
+        }
+        const auto& arg = regs[info.args[next]];
+        const auto& ty = info.types[next++];
+        int res;
+        if (is_printf) {
+            if (ty.is_float()) {
+                res = std::printf(p, arg.f);
+            } else if (ty.is_ptr) {
+                res = std::printf(p, reinterpret_cast<void*>(arg.i));
+            } else if (ty.base == type::kind::i64) {
+                res = std::printf(p, static_cast<long>(arg.i));
+            } else {
+                res = std::printf(p, static_cast<int>(arg.i));
+            }
+            total += res;
+        } else {
+            res = std::scanf(p, reinterpret_cast<void*>(arg.i));
+            if (res == EOF) {
+                return total == 0 ? EOF : total;
+            }
+            total += res;
+            if (res == 0) {
+                break;
+            }
+        }
+    }
+    return total;
+}
+
+} // namespace
+
+program compile(const module& mod) {
+    return compiler(mod).compile();
+}
+
+int run(const program& prog) {
+    auto regs = prog.registers;
+    std::vector<std::uint64_t> frame(prog.frame_size);
+    for (const auto& [r, offset] : prog.frame_slots) {
+        regs[r].i = reinterpret_cast<std::int64_t>(frame.data() + offset);
+    }
+    for (const auto& [r, index] : prog.string_slots) {
+        regs[r].i = reinterpret_cast<std::int64_t>(prog.strings[index].c_str());
+    }
+
+    const auto* code = prog.code.data();
+    std::size_t pc = 0;
+    while (true) {
+        const auto& in = code[pc++];
+        auto& d = regs[in.dst];
+        const auto& a = regs[in.a];
+        const auto& b = regs[in.b];
+        switch (in.code) {
+        case op::mov: d = a; break;
+        case op::add_i32: d.i = wrap32(a.i + b.i); break;
+        case op::sub_i32: d.i = wrap32(a.i - b.i); break;
+        case op::mul_i32: d.i = wrap32(static_cast<std::int64_t>(static_cast<std::uint64_t>(a.i) * static_cast<std::uint64_t>(b.i))); break;
+        case op::sdiv_i32: d.i = wrap32(a.i / b.i); break;
+        case op::add_i64: d.i = static_cast<std::int64_t>(static_cast<std::uint64_t>(a.i) + static_cast<std::uint64_t>(b.i)); break;
+        case op::sub_i64: d.i = static_cast<std::int64_t>(static_cast<std::uint64_t>(a.i) - static_cast<std::uint64_t>(b.i)); break;
+        case op::mul_i64: d.i = static_cast<std::int64_t>(static_cast<std::uint64_t>(a.i) * static_cast<std::uint64_t>(b.i)); break;
+        case op::sdiv_i64: d.i = a.i / b.i; break;
+        case op::and_: d.i = a.i & b.i; break;
+        case op::or_: d.i = a.i | b.i; break;
+        case op::xor_: d.i = a.i ^ b.i; break;
+        case op::fadd: d.f = a.f + b.f; break;
+        case op::fsub: d.f = a.f - b.f; break;
+        case op::fmul: d.f = a.f * b.f; break;
+        case op::fdiv: d.f = a.f / b.f; break;
+        case op::icmp_eq: d.i = a.i == b.i; break;
+        case op::icmp_ne: d.i = a.i != b.i; break;
+        case op::icmp_slt: d.i = a.i < b.i; break;
+        case op::icmp_sle: d.i = a.i <= b.i; break;
+        case op::icmp_sgt: d.i = a.i > b.i; break;
+        case op::icmp_sge: d.i = a.i >= b.i; break;
+        case op::fcmp_oeq: d.i = a.f == b.f; break;
+        case op::fcmp_one: d.i = a.f < b.f || a.f > b.f; break;
+        case op::fcmp_olt: d.i = a.f < b.f; break;
+        case op::fcmp_ole: d.i = a.f <= b.f; break;
+        case op::fcmp_ogt: d.i = a.f > b.f; break;
+        case op::fcmp_oge: d.i = a.f >= b.f; break;
+        case op::zext_i1: d.i = a.i & 1; break;
+        case op::zext_i32: d.i = a.i & 0xFFFFFFFF; break;
+        case op::sext_i1: d.i = -(a.i & 1); break;
+        case op::trunc_i1: d.i = a.i & 1; break;
+        case op::trunc_i32: d.i = wrap32(a.i); break;
+        case op::sitofp: d.f = static_cast<double>(a.i); break;
+        case op::fptosi_i32: d.i = fp_to_int<std::int32_t>(a.f); break;
+        case op::fptosi_i64: d.i = fp_to_int<std::int64_t>(a.f); break;
+        case op::load_i32: d.i = *reinterpret_cast<const std::int32_t*>(a.i); break;
+        case op::load_i64: d.i = *reinterpret_cast<const std::int64_t*>(a.i); break;
+        case op::load_f64: d.f = *reinterpret_cast<const double*>(a.i); break;
+        case op::store_i32: *reinterpret_cast<std::int32_t*>(b.i) = static_cast<std::int32_t>(a.i); break;
+        case op::store_i64: *reinterpret_cast<std::int64_t*>(b.i) = a.i; break;
+        case op::store_f64: *reinterpret_cast<double*>(b.i) = a.f; break;
+        case op::call: d.i = call_libc(prog.calls[in.a], regs); break;
+        case op::jmp: pc = in.dst; break;
+        case op::br: pc = a.i & 1 ? in.dst : in.b; break;
+        case op::ret: std::fflush(stdout); return static_cast<int>(a.i);
+        }
+    }
+}
+
+} // namespace ir::vm
@@ -0,0 +1,945 @@
+#include "x86.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <ranges>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ir::x86 {
+
+namespace {
+
+enum gpr {
+    RAX,
+    RCX,
+    RDX,
+    RBX,
+    RSI,
+    RDI,
+    R8,
+    R9,
+    R10,
+    R11,
+    R12,
+    R13,
+    R14,
+    R15
+};
+
+const char* const gpr64[] = {"%rax", "%rcx", "%rdx", "%rbx", "%rsi", "%rdi", "%r8",
+                             "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15"};
+const char* const gpr32[] = {"%eax", "%ecx", "%edx", "%ebx", "%esi", "%edi", "%r8d",
+                             "%r9d", "%r10d", "%r11d", "%r12d", "%r13d", "%r14d", "%r15d"};
+
+// 分配给整数虚拟寄存器的都是被调用者保存的寄存器，跨 printf/scanf 调用无需保存
+const std::vector<int> int_pool = {RBX, R12, R13, R14, R15};
+// xmm8-xmm15 是调用者保存的，跨调用时需要在栈上暂存
+const std::vector<int> float_pool = {8, 9, 10, 11, 12, 13, 14, 15};
+const int int_args[] = {RDI, RSI, RDX, RCX, R8, R9};
+
+std::string xmm(const int n) {
+    return "%xmm" + std::to_string(n);
+}
+
+bool is_wide(const type& ty) {
+    return ty.is_ptr || ty.base == type::kind::i64;
+}
+
+bool fits_imm32(const std::int64_t v) {
+    return v >= std::numeric_limits<std::int32_t>::min() && v <= std::numeric_limits<std::int32_t>::max();
+}
+
+std::uint64_t double_bits(const value& v) {
+    if (v.k == value::kind::fimm) {
+        return std::bit_cast<std::uint64_t>(v.fimm);
+    }
+    if (v.k == value::kind::imm) {
+        return std::bit_cast<std::uint64_t>(static_cast<double>(v.imm));
+    }
+    return 0;
+}
+
+std::string escape(const std::string& data) {
+    std::string res;
+    for (const char c : data) {
+        const auto u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            res += '\\';
+            res += c;
+        } else if (u < 32 || u > 126) {
+            char buf[5];
+            std::snprintf(buf, sizeof(buf), "\\%03o", u);
+            res += buf;
+        } else {
+            res += c;
+        }
+    }
+    return res;
+}
+
+struct location {
+    enum class kind {
+        none,
+        reg,
+        stack
+    };
+
+    kind k = kind::none;
+    int reg = -1;
+    int offset = 0;
+
+    bool operator==(const location& other) const = default;
+};
+
+struct interval {
+    std::string name;
+    int start = std::numeric_limits<int>::max();
+    int end = std::numeric_limits<int>::min();
+    bool is_float = false;
+};
+
+class function_emitter {
+public:
+    function_emitter(std::ostream& os, const function& func) : os(os), func(func) {}
+
+    void run() {
+        collect();
+        compute_liveness();
+        build_intervals();
+        allocate(false);
+        allocate(true);
+        layout_frame();
+        emit_function();
+    }
+
+private:
+    std::ostream& os;
+    const function& func;
+
+    std::unordered_map<std::string, type> types;
+    std::unordered_map<std::string, int> frame_slots;
+    std::unordered_map<std::string, std::size_t> index;
+    std::vector<std::vector<std::size_t>> succs;
+    std::vector<std::unordered_set<std::string>> live_in;
+    std::vector<std::unordered_set<std::string>> live_out;
+    std::vector<int> block_start;
+    std::vector<int> block_end;
+    std::vector<int> call_positions;
+    std::map<std::string, interval> intervals;
+    std::unordered_map<std::string, location> locations;
+    std::set<int> used_callee_saved;
+    std::set<int> used_xmm;
+    std::unordered_map<int, int> xmm_save_slots;
+    int slot_count = 0;
+    int saved_count = 0;
+    int phi_temp_base = 0;
+    std::size_t max_copies = 0;
+    int edge_counter = 0;
+
+    int new_slot(const int size = 8) {
+        const int n = (size + 7) / 8;
+        slot_count += n;
+        return slot_count;
+    }
+
+    [[nodiscard]] bool is_vreg(const value& v) const {
+        return v.is_reg() && !frame_slots.contains(v.name);
+    }
+
+    void collect() {
+        index = func.block_index();
+        succs.resize(func.blocks.size());
+        for (std::size_t i = 0; i < func.blocks.size(); ++i) {
+            for (const auto& s : func.blocks[i].successors()) {
+                succs[i].push_back(index.at(s));
+            }
+            for (const auto& inst : func.blocks[i].insts) {
+                if (inst.op == opcode::alloca_) {
+                    frame_slots[inst.result] = 0;
+                } else if (inst.has_result()) {
+                    types[inst.result] = inst.result_type();
+                }
+            }
+        }
+    }
+
+    void compute_liveness() {
+        const auto n = func.blocks.size();
+        std::vector<std::unordered_set<std::string>> uses(n), defs(n), phi_uses(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (const auto& inst : func.blocks[i].insts) {
+                if (inst.op == opcode::phi) {
+                    for (std::size_t k = 0; k < inst.operands.size(); ++k) {
+                        if (is_vreg(inst.operands[k]) && index.contains(inst.labels[k])) {
+                            phi_uses[index.at(inst.labels[k])].insert(inst.operands[k].name);
+                        }
+                    }
+                } else {
+                    for (const auto& op : inst.operands) {
+                        if (is_vreg(op) && !defs[i].contains(op.name)) {
+                            uses[i].insert(op.name);
+                        }
+                    }
+                }
+                if (inst.has_result()) {
+                    defs[i].insert(inst.result);
+                }
+            }
+        }
+
+        // 迭代求解时只把新增的变量并入集合；in 增大时才把前驱重新加入工作表
+        std::vector<std::vector<std::size_t>> preds(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (const auto s : succs[i]) {
+                preds[s].push_back(i);
+            }
+        }
+        live_in = std::move(uses);
+        live_out = std::move(phi_uses);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (const auto& v : live_out[i]) {
+                if (!defs[i].contains(v)) {
+                    live_in[i].insert(v);
+                }
+            }
+        }
+
+        // 活跃性是后向问题，按后序访问使后继先于前驱求解；不可达的块放在最后
+        std::vector<std::size_t> worklist;
+        std::vector<bool> queued(n, false);
+        std::vector<std::pair<std::size_t, std::size_t>> stack;
+        for (std::size_t root = 0; root < n; ++root) {
+            if (queued[root]) {
+                continue;
+            }
+            queued[root] = true;
+            stack.emplace_back(root, 0);
+            while (!stack.empty()) {
+                auto& [b, next] = stack.back();
+                if (next < succs[b].size()) {
+                    const auto s = succs[b][next++];
+                    if (!queued[s]) {
+                        queued[s] = true;
+                        stack.emplace_back(s, 0);
+                    }
+                    continue;
+                }
+                worklist.push_back(b);
+                stack.pop_back();
+            }
+        }
+        std::ranges::reverse(worklist);
+
+        while (!worklist.empty()) {
+            const auto b = worklist.back();
+            worklist.pop_back();
+            queued[b] = false;
+            bool grew = false;
+            for (const auto s : succs[b]) {
+                for (const auto& v : live_in[s]) {
+                    if (live_out[b].insert(v).second && !defs[b].contains(v)) {
+                        grew |= live_in[b].insert(v).second;
+                    }
+                }
+            }
+            if (!grew) {
+                continue;
+            }
+            for (const auto p : preds[b]) {
+                if (!queued[p]) {
+                    queued[p] = true;
+                    worklist.push_back(p);
+                }
+            }
+        }
+    }
+
+    void extend(const std::string& name, const int pos) {
+        auto& it = intervals[name];
+        it.name = name;
+        it.start = std::min(it.start, pos);
+        it.end = std::max(it.end, pos);
+        it.is_float = types.at(name).is_float();
+    }
+
+    void build_intervals() {
+        int pos = 0;
+        block_start.resize(func.blocks.size());
+        block_end.resize(func.blocks.size());
+        for (std::size_t i = 0; i < func.blocks.size(); ++i) {
+            block_start[i] = pos;
+            pos += static_cast<int>(func.blocks[i].insts.size());
+            // 块尾额外留出一个位置，用于放置 phi 的并行复制
+            block_end[i] = pos++;
+        }
+
+        for (std::size_t i = 0; i < func.blocks.size(); ++i) {
+            for (const auto& v : live_in[i]) {
+                extend(v, block_start[i]);
+            }
+            for (const auto& v : live_out[i]) {
+                extend(v, block_end[i]);
+            }
+            int p = block_start[i];
+            for (const auto& inst : func.blocks[i].insts) {
+                if (inst.op == opcode::phi) {
+                    extend(inst.result, block_start[i]);
+                    for (const auto& label : inst.labels) {
+                        if (index.contains(label)) {
+                            extend(inst.result, block_end[index.at(label)]);
+                        }
+                    }
+                } else {
+                    for (const auto& op : inst.operands) {
+                        if (is_vreg(op)) {
+                            extend(op.name, p);
+                        }
+                    }
+                    if (inst.has_result() && inst.op != opcode::alloca_) {
+                        extend(inst.result, p);
+                    }
+                }
+                if (inst.op == opcode::call) {
+                    call_positions.push_back(p);
+                }
+                p++;
+            }
+        }
+    }
+
+    void allocate(const bool is_float) {
+        std::vector<interval*> sorted;
+        for (auto& it : intervals | std::views::values) {
+            if (it.is_float == is_float) {
+                sorted.push_back(&it);
+            }
+        }
+        std::ranges::sort(sorted, [](const interval* a, const interval* b) {
+            return a->start < b->start || (a->start == b->start && a->name < b->name);
+        });
+
+        const auto& pool = is_float ? float_pool : int_pool;
+        std::vector<int> free(pool.rbegin(), pool.rend());
+        std::vector<interval*> active;
+
+        for (auto* cur : sorted) {
+            std::erase_if(active, [&](const interval* a) {
+                if (a->end < cur->start) {
+                    free.push_back(locations[a->name].reg);
+                    return true;
+                }
+                return false;
+            });
+
+            if (!free.empty()) {
+                locations[cur->name] = {location::kind::reg, free.back()};
+                free.pop_back();
+                active.push_back(cur);
+                continue;
+            }
+
+            // 没有空闲寄存器时，溢出结束位置最远的区间
+            const auto victim = std::ranges::max_element(active, {}, &interval::end);
+            if ((*victim)->end > cur->end) {
+                locations[cur->name] = locations[(*victim)->name];
+                locations[(*victim)->name] = {location::kind::stack, -1, new_slot()};
+                *victim = cur;
+            } else {
+                locations[cur->name] = {location::kind::stack, -1, new_slot()};
+            }
+        }
+
+        for (const auto& [name, loc] : locations) {
+            if (loc.k != location::kind::reg || intervals.at(name).is_float != is_float) {
+                continue;
+            }
+            if (is_float) {
+                used_xmm.insert(loc.reg);
+            } else {
+                used_callee_saved.insert(loc.reg);
+            }
+        }
+    }
+
+    void layout_frame() {
+        for (const auto& b : func.blocks) {
+            for (const auto& inst : b.insts) {
+                if (inst.op == opcode::alloca_) {
+                    const auto count = inst.array_size == 0 ? 1 : inst.array_size;
+                    frame_slots[inst.result] = new_slot(static_cast<int>(inst.ty.size() * count));
+                }
+            }
+            std::unordered_map<std::string, std::size_t> copies;
+            for (const auto& inst : b.insts) {
+                if (inst.op == opcode::phi) {
+                    for (const auto& label : inst.labels) {
+                        max_copies = std::max(max_copies, ++copies[label]);
+                    }
+                }
+            }
+        }
+        for (const auto r : used_xmm) {
+            xmm_save_slots[r] = new_slot();
+        }
+        phi_temp_base = slot_count;
+        slot_count += static_cast<int>(max_copies);
+        saved_count = static_cast<int>(used_callee_saved.size());
+    }
+
+    // 栈槽 n 位于被保存的寄存器之下
+    [[nodiscard]] std::string slot(const int n) const {
+        return std::to_string(-8 * (saved_count + n)) + "(%rbp)";
+    }
+
+    [[nodiscard]] std::string mem(const location& loc) const {
+        return slot(loc.offset);
+    }
+
+    void line(const std::string& text) const {
+        os << "\t" << text << "\n";
+    }
+
+    [[nodiscard]] std::string label_of(const std::string& label) const {
+        return ".L" + func.name + "_" + label;
+    }
+
+    // 返回可直接作为整数源操作数的字符串，必要时先载入 scratch
+    std::string int_src(const value& v, const type& ty, const int scratch) {
+        const bool wide = is_wide(ty);
+        if (v.k == value::kind::imm && fits_imm32(v.imm)) {
+            return "$" + std::to_string(v.imm);
+        }
+        if (v.k == value::kind::undef) {
+            return "$0";
+        }
+        if (is_vreg(v)) {
+            const auto& loc = locations.at(v.name);
+            if (loc.k == location::kind::reg) {
+                return wide ? gpr64[loc.reg] : gpr32[loc.reg];
+            }
+            return mem(loc);
+        }
+        load_int(v, scratch);
+        return wide ? gpr64[scratch] : gpr32[scratch];
+    }
+
+    // 按 64 位把整数值载入寄存器；i32/i1 的高位不保证为零
+    void load_int(const value& v, const int r) {
+        switch (v.k) {
+        case value::kind::undef: line("xorl " + std::string(gpr32[r]) + ", " + gpr32[r]); return;
+        case value::kind::imm:
+            if (v.imm == 0) {
+                line("xorl " + std::string(gpr32[r]) + ", " + gpr32[r]);
+            } else if (fits_imm32(v.imm)) {
+                line("movq $" + std::to_string(v.imm) + ", " + gpr64[r]);
+            } else {
+                line("movabsq $" + std::to_string(v.imm) + ", " + gpr64[r]);
+            }
+            return;
+        case value::kind::fimm: line("movabsq $" + std::to_string(static_cast<std::int64_t>(double_bits(v))) + ", " + gpr64[r]); return;
+        case value::kind::global: line("leaq .L" + v.name + "(%rip), " + gpr64[r]); return;
+        case value::kind::reg: break;
+        }
+        if (const auto frame = frame_slots.find(v.name); frame != frame_slots.end()) {
+            line("leaq " + slot(frame->second) + ", " + gpr64[r]);
+            return;
+        }
+        const auto& loc = locations.at(v.name);
+        if (loc.k == location::kind::reg) {
+            if (loc.reg != r) {
+                line("movq " + std::string(gpr64[loc.reg]) + ", " + gpr64[r]);
+            }
+        } else {
+            line("movq " + mem(loc) + ", " + gpr64[r]);
+        }
+    }
+
+    std::string float_src(const value& v, const int scratch) {
+        if (is_vreg(v)) {
+            const auto& loc = locations.at(v.name);
+            return loc.k == location::kind::reg ? xmm(loc.reg) : mem(loc);
+        }
+        load_float(v, scratch);
+        return xmm(scratch);
+    }
+
+    void load_float(const value& v, const int x) {
+        if (is_vreg(v)) {
+            const auto& loc = locations.at(v.name);
+            if (loc.k == location::kind::reg) {
+                if (loc.reg != x) {
+                    line("movapd " + xmm(loc.reg) + ", " + xmm(x));
+                }
+            } else {
+                line("movsd " + mem(loc) + ", " + xmm(x));
+            }
+            return;
+        }
+        const auto bits = double_bits(v);
+        if (bits == 0) {
+            line("xorpd " + xmm(x) + ", " + xmm(x));
+        } else {
+            line("movabsq $" + std::to_string(static_cast<std::int64_t>(bits)) + ", %r10");
+            line("movq %r10, " + xmm(x));
+        }
+    }
+
+    void store_int(const std::string& name, const int r) {
+        const auto& loc = locations.at(name);
+        if (loc.k == location::kind::reg) {
+            if (loc.reg != r) {
+                line("movq " + std::string(gpr64[r]) + ", " + gpr64[loc.reg]);
+            }
+        } else {
+            line("movq " + std::string(gpr64[r]) + ", " + mem(loc));
+        }
+    }
+
+    void store_float(const std::string& name, const int x) {
+        const auto& loc = locations.at(name);
+        if (loc.k == location::kind::reg) {
+            if (loc.reg != x) {
+                line("movapd " + xmm(x) + ", " + xmm(loc.reg));
+            }
+        } else {
+            line("movsd " + xmm(x) + ", " + mem(loc));
+        }
+    }
+
+    // 指针操作数：alloca 直接使用栈地址，其余指针先载入 r11
+    std::string address(const value& ptr) {
+        if (ptr.is_reg()) {
+            if (const auto frame = frame_slots.find(ptr.name); frame != frame_slots.end()) {
+                return slot(frame->second);
+            }
+        }
+        load_int(ptr, R11);
+        return "(%r11)";
+    }
+
+    void emit_function() {
+        os << "\t.globl " << func.name << "\n";
+        os << "\t.type " << func.name << ", @function\n";
+        os << func.name << ":\n";
+        line("pushq %rbp");
+        line("movq %rsp, %rbp");
+        for (const auto r : used_callee_saved) {
+            line("pushq " + std::string(gpr64[r]));
+        }
+        // 保证调用点处 rsp 按 16 字节对齐
+        const int used = 8 * (saved_count + slot_count);
+        const int frame = (used + 15) / 16 * 16 - 8 * saved_count;
+        if (frame > 0) {
+            line("subq $" + std::to_string(frame) + ", %rsp");
+        }
+
+        for (std::size_t i = 0; i < func.blocks.size(); ++i) {
+            const auto& b = func.blocks[i];
+            os << label_of(b.label) << ":\n";
+            int p = block_start[i];
+            for (const auto& inst : b.insts) {
+                emit_instruction(inst, i, p++);
+            }
+        }
+        os << "\t.size " << func.name << ", .-" << func.name << "\n";
+    }
+
+    [[nodiscard]] bool has_phis(const std::string& label) const {
+        const auto& b = func.blocks[index.at(label)];
+        return !b.insts.empty() && b.insts.front().op == opcode::phi;
+    }
+
+    [[nodiscard]] bool is_next(const std::size_t from, const std::string& label) const {
+        return index.at(label) == from + 1;
+    }
+
+    // 从 from 块跳到 to 块时执行 phi 的并行复制
+    void emit_phi_copies(const std::string& from, const std::string& to) {
+        struct copy {
+            std::string dest;
+            value src;
+            bool is_float;
+        };
+        std::vector<copy> copies;
+        for (const auto& inst : func.blocks[index.at(to)].insts) {
+            if (inst.op != opcode::phi) {
+                break;
+            }
+            for (std::size_t k = 0; k < inst.operands.size(); ++k) {
+                if (inst.labels[k] != from) {
+                    continue;
+                }
+                const auto& src = inst.operands[k];
+                if (is_vreg(src) && locations.at(src.name) == locations.at(inst.result)) {
+                    continue;
+                }
+                copies.push_back({inst.result, src, inst.ty.is_float()});
+            }
+        }
+
+        bool conflict = false;
+        for (const auto& a : copies) {
+            for (const auto& b : copies) {
+                if (&a != &b && is_vreg(b.src) && locations.at(b.src.name) == locations.at(a.dest)) {
+                    conflict = true;
+                }
+            }
+        }
+
+        if (!conflict) {
+            for (const auto& c : copies) {
+                move(c.src, c.dest, c.is_float);
+            }
+            return;
+        }
+        // 存在读写冲突时，先把所有源值写入临时栈槽
+        for (std::size_t k = 0; k < copies.size(); ++k) {
+            load_int_bits(copies[k].src, copies[k].is_float);
+            line("movq %rax, " + slot(phi_temp_base + static_cast<int>(k) + 1));
+        }
+        for (std::size_t k = 0; k < copies.size(); ++k) {
+            line("movq " + slot(phi_temp_base + static_cast<int>(k) + 1) + ", %rax");
+            store_bits(copies[k].dest, copies[k].is_float);
+        }
+    }
+
+    // 把任意值的 64 位表示载入 rax
+    void load_int_bits(const value& v, const bool is_float) {
+        if (!is_float) {
+            load_int(v, RAX);
+        } else if (is_vreg(v) && locations.at(v.name).k == location::kind::reg) {
+            line("movq " + xmm(locations.at(v.name).reg) + ", %rax");
+        } else if (is_vreg(v)) {
+            line("movq " + mem(locations.at(v.name)) + ", %rax");
+        } else {
+            line("movabsq $" + std::to_string(static_cast<std::int64_t>(double_bits(v))) + ", %rax");
+        }
+    }
+
+    void store_bits(const std::string& dest, const bool is_float) {
+        const auto& loc = locations.at(dest);
+        if (is_float && loc.k == location::kind::reg) {
+            line("movq %rax, " + xmm(loc.reg));
+        } else {
+            store_int(dest, RAX);
+        }
+    }
+
+    void move(const value& src, const std::string& dest, const bool is_float) {
+        const auto& loc = locations.at(dest);
+        if (is_float) {
+            if (loc.k == location::kind::reg) {
+                load_float(src, loc.reg);
+            } else {
+                load_int_bits(src, true);
+                store_int(dest, RAX);
+            }
+        } else if (loc.k == location::kind::reg) {
+            load_int(src, loc.reg);
+        } else {
+            load_int(src, RAX);
+            store_int(dest, RAX);
+        }
+    }
+
+    void emit_jump(const std::size_t from, const std::string& to) {
+        emit_phi_copies(func.blocks[from].label, to);
+        if (!is_next(from, to)) {
+            line("jmp " + label_of(to));
+        }
+    }
+
+    void emit_instruction(const instruction& inst, const std::size_t block, const int pos) {
+        const auto& ops = inst.operands;
+        switch (inst.op) {
+        case opcode::alloca_:
+        case opcode::phi: return;
+        case opcode::add:
+        case opcode::sub:
+        case opcode::mul:
+        case opcode::and_:
+        case opcode::or_:
+        case opcode::xor_: {
+            static const std::unordered_map<opcode, std::string> names = {
+                {opcode::add, "add"}, {opcode::sub, "sub"}, {opcode::mul, "imul"},
+                {opcode::and_, "and"}, {opcode::or_, "or"}, {opcode::xor_, "xor"}};
+            const bool wide = is_wide(inst.ty);
+            load_int(ops[0], RAX);
+            const auto rhs = int_src(ops[1], inst.ty, RCX);
+            line(names.at(inst.op) + (wide ? "q " : "l ") + rhs + ", " + (wide ? "%rax" : "%eax"));
+            store_int(inst.result, RAX);
+            return;
+        }
+        case opcode::sdiv: {
+            const bool wide = is_wide(inst.ty);
+            load_int(ops[0], RAX);
+            load_int(ops[1], RCX);
+            line(wide ? "cqto" : "cltd");
+            line(wide ? "idivq %rcx" : "idivl %ecx");
+            store_int(inst.result, RAX);
+            return;
+        }
+        case opcode::fadd:
+        case opcode::fsub:
+        case opcode::fmul:
+        case opcode::fdiv: {
+            static const std::unordered_map<opcode, std::string> names = {
+                {opcode::fadd, "addsd"}, {opcode::fsub, "subsd"}, {opcode::fmul, "mulsd"}, {opcode::fdiv, "divsd"}};
+            load_float(ops[0], 0);
+            const auto rhs = float_src(ops[1], 1);
+            line(names.at(inst.op) + " " + rhs + ", %xmm0");
+            store_float(inst.result, 0);
+            return;
+        }
+        case opcode::icmp: {
+            static const std::unordered_map<std::string, std::string> cc = {
+                {"eq", "e"}, {"ne", "ne"}, {"slt", "l"}, {"sle", "le"}, {"sgt", "g"}, {"sge", "ge"},
+                {"ult", "b"}, {"ule", "be"}, {"ugt", "a"}, {"uge", "ae"}};
+            const bool wide = is_wide(inst.ty);
+            load_int(ops[0], RAX);
+            const auto rhs = int_src(ops[1], inst.ty, RCX);
+            line(std::string(wide ? "cmpq " : "cmpl ") + rhs + ", " + (wide ? "%rax" : "%eax"));
+            line("set" + cc.at(inst.pred) + " %al");
+            line("movzbl %al, %eax");
+            store_int(inst.result, RAX);
+            return;
+        }
+        case opcode::fcmp: {
+            // ucomisd 在无序时置 ZF=PF=CF=1，oeq/one 需要额外检查 PF
+            const bool swap = inst.pred == "olt" || inst.pred == "ole";
+            load_float(ops[swap ? 1 : 0], 0);
+            const auto rhs = float_src(ops[swap ? 0 : 1], 1);
+            line("ucomisd " + rhs + ", %xmm0");
+            if (inst.pred == "oeq" || inst.pred == "one") {
+                line(inst.pred == "oeq" ? "sete %al" : "setne %al");
+                line("setnp %cl");
+                line("andb %cl, %al");
+            } else if (inst.pred == "ogt" || inst.pred == "olt") {
+                line("seta %al");
+            } else if (inst.pred == "oge" || inst.pred == "ole") {
+                line("setae %al");
+            } else {
+                throw parse_error("unsupported fcmp predicate " + inst.pred);
+            }
+            line("movzbl %al, %eax");
+            store_int(inst.result, RAX);
+            return;
+        }
+        case opcode::zext:
+            load_int(ops[0], RAX);
+            line(inst.ty.base == type::kind::i1 ? "andl $1, %eax" : "movl %eax, %eax");
+            store_int(inst.result, RAX);
+            return;
+        case opcode::sext:
+            load_int(ops[0], RAX);
+            if (inst.ty.base == type::kind::i1) {
+                line("andl $1, %eax");
+                line("negq %rax");
+            } else {
+                line("movslq %eax, %rax");
+            }
+            store_int(inst.result, RAX);
+            return;
+        case opcode::trunc:
+            load_int(ops[0], RAX);
+            if (inst.to.base == type::kind::i1) {
+                line("andl $1, %eax");
+            }
+            store_int(inst.result, RAX);
+            return;
+        case opcode::ptrtoint:
+        case opcode::inttoptr:
+            load_int(ops[0], RAX);
+            store_int(inst.result, RAX);
+            return;
+        case opcode::sitofp:
+            load_int(ops[0], RAX);
+            line(is_wide(inst.ty) ? "cvtsi2sdq %rax, %xmm0" : "cvtsi2sdl %eax, %xmm0");
+            store_float(inst.result, 0);
+            return;
+        case opcode::fptosi:
+            load_float(ops[0], 0);
+            line(is_wide(inst.to) ? "cvttsd2siq %xmm0, %rax" : "cvttsd2sil %xmm0, %eax");
+            store_int(inst.result, RAX);
+            return;
+        case opcode::gep:
+            load_int(ops[0], RAX);
+            store_int(inst.result, RAX);
+            return;
+        case opcode::load: {
+            const auto addr = address(ops[0]);
+            if (inst.ty.is_float()) {
+                line("movsd " + addr + ", %xmm0");
+                store_float(inst.result, 0);
+            } else {
+                line(std::string(is_wide(inst.ty) ? "movq " : "movl ") + addr + ", " + (is_wide(inst.ty) ? "%rax" : "%eax"));
+                store_int(inst.result, RAX);
+            }
+            return;
+        }
+        case opcode::store: {
+            if (inst.ty.is_float()) {
+                load_float(ops[0], 0);
+                line("movsd %xmm0, " + address(ops[1]));
+            } else {
+                load_int(ops[0], RAX);
+                const auto addr = address(ops[1]);
+                line(std::string(is_wide(inst.ty) ? "movq %rax, " : "movl %eax, ") + addr);
+            }
+            return;
+        }
+        case opcode::call: emit_call(inst, pos); return;
+        case opcode::br: emit_jump(block, inst.labels[0]); return;
+        case opcode::cond_br: emit_cond_br(inst, block); return;
+        case opcode::ret:
+            if (!ops.empty()) {
+                if (inst.ty.is_float()) {
+                    load_float(ops[0], 0);
+                } else {
+                    load_int(ops[0], RAX);
+                }
+            }
+            if (saved_count > 0) {
+                line("leaq " + std::to_string(-8 * saved_count) + "(%rbp), %rsp");
+            }
+            for (auto it = used_callee_saved.rbegin(); it != used_callee_saved.rend(); ++it) {
+                line("popq " + std::string(gpr64[*it]));
+            }
+            line("leave");
+            line("ret");
+            return;
+        }
+    }
+
+    void emit_cond_br(const instruction& inst, const std::size_t block) {
+        const auto& cond = inst.operands[0];
+        const auto& from = func.blocks[block].label;
+        if (cond.k == value::kind::imm || cond.k == value::kind::undef) {
+            emit_jump(block, inst.labels[cond.k == value::kind::imm && cond.imm ? 0 : 1]);
+            return;
+        }
+
+        // 目标块有 phi 时经由一段边上的代码完成复制
+        auto edge_target = [&](const std::string& to) {
+            return has_phis(to) ? ".L" + func.name + "_edge" + std::to_string(edge_counter++) : label_of(to);
+        };
+        const auto then_target = edge_target(inst.labels[0]);
+        const auto else_target = edge_target(inst.labels[1]);
+
+        const auto reg = int_src(cond, {type::kind::i1}, RAX);
+        if (reg.starts_with("%")) {
+            line("testl " + reg + ", " + reg);
+        } else {
+            load_int(cond, RAX);
+            line("testl %eax, %eax");
+        }
+        line("jne " + then_target);
+        // 边上的复制代码紧跟在本块之后，有它们时不能直接落入 else 块
+        const bool edges = has_phis(inst.labels[0]) || has_phis(inst.labels[1]);
+        if (!edges && is_next(block, inst.labels[1])) {
+            // 直接落入 else 块
+        } else {
+            line("jmp " + else_target);
+        }
+        for (int k = 0; k < 2; ++k) {
+            const auto& to = inst.labels[k];
+            if (!has_phis(to)) {
+                continue;
+            }
+            os << (k == 0 ? then_target : else_target) << ":\n";
+            emit_phi_copies(from, to);
+            line("jmp " + label_of(to));
+        }
+    }
+
+    void emit_call(const instruction& inst, const int pos) {
+        // 跨越调用点仍然存活的 xmm 寄存器需要保存
+        std::vector<int> to_save;
+        for (const auto& [name, it] : intervals) {
+            const auto& loc = locations.at(name);
+            if (it.is_float && loc.k == location::kind::reg && it.start < pos && it.end > pos) {
+                to_save.push_back(loc.reg);
+            }
+        }
+        std::ranges::sort(to_save);
+        to_save.erase(std::ranges::unique(to_save).begin(), to_save.end());
+        for (const auto r : to_save) {
+            line("movsd " + xmm(r) + ", " + slot(xmm_save_slots.at(r)));
+        }
+
+        std::vector<std::size_t> stack_args;
+        std::vector<std::pair<std::size_t, int>> reg_args;
+        std::vector<std::pair<std::size_t, int>> float_args;
+        for (std::size_t i = 0; i < inst.operands.size(); ++i) {
+            if (inst.arg_types[i].is_float()) {
+                if (float_args.size() < 8) {
+                    float_args.emplace_back(i, static_cast<int>(float_args.size()));
+                } else {
+                    stack_args.push_back(i);
+                }
+            } else if (reg_args.size() < 6) {
+                reg_args.emplace_back(i, int_args[reg_args.size()]);
+            } else {
+                stack_args.push_back(i);
+            }
+        }
+
+        const bool pad = stack_args.size() % 2 == 1;
+        if (pad) {
+            line("subq $8, %rsp");
+        }
+        for (auto it = stack_args.rbegin(); it != stack_args.rend(); ++it) {
+            load_int_bits(inst.operands[*it], inst.arg_types[*it].is_float());
+            line("pushq %rax");
+        }
+        for (const auto& [i, x] : float_args) {
+            load_float(inst.operands[i], x);
+        }
+        for (const auto& [i, r] : reg_args) {
+            load_int(inst.operands[i], r);
+        }
+        line("movl $" + std::to_string(float_args.size()) + ", %eax");
+        line("call " + inst.callee + "@PLT");
+        const auto popped = 8 * (stack_args.size() + (pad ? 1 : 0));
+        if (popped > 0) {
+            line("addq $" + std::to_string(popped) + ", %rsp");
+        }
+
+        for (const auto r : to_save) {
+            line("movsd " + slot(xmm_save_slots.at(r)) + ", " + xmm(r));
+        }
+        if (inst.has_result() && locations.contains(inst.result)) {
+            if (inst.ty.is_float()) {
+                store_float(inst.result, 0);
+            } else {
+                store_int(inst.result, RAX);
+            }
+        }
+    }
+};
+
+} // namespace
+
+void emit(std::ostream& os, const module& mod) {
+    os << "\t.text\n";
+    for (const auto& func : mod.functions) {
+        function_emitter(os, func).run();
+    }
+    if (!mod.globals.empty()) {
+        os << "\t.section .rodata\n";
+        for (const auto& g : mod.globals) {
+            os << ".L" << g.name << ":\n";
+            os << "\t.asciz \"" << escape(g.data) << "\"\n";
+        }
+    }
+    os << "\t.section .note.GNU-stack,\"\",@progbits\n";
+}
+
+} // namespace ir::x86
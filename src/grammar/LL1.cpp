@@ -26,17 +26,19 @@ LL1::LL1(const std::string& str) {
 }
 
 void LL1::build() {
+    const context_scope scope(context_);
     calc_first();
     calc_follow();
     build_parsing_table();
 }
 
 void LL1::parse(const std::vector<lexer::token>& input) {
+    const context_scope scope(context_);
     auto in = input;
-    in.emplace_back(production::symbol::end_mark_str);
+    in.emplace_back(context::current().end_mark_str());
 
     std::stack<production::symbol> stack;
-    stack.push(production::symbol::end_mark);
+    stack.push(production::symbol::end_mark());
     stack.push(productions[0].lhs);
 
     std::size_t pos = 0;
@@ -68,9 +70,9 @@ void LL1::parse(const std::vector<lexer::token>& input) {
         } else {
             const auto& table = parsing_table.at(top);
             if (!table.contains(cur_input)) {
-                if (first.at(top).contains(production::symbol::epsilon)) {
+                if (first.at(top).contains(production::symbol::epsilon())) {
                     stack.pop();
-                    tree_->add(production::production(top.name + " -> " + production::symbol::epsilon_str));
+                    tree_->add(production::production(top.name + " -> " + context::current().epsilon_str()));
                 } else if (!follow.at(top).contains(cur_input)) {
                     pos++;
                 } else {
@@ -176,7 +178,7 @@ void LL1::build_parsing_table() {
                 parsing_table[prod.lhs][sym] = prod;
             }
         }
-        if (first_set.contains(production::symbol::epsilon)) {
+        if (first_set.contains(production::symbol::epsilon())) {
             for (auto follow_set = follow[prod.lhs]; const auto& sym : follow_set) {
                 if (sym.is_terminal() || sym.is_end_mark()) {
                     if (parsing_table[prod.lhs].contains(sym)) {
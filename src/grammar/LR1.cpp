@@ -7,7 +7,7 @@ LR1::LR1(const std::vector<production::production>& productions) : SLR(productio
 LR1::LR1(const std::string& str) : SLR(str) {}
 
 void LR1::init_first_item_set() {
-    items_t initial_items{production::LR1_production(productions[0], production::symbol::end_mark)};
+    items_t initial_items{production::LR1_production(productions[0], production::symbol::end_mark())};
     add_closure(initial_items, 0);
 }
 
@@ -65,8 +65,8 @@ void LR1::build_acc_and_reduce(const items_t& current_items, const std::size_t i
     for (const auto& item : current_items) {
         if (item.is_end()) {
             if (item.lhs == productions[0].lhs) {
-                assert(!action_table[idx].contains(production::symbol::end_mark));
-                action_table[idx][production::symbol::end_mark] = action::accept();
+                assert(!action_table[idx].contains(production::symbol::end_mark()));
+                action_table[idx][production::symbol::end_mark()] = action::accept();
             } else {
                 std::size_t pid = -1;
                 for (const auto id : symbol_map[item.lhs]) {
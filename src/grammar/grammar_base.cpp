@@ -1,4 +1,5 @@
 #include "grammar/grammar_base.hpp"
+#include "trace.hpp"
 
 #include <ranges>
 
@@ -13,6 +14,7 @@ std::shared_ptr<tree> grammar_base::get_tree() const {
 }
 
 void grammar_base::calc_first() {
+    const trace::span span("grammar_base::calc_first");
     for (const auto& prod : productions) {
         calc_first(prod.lhs);
     }
@@ -41,7 +43,7 @@ grammar_base::symbol_set& grammar_base::calc_first(const production::symbol& sym
             auto first_set = calc_first(s);
             result.insert(first_set.begin(), first_set.end());
 
-            if (!first_set.contains(production::symbol::epsilon)) {
+            if (!first_set.contains(production::symbol::epsilon())) {
                 break;
             }
         }
@@ -55,7 +57,7 @@ grammar_base::symbol_set grammar_base::calc_first(const std::vector<production::
     for (const auto& sym : symbols) {
         auto first_set = calc_first(sym);
         result.insert(first_set.begin(), first_set.end());
-        if (!first_set.contains(production::symbol::epsilon)) {
+        if (!first_set.contains(production::symbol::epsilon())) {
             break;
         }
     }
@@ -63,7 +65,8 @@ grammar_base::symbol_set grammar_base::calc_first(const std::vector<production::
 }
 
 void grammar_base::calc_follow() {
-    follow[productions[0].lhs].insert(production::symbol::end_mark);
+    const trace::span span("grammar_base::calc_follow");
+    follow[productions[0].lhs].insert(production::symbol::end_mark());
     while (true) {
         bool changed = false;
         for (std::size_t i = 0; i < productions.size(); ++i) {
@@ -75,7 +78,7 @@ void grammar_base::calc_follow() {
     }
 
     for (auto &follow_set: follow | std::views::values) {
-        follow_set.erase(production::symbol::epsilon);
+        follow_set.erase(production::symbol::epsilon());
     }
 
 #ifdef DEBUG
@@ -118,7 +121,7 @@ bool grammar_base::calc_follow(const std::size_t pos) {
         if (!prev_sym.is_non_terminal()) {
             continue;
         }
-        if (auto& first_set = calc_first(sym); first_set.contains(production::symbol::epsilon)) {
+        if (auto& first_set = calc_first(sym); first_set.contains(production::symbol::epsilon())) {
             follow[prev_sym].insert(follow[lhs].begin(), follow[lhs].end());
         } else {
             break;
@@ -133,7 +136,7 @@ grammar_base::symbol_set grammar_base::calc_first(const production::production&
     for (const auto& sym : prod.rhs) {
         auto first_set = first.at(sym);
         result.insert(first_set.begin(), first_set.end());
-        if (!first_set.contains(production::symbol::epsilon)) {
+        if (!first_set.contains(production::symbol::epsilon())) {
             break;
         }
     }
@@ -2,28 +2,21 @@
 
 namespace grammar::production {
 
-std::string symbol::epsilon_str = "ε";
-std::string symbol::end_mark_str = "$";
-std::function<bool(const std::string&)> symbol::terminal_rule = [](const std::string& str) {
-    return !std::isupper(str[0]);
-};
-symbol symbol::epsilon = symbol(epsilon_str);
-symbol symbol::end_mark = symbol(end_mark_str);
-
 symbol::symbol() {
     type = type::epsilon;
-    name = std::string(epsilon_str);
-    lexval = std::string(epsilon_str);
+    name = context::current().epsilon_str();
+    lexval = name;
 }
 
 symbol::symbol(const std::string& str) {
     const auto trimed = trim(str);
+    const auto& ctx = context::current();
 
-    if (str == epsilon_str) {
+    if (str == ctx.epsilon_str()) {
         type = type::epsilon;
-    } else if (trimed == end_mark_str) {
+    } else if (trimed == ctx.end_mark_str()) {
         type = type::end_mark;
-    } else if (terminal_rule(trimed)) {
+    } else if (ctx.is_terminal(trimed)) {
         type = type::terminal;
     } else {
         type = type::non_terminal;
@@ -33,6 +26,8 @@ symbol::symbol(const std::string& str) {
     lexval = trimed;
 }
 
+symbol::symbol(const enum type type, const std::string& str) : type(type), name(str), lexval(str) {}
+
 symbol::symbol(const lexer::token& token) : symbol(std::string(token)) {
     update(token);
 }
@@ -89,6 +84,14 @@ bool symbol::operator!=(const symbol& other) const {
     return !(*this == other);
 }
 
+const symbol& symbol::epsilon() {
+    return context::current().epsilon();
+}
+
+const symbol& symbol::end_mark() {
+    return context::current().end_mark();
+}
+
 std::string symbol::trim(const std::string& str) {
     std::size_t start = str.find_first_not_of(" \t\n\r");
     std::size_t end = str.find_last_not_of(" \t\n\r");
@@ -281,26 +284,82 @@ bool LR1_production::operator==(const production& other) const {
 
 namespace grammar {
 
+namespace {
+
+thread_local context default_context;
+thread_local const context* active_context = nullptr;
+
+} // namespace
+
+context::context()
+    : terminal_rule_([](const std::string& str) { return !std::isupper(str[0]); }),
+      epsilon_(production::symbol::type::epsilon, epsilon_str_),
+      end_mark_(production::symbol::type::end_mark, end_mark_str_) {}
+
+void context::set_epsilon_str(const std::string& str) {
+    epsilon_str_ = str;
+    epsilon_ = production::symbol(production::symbol::type::epsilon, str);
+}
+
+void context::set_end_mark_str(const std::string& str) {
+    end_mark_str_ = str;
+    end_mark_ = production::symbol(production::symbol::type::end_mark, str);
+}
+
+void context::set_terminal_rule(std::function<bool(const std::string&)> rule) {
+    terminal_rule_ = std::move(rule);
+}
+
+const std::string& context::epsilon_str() const {
+    return epsilon_str_;
+}
+
+const std::string& context::end_mark_str() const {
+    return end_mark_str_;
+}
+
+bool context::is_terminal(const std::string& str) const {
+    return terminal_rule_(str);
+}
+
+const production::symbol& context::epsilon() const {
+    return epsilon_;
+}
+
+const production::symbol& context::end_mark() const {
+    return end_mark_;
+}
+
+const context& context::current() {
+    return active_context ? *active_context : default_context;
+}
+
+context& context::thread_default() {
+    return default_context;
+}
+
+context_scope::context_scope(const context& ctx) : previous(active_context) {
+    active_context = &ctx;
+}
+
+context_scope::~context_scope() {
+    active_context = previous;
+}
+
 void set_epsilon_str(const std::string& str) {
-    using namespace grammar::production;
-    symbol::epsilon_str = str;
-    symbol::epsilon = symbol(symbol::epsilon_str);
+    context::thread_default().set_epsilon_str(str);
 }
 
 void set_end_mark_str(const std::string& str) {
-    using namespace grammar::production;
-    symbol::end_mark_str = str;
-    symbol::end_mark = symbol(symbol::end_mark_str);
+    context::thread_default().set_end_mark_str(str);
 }
 
 void set_terminal_rule(const std::function<bool(const std::string&)>& rule) {
-    using namespace grammar::production;
-    symbol::terminal_rule = rule;
+    context::thread_default().set_terminal_rule(rule);
 }
 
 void set_terminal_rule(std::function<bool(const std::string&)>&& rule) {
-    using namespace grammar::production;
-    symbol::terminal_rule = std::move(rule);
+    context::thread_default().set_terminal_rule(std::move(rule));
 }
 
-} // namespace grammar
\ No newline at end of file
+} // namespace grammar
@@ -72,7 +72,7 @@ void tree::add(const production::production& prod) {
     if (found) {
         next = new_next;
     } else {
-        next = next->parent;
+        next = next->parent.lock();
         while (next) {
             for (const auto& child : next->children) {
                 if (child->symbol->is_non_terminal() && child->children.empty()) {
@@ -84,7 +84,7 @@ void tree::add(const production::production& prod) {
             if (found) {
                 break;
             }
-            next = next->parent;
+            next = next->parent.lock();
         }
     }
 }
@@ -127,7 +127,7 @@ void tree::add_r(const production::production& prod) {
     }
 
     if (!found) {
-        next_r = next_r->parent;
+        next_r = next_r->parent.lock();
         while (next_r) {
             for (auto it = next_r->children.rbegin(); it != next_r->children.rend(); ++it) {
                 if ((*it)->symbol->is_non_terminal() && (*it)->children.empty()) {
@@ -139,7 +139,7 @@ void tree::add_r(const production::production& prod) {
             if (found) {
                 break;
             }
-            next_r = next_r->parent;
+            next_r = next_r->parent.lock();
         }
     }
 }
@@ -1,5 +1,9 @@
 #include "lexer/lexer.hpp"
+#include "trace.hpp"
+
 #include <algorithm>
+#include <cstring>
+#include <thread>
 
 #ifdef USE_STD_REGEX
 
@@ -16,88 +20,323 @@ std::size_t regex_wrapper::match_max(const std::string& input) const {
     return 0;
 }
 
+std::size_t regex_wrapper::match_max(const std::string_view input, std::size_t& scanned) const {
+    scanned = input.size() + 1;
+    std::match_results<std::string_view::const_iterator> match;
+    if (std::regex_search(input.begin(), input.end(), match, regex_, std::regex_constants::match_continuous)) {
+        return match.length();
+    }
+    return 0;
+}
+
+std::size_t regex_wrapper::state_count() const {
+    return 0;
+}
+
 } // namespace lexer
 
 #endif
 
 namespace lexer {
 
+namespace {
+
+// 每块至少这么多字节才值得并行分析
+constexpr std::size_t min_chunk = 1 << 16;
+
+void accumulate_reach(lexer::tokens_t& tokens, const std::size_t from) {
+    for (auto i = std::max<std::size_t>(from, 1); i < tokens.size(); ++i) {
+        tokens[i].reach = std::max(tokens[i].reach, tokens[i - 1].reach);
+    }
+}
+
+} // namespace
+
+line_index::line_index(const std::string_view input) {
+    const char* const begin = input.data();
+    const char* const end = begin + input.size();
+    for (const char* p = begin; p != end;) {
+        const auto* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!newline) {
+            break;
+        }
+        newlines.push_back(newline - begin);
+        p = newline + 1;
+    }
+}
+
+std::pair<std::size_t, std::size_t> line_index::locate(const std::size_t offset) const {
+    const auto before = std::lower_bound(newlines.begin(), newlines.end(), offset) - newlines.begin();
+    const auto line_start = before == 0 ? 0 : newlines[before - 1] + 1;
+    return {before + 1, offset - line_start + 1};
+}
+
+void line_index::resolve(std::vector<token>& tokens, const std::size_t from) const {
+    if (from >= tokens.size()) {
+        return;
+    }
+    // token 按偏移有序，与换行位置归并即可
+    auto next = std::lower_bound(newlines.begin(), newlines.end(), tokens[from].offset);
+    for (auto i = from; i < tokens.size(); ++i) {
+        auto& t = tokens[i];
+        while (next != newlines.end() && *next < t.offset) {
+            ++next;
+        }
+        const auto before = static_cast<std::size_t>(next - newlines.begin());
+        t.line = before + 1;
+        t.column = t.offset - (before == 0 ? 0 : newlines[before - 1] + 1) + 1;
+    }
+}
+
 lexer::tokens_t lexer::parse(const std::string& input, bool skip_whitespace) const {
-    std::size_t max_match = 0;
-    std::string cur = input;
-    int cur_token;
+    const trace::span span("lexer::parse");
+    tokens_t tokens;
+    scan(input, 0, skip_whitespace, tokens, {});
+    accumulate_reach(tokens, 0);
+    line_index(input).resolve(tokens);
+    return tokens;
+}
 
-    std::size_t line = 0;
-    std::size_t col = 0;
+lexer::tokens_t lexer::parse_parallel(const std::string& input, std::size_t jobs, const bool skip_whitespace) const {
+    const trace::span span("lexer::parse_parallel");
+    jobs = std::min(jobs, input.size() / min_chunk);
+    if (jobs <= 1) {
+        return parse(input, skip_whitespace);
+    }
 
+    // 块边界尽量放在附近的换行之后，减少推测分析从 token 中间开始的情况
+    std::vector<std::size_t> bounds{0};
+    for (std::size_t i = 1; i < jobs; ++i) {
+        auto bound = input.size() * i / jobs;
+        if (const auto newline = input.find('\n', bound); newline != std::string::npos && newline - bound < min_chunk / 16) {
+            bound = newline + 1;
+        }
+        bounds.push_back(bound);
+    }
+    bounds.push_back(input.size());
+
+    // 每块从块首开始推测性地分析，直到遇到从下一块开始的 token，end 为该 token 的位置
+    struct chunk {
+        tokens_t tokens;
+        std::size_t end = 0;
+    };
+    std::vector<chunk> chunks(jobs);
+    {
+        std::vector<std::jthread> workers;
+        for (std::size_t i = 0; i < jobs; ++i) {
+            workers.emplace_back([&, i] {
+                auto& c = chunks[i];
+                c.end = input.size();
+                scan(input, bounds[i], skip_whitespace, c.tokens, [&](const token& t) {
+                    if (t.offset < bounds[i + 1]) {
+                        return false;
+                    }
+                    c.end = t.offset;
+                    return true;
+                });
+            });
+        }
+    }
+
+    // 按顺序拼接：推测结果中从真实分析位置开始的 token 及其之后的 token 都是真实结果
+    auto offset_less = [](const token& t, const std::size_t offset) { return t.offset < offset; };
     tokens_t tokens;
+    std::size_t pos = 0;
+    std::size_t i = 0;
+    while (pos < input.size()) {
+        while (bounds[i + 1] <= pos) {
+            ++i;
+        }
+        auto& c = chunks[i];
+        const auto found = pos == bounds[i] ? c.tokens.begin() : std::lower_bound(c.tokens.begin(), c.tokens.end(), pos, offset_less);
+        if (pos == bounds[i] || (found != c.tokens.end() && found->offset == pos && found->type != -1)) {
+            tokens.insert(tokens.end(), std::make_move_iterator(found), std::make_move_iterator(c.tokens.end()));
+            pos = c.end;
+            continue;
+        }
+
+        // 推测结果与真实位置错开，从真实位置顺序分析，直到与推测结果对齐或进入下一块
+        const auto base = tokens.size();
+        auto next = input.size();
+        const auto leading = scan(input, pos, skip_whitespace, tokens, [&](const token& t) {
+            if (t.offset < bounds[i + 1]) {
+                const auto same = std::lower_bound(c.tokens.begin(), c.tokens.end(), t.offset, offset_less);
+                if (same == c.tokens.end() || same->offset != t.offset) {
+                    return false;
+                }
+            }
+            next = t.offset;
+            return true;
+        });
+        if (base > 0) {
+            tokens[base - 1].reach = std::max(tokens[base - 1].reach, leading);
+        }
+        pos = next;
+    }
+
+    accumulate_reach(tokens, 0);
+    line_index(input).resolve(tokens);
+    return tokens;
+}
+
+std::size_t lexer::scan(const std::string& input, std::size_t pos, const bool skip_whitespace, tokens_t& tokens,
+                        const std::function<bool(const token&)>& stop) const {
+    const auto base = tokens.size();
+    std::size_t leading = pos;
+    // 被跳过的 token 读取的字符计入前一个 token 的 reach
+    auto extend = [&](const std::size_t far) {
+        if (tokens.size() > base) {
+            tokens.back().reach = std::max(tokens.back().reach, far);
+        } else {
+            leading = std::max(leading, far);
+        }
+    };
 
     token err_token(-1, "", -1, -1);
     bool is_err = false;
-    while (max_match < cur.size()) {
-        for (auto& [pattern, token] : key_words) {
-            if (const auto match = pattern.match_max(cur); match > max_match) {
+    while (pos < input.size()) {
+        const auto cur = std::string_view(input).substr(pos);
+        std::size_t max_match = 0;
+        std::size_t far = pos;
+        int cur_token = -1;
+        const std::string* cur_name = nullptr;
+        for (const auto& [pattern, type, name] : key_words) {
+            std::size_t scanned;
+            const auto match = pattern.match_max(cur, scanned);
+            far = std::max(far, pos + scanned);
+            if (match > max_match) {
                 max_match = match;
-                cur_token = token;
+                cur_token = type;
+                cur_name = name;
             }
         }
 
         if (max_match == 0) {
             if (is_err) {
-                err_token.value += cur[0];
+                err_token.value += input[pos];
+                err_token.reach = std::max(err_token.reach, far);
             } else {
                 is_err = true;
-                err_token = token(-1, std::string{cur[0]}, line + 1, col + 1);
+                err_token = token(-1, std::string{input[pos]}, 0, 0);
+                err_token.offset = pos;
+                err_token.reach = far;
             }
-            col++;
-            cur = cur.substr(1);
+            pos++;
             continue;
         }
 
-        is_err = false;
-        if (!err_token.value.empty()) {
+        // 错误 token 在下一次匹配成功时结束，这次匹配读取的字符同样计入它的 reach
+        if (is_err) {
+            is_err = false;
+            err_token.reach = std::max(err_token.reach, far);
             tokens.emplace_back(std::move(err_token));
             err_token = token(-1, "", -1, -1);
         }
 
-        auto match_str = cur.substr(0, max_match);
-        const auto lines = std::ranges::count(match_str, '\n');
-        const auto last_newline = match_str.find_last_of('\n');
-
-        if (!skip_whitespace || cur_token != whitespace) {
-            tokens.emplace_back(cur_token, match_str, line + 1, col + 1);
-        }
-
-        if (lines > 0) {
-            line += lines;
-            col = match_str.size() - last_newline - 1;
+        if (skip_whitespace && std::ranges::find(skipped, cur_token) != skipped.end()) {
+            extend(far);
         } else {
-            col += match_str.size();
+            token tk(cur_token, input.substr(pos, max_match), 0, 0);
+            tk.name = cur_name;
+            tk.offset = pos;
+            tk.reach = far;
+            if (stop && stop(tk)) {
+                return leading;
+            }
+            tokens.emplace_back(std::move(tk));
         }
 
-        cur = cur.substr(max_match);
-        max_match = 0;
+        pos += max_match;
     }
 
+    // 是否到达输入末尾同样决定了最后一个 token
     if (is_err) {
+        err_token.reach = input.size() + 1;
         tokens.emplace_back(std::move(err_token));
+    } else {
+        extend(input.size() + 1);
     }
+    return leading;
+}
 
-    return tokens;
+lexer::damage lexer::relex(const std::string& input, tokens_t& tokens, const edit& e, const bool skip_whitespace) const {
+    auto first = static_cast<std::size_t>(
+        std::ranges::partition_point(tokens, [&](const token& t) { return t.reach <= e.offset; }) - tokens.begin());
+    if (first == tokens.size()) {
+        first = 0;
+    }
+
+    const std::size_t start = first > 0 ? tokens[first].offset : 0;
+
+    // 编辑之后的新 token 与某个旧 token 位置相同时，其后的 token 序列必然与旧序列相同
+    const auto delta = e.inserted - e.removed;
+    auto resume = tokens.size();
+    tokens_t fresh;
+    const auto leading = scan(input, start, skip_whitespace, fresh, [&](const token& t) {
+        if (t.offset < e.offset + e.inserted) {
+            return false;
+        }
+        const auto old_offset = t.offset - delta;
+        const auto found = std::lower_bound(tokens.begin() + static_cast<std::ptrdiff_t>(first), tokens.end(), old_offset,
+                                            [](const token& old, const std::size_t offset) { return old.offset < offset; });
+        if (found == tokens.end() || found->offset != old_offset || found->type == -1) {
+            return false;
+        }
+        resume = found - tokens.begin();
+        return true;
+    });
+    if (first > 0) {
+        tokens[first - 1].reach = std::max(tokens[first - 1].reach, leading);
+    }
+
+    for (auto i = resume; i < tokens.size(); ++i) {
+        tokens[i].offset += delta;
+        tokens[i].reach += delta;
+    }
+
+    const damage result{first, resume, first + fresh.size()};
+    tokens.erase(tokens.begin() + static_cast<std::ptrdiff_t>(first), tokens.begin() + static_cast<std::ptrdiff_t>(resume));
+    tokens.insert(tokens.begin() + static_cast<std::ptrdiff_t>(first), std::make_move_iterator(fresh.begin()),
+                  std::make_move_iterator(fresh.end()));
+
+    for (auto i = std::max<std::size_t>(first, 1); i < tokens.size(); ++i) {
+        if (tokens[i].reach >= tokens[i - 1].reach) {
+            if (i >= result.new_end) {
+                break;
+            }
+            continue;
+        }
+        tokens[i].reach = tokens[i - 1].reach;
+    }
+    line_index(input).resolve(tokens, first);
+    return result;
+}
+
+int lexer::whitespace() const {
+    return whitespace_;
 }
 
-std::unordered_map<int, std::string> lexer::token_names{};
-int lexer::whitespace;
+const lexer::token_names_t& lexer::token_names() const {
+    return *token_names_;
+}
+
+std::size_t lexer::dfa_states() const {
+    std::size_t count = 0;
+    for (const auto& keyword : key_words) {
+        count += keyword.pattern.state_count();
+    }
+    return count;
+}
 
 token::operator std::string() const {
     if (type == -1) {
         return value;
     }
-    return lexer::token_names[type];
+    return name ? *name : std::string{};
 }
 
 std::ostream& operator<<(std::ostream& os, const token& t) {
-    const std::string type = lexer::token_names.contains(t.type) ? lexer::token_names[t.type] : std::to_string(t.type);
+    const std::string type = t.name ? *t.name : std::to_string(t.type);
     os << "Token(" << type << ", \"" << t.value << "\", line: " << t.line << ", column: " << t.column << ")";
     return os;
 }
@@ -1,8 +1,19 @@
 #include "regex/dfa.hpp"
+#include "trace.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <iostream>
+#include <map>
 #include <ranges>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if !defined(REGEX_SCALAR) && defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace regex::dfa {
 
@@ -21,65 +32,53 @@ dfa::dfa(const std::string& regex) {
 #endif
 }
 
-void dfa::add_transition(const state_t from, const token_t& token, const state_t to) {
-    transitions[from][token] = to;
-}
-
 bool dfa::match(const std::string& str) const {
     state_t current_state = 1;
-    for (const auto& ch : str) {
-        bool find = false;
-        if (!transitions.contains(current_state)) {
-            return false;
-        }
-        if (transitions.at(current_state).contains(ch)) {
-            current_state = transitions.at(current_state).at(ch);
-            continue;
-        }
-        for (const auto& [token, to] : transitions.at(current_state)) {
-            if (token::match(ch, token)) {
-                current_state = to;
-                find = true;
-                break;
-            }
-        }
-        if (!find) {
+    for (const auto ch : str) {
+        current_state = step(current_state, ch);
+        if (current_state == 0) {
             return false;
         }
     }
-    return accept_states.contains(current_state);
+    return states[current_state].accepting;
 }
 
 std::size_t dfa::match_max(const std::string& str) const {
+    std::size_t scanned;
+    return match_max(str, scanned);
+}
+
+std::size_t dfa::match_max(const std::string_view str, std::size_t& scanned) const {
     state_t current_state = 1;
     std::size_t last_accept_pos = 0;
+    scanned = str.size() + 1;
 
     for (size_t i = 0; i < str.size(); ++i) {
-        char ch = str[i];
-        bool find = false;
-
-        if (!transitions.contains(current_state)) {
-            break;
-        }
-
-        if (transitions.at(current_state).contains(ch)) {
-            current_state = transitions.at(current_state).at(ch);
-            find = true;
-        } else {
-            for (const auto& [token, to] : transitions.at(current_state)) {
-                if (token::match(ch, token)) {
-                    current_state = to;
-                    find = true;
+        const auto& info = states[current_state];
+        if (info.run >= 0) {
+            if (const auto end = runs[info.run].skip(str, i); end > i) {
+                i = end;
+                if (info.accepting) {
+                    last_accept_pos = i;
+                }
+                if (i == str.size()) {
                     break;
                 }
             }
         }
+        if (info.final) {
+            scanned = i;
+            break;
+        }
 
-        if (!find) {
+        const auto next = step(current_state, str[i]);
+        if (next == 0) {
+            scanned = i + 1;
             break;
         }
+        current_state = next;
 
-        if (accept_states.contains(current_state)) {
+        if (states[current_state].accepting) {
             last_accept_pos = i + 1;
         }
     }
@@ -87,79 +86,399 @@ std::size_t dfa::match_max(const std::string& str) const {
     return last_accept_pos;
 }
 
-const dfa::dfa_state_t& dfa::get_transitions() const {
-    return transitions;
+dfa::state_t dfa::next(const state_t from, const char ch) const {
+    return from < states.size() ? step(from, ch) : 0;
+}
+
+bool dfa::accepts(const state_t state) const {
+    return state < states.size() && states[state].accepting;
+}
+
+std::size_t dfa::state_count() const {
+    return states.size() - 1;
+}
+
+std::size_t dfa::class_count() const {
+    return classes;
 }
 
 void dfa::print() const {
     std::cout << "DFA" << std::endl;
-    for (const auto& [from, trans] : transitions) {
-        for (const auto& [token, to] : trans) {
-            std::cout << "  Transition: " << from << " -- " << token << " --> " << to << std::endl;
+    for (state_t from = 1; from < states.size(); ++from) {
+        std::vector<std::pair<state_t, token::char_set>> edges;
+        for (int c = 0; c < 256; ++c) {
+            const auto to = step(from, static_cast<char>(c));
+            if (to == 0) {
+                continue;
+            }
+            auto edge = std::ranges::find(edges, to, &std::pair<state_t, token::char_set>::first);
+            if (edge == edges.end()) {
+                edge = edges.emplace(edges.end(), to, token::char_set{});
+            }
+            edge->second.add(static_cast<char>(c));
+        }
+        for (const auto& [to, set] : edges) {
+            std::cout << "  Transition: " << from << " -- " << token::token_type{set} << " --> " << to << std::endl;
         }
     }
     std::cout << "  Accept states: ";
-    for (const auto& state : accept_states) {
-        std::cout << state << " ";
+    for (state_t state = 1; state < states.size(); ++state) {
+        if (states[state].accepting) {
+            std::cout << state << " ";
+        }
     }
     std::cout << std::endl;
 }
 
 void dfa::init(const tree::regex_tree& tree) {
+    const trace::span span("dfa::init");
+    // 状态 0 为死状态，1 为起始状态
     if (!tree.root) {
-        accept_states.insert(1);
+        table.assign(2, 0);
+        states.resize(2);
+        states[1].accepting = true;
         return;
     }
 
+    // token_map 已按字节划分为互不相交的 token，每个 token 是一个字节类，0 类不命中任何位置
+    const auto& token_map = tree.token_map;
+    const auto& followpos = tree.followpos;
+    const auto end_position = *token_map.at(token::symbol::end_mark).begin();
+
+    std::vector<std::vector<std::size_t>> classes_at(followpos.size());
+    for (const auto& [token, positions] : token_map) {
+        if (token::is(token, token::symbol::end_mark)) {
+            continue;
+        }
+        for (int c = 0; c < 256; ++c) {
+            if (token::match(static_cast<char>(c), token)) {
+                byte_class[c] = static_cast<class_t>(classes);
+            }
+        }
+        for (const auto pos : positions) {
+            classes_at[pos].push_back(classes);
+        }
+        ++classes;
+    }
+
+    // 每个 DFA 状态对应一个位置集合；编号按发现顺序分配，编号本身就是 FIFO 工作队列
+    // unordered_map 的节点地址稳定，sets 直接指向 ids 中的键
+    std::unordered_map<tree::position_set, state_t, tree::position_set_hash> ids;
+    std::vector<const tree::position_set*> sets{nullptr};
+    auto add_state = [&](tree::position_set set) {
+        const auto [it, inserted] = ids.try_emplace(std::move(set), static_cast<state_t>(sets.size()));
+        if (inserted) {
+            sets.push_back(&it->first);
+            table.resize(table.size() + classes, 0);
+            states.push_back({it->first.contains(end_position)});
+        }
+        return it->second;
+    };
+    table.assign(classes, 0);
+    states.resize(1);
+    add_state(tree.root->firstpos);
+
+    // 只计算当前状态中出现过的字节类的转移
+    std::vector<tree::position_set> targets(classes);
+    std::vector<std::size_t> touched;
+    for (state_t id = 1; id < sets.size(); ++id) {
+        for (const auto pos : *sets[id]) {
+            for (const auto cls : classes_at[pos]) {
+                if (targets[cls].empty()) {
+                    touched.push_back(cls);
+                }
+                targets[cls] |= followpos[pos];
+            }
+        }
+        for (const auto cls : touched) {
+            if (auto u = std::exchange(targets[cls], {}); !u.empty()) {
+                const auto to = add_state(std::move(u));
+                table[id * classes + cls] = to;
+            }
+        }
+        touched.clear();
+    }
 
-    std::unordered_set<d_state_t, d_state_t_hash> d_states;
-    size_t cur = 1;
-    d_states.insert({std::unordered_set(tree.root->firstpos.begin(), tree.root->firstpos.end()), cur++});
-    std::unordered_set<d_state_t, d_state_t_hash> unmarked_d_states = d_states;
+    minimize();
+    merge_classes();
+    build_runs();
+}
 
-    std::unordered_set<token_t, token_t_hash> all_tokens;
-    for (const auto& key : tree.token_map | std::views::keys) {
-        all_tokens.insert(key);
+void dfa::minimize() {
+    const auto n = states.size();
+    std::vector<std::vector<std::size_t>> inverse(classes * n);
+    for (std::size_t s = 0; s < n; ++s) {
+        for (std::size_t c = 0; c < classes; ++c) {
+            inverse[c * n + table[s * classes + c]].push_back(s);
+        }
     }
 
-    auto& token_map = tree.token_map;
-    auto& followpos = tree.followpos;
+    // Hopcroft 算法：初始划分为接受状态和其余状态，用待处理的块反复分裂其前驱所在的块
+    std::vector<std::size_t> block(n, 1);
+    std::vector<std::vector<std::size_t>> blocks(2);
+    for (std::size_t s = 0; s < n; ++s) {
+        block[s] = states[s].accepting ? 0 : 1;
+        blocks[block[s]].push_back(s);
+    }
+    if (blocks[0].empty()) {
+        blocks.erase(blocks.begin());
+        std::ranges::fill(block, 0);
+    }
 
-    while (!unmarked_d_states.empty()) {
-        auto [states, id] = *unmarked_d_states.begin();
-        unmarked_d_states.erase(unmarked_d_states.begin());
+    std::vector<std::size_t> work;
+    std::vector<bool> in_work(blocks.size(), true);
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        work.push_back(b);
+    }
+    std::vector<std::vector<std::size_t>> hit(n);
+    std::vector<std::size_t> touched;
+    while (!work.empty()) {
+        const auto splitter = blocks[work.back()];
+        in_work[work.back()] = false;
+        work.pop_back();
 
-        for (const auto& token : all_tokens) {
-            if (token::is(token, token::symbol::end_mark)) {
-                continue;
+        for (std::size_t c = 0; c < classes; ++c) {
+            for (const auto t : splitter) {
+                for (const auto s : inverse[c * n + t]) {
+                    if (hit[block[s]].empty()) {
+                        touched.push_back(block[s]);
+                    }
+                    hit[block[s]].push_back(s);
+                }
+            }
+            for (const auto b : touched) {
+                auto moved = std::move(hit[b]);
+                hit[b].clear();
+                if (moved.size() == blocks[b].size()) {
+                    continue;
+                }
+                const auto fresh = blocks.size();
+                std::ranges::sort(moved);
+                std::vector<std::size_t> rest;
+                std::ranges::set_difference(blocks[b], moved, std::back_inserter(rest));
+                for (const auto s : moved) {
+                    block[s] = fresh;
+                }
+                blocks[b] = std::move(rest);
+                blocks.push_back(std::move(moved));
+                hit.resize(blocks.size());
+                in_work.push_back(false);
+                if (in_work[b] || blocks[fresh].size() <= blocks[b].size()) {
+                    work.push_back(fresh);
+                    in_work[fresh] = true;
+                } else {
+                    work.push_back(b);
+                    in_work[b] = true;
+                }
             }
+            touched.clear();
+        }
+    }
 
-            d_state_t u;
-            for (auto i : token_map.at(token)) {
-                if (states.contains(i)) {
-                    u.states.insert(followpos.at(i).begin(), followpos.at(i).end());
+    // 去掉无法到达接受状态的块，死状态所在的块也在其中
+    std::vector<bool> live(blocks.size(), false);
+    std::vector<std::size_t> pending;
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        if (states[blocks[b].front()].accepting) {
+            live[b] = true;
+            pending.push_back(b);
+        }
+    }
+    while (!pending.empty()) {
+        const auto b = pending.back();
+        pending.pop_back();
+        for (const auto t : blocks[b]) {
+            for (std::size_t c = 0; c < classes; ++c) {
+                for (const auto s : inverse[c * n + t]) {
+                    if (!live[block[s]]) {
+                        live[block[s]] = true;
+                        pending.push_back(block[s]);
+                    }
                 }
             }
+        }
+    }
 
-            if (u.states.empty()) {
+    // 从起始状态出发按字节类顺序重新编号
+    std::vector<state_t> renamed(blocks.size(), 0);
+    std::vector<std::size_t> order{block[1]};
+    renamed[block[1]] = 1;
+    std::vector<state_t> minimized(classes, 0);
+    std::vector<state_info> infos(1);
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        const auto from = blocks[order[k]].front();
+        infos.push_back({states[from].accepting});
+        minimized.resize(minimized.size() + classes, 0);
+        for (std::size_t c = 0; c < classes; ++c) {
+            const auto target = block[table[from * classes + c]];
+            if (!live[target]) {
                 continue;
             }
+            if (renamed[target] == 0) {
+                renamed[target] = static_cast<state_t>(order.size() + 1);
+                order.push_back(target);
+            }
+            minimized[(k + 1) * classes + c] = renamed[target];
+        }
+    }
 
-            if (auto it = d_states.find(u); it == d_states.end()) {
-                u.id = cur++;
-                d_states.insert(u);
-                unmarked_d_states.insert(u);
-            } else {
-                u.id = it->id;
+    table = std::move(minimized);
+    states = std::move(infos);
+}
+
+void dfa::merge_classes() {
+    // 最小化后在所有状态上转移都相同的字节类合并为一类
+    std::map<std::vector<state_t>, class_t> columns;
+    std::vector<class_t> merged(classes);
+    for (std::size_t c = 0; c < classes; ++c) {
+        std::vector<state_t> column;
+        for (std::size_t s = 0; s < states.size(); ++s) {
+            column.push_back(table[s * classes + c]);
+        }
+        merged[c] = columns.try_emplace(std::move(column), static_cast<class_t>(columns.size())).first->second;
+    }
+
+    std::vector<state_t> compact(states.size() * columns.size());
+    for (std::size_t s = 0; s < states.size(); ++s) {
+        for (std::size_t c = 0; c < classes; ++c) {
+            compact[s * columns.size() + merged[c]] = table[s * classes + c];
+        }
+    }
+    for (auto& cls : byte_class) {
+        cls = merged[cls];
+    }
+    classes = columns.size();
+    table = std::move(compact);
+    for (std::size_t s = 0; s < states.size(); ++s) {
+        states[s].final = std::ranges::all_of(table.begin() + s * classes, table.begin() + (s + 1) * classes,
+                                              [](const state_t to) { return to == 0; });
+    }
+}
+
+void dfa::build_runs() {
+    runs.clear();
+    for (state_t state = 1; state < states.size(); ++state) {
+        std::bitset<256> member;
+        for (int c = 0; c < 256; ++c) {
+            if (step(state, static_cast<char>(c)) == state) {
+                member.set(c);
             }
+        }
+        if (member.any()) {
+            states[state].run = static_cast<std::int32_t>(runs.size());
+            runs.push_back(run_class::of(member));
+        }
+    }
+}
+
+run_class run_class::of(const std::bitset<256>& member) {
+    run_class run;
+    run.member = member;
 
-            if (u.states.contains(*token_map.at(token::symbol::end_mark).begin())) {
-                accept_states.insert(u.id);
+    // 把成员或非成员整理成区间，区间少的一方用于 SIMD 比较
+    auto ranges_of = [&](const bool value) {
+        std::vector<std::pair<unsigned char, unsigned char>> result;
+        for (int c = 0; c < 256; ++c) {
+            if (member.test(c) != value) {
+                continue;
             }
+            if (!result.empty() && result.back().second == c - 1) {
+                result.back().second = static_cast<unsigned char>(c);
+            } else {
+                result.emplace_back(c, c);
+            }
+        }
+        return result;
+    };
+    auto ranges = ranges_of(true);
+    if (const auto complement = ranges_of(false); complement.size() < ranges.size()) {
+        ranges = complement;
+        run.negated = true;
+    }
+    if (ranges.size() <= run.ranges.size()) {
+        std::ranges::copy(ranges, run.ranges.begin());
+        run.range_count = ranges.size();
+    }
+    return run;
+}
+
+namespace {
+
+#if !defined(REGEX_SCALAR) && defined(__SSE2__)
+
+// 返回从 pos 开始第一个不在类中的位置，只处理完整的块，剩余部分由调用者逐字节处理
+// c 属于 [lo, lo + span] 当且仅当无符号的 c - lo 不超过 span
+std::size_t skip_sse2(const char* data, std::size_t pos, const std::size_t size,
+                      const std::pair<unsigned char, unsigned char>* ranges, const std::size_t count, const bool negated) {
+    __m128i lo[4];
+    __m128i span[4];
+    for (std::size_t k = 0; k < count; ++k) {
+        lo[k] = _mm_set1_epi8(static_cast<char>(ranges[k].first));
+        span[k] = _mm_set1_epi8(static_cast<char>(ranges[k].second - ranges[k].first));
+    }
+    const unsigned flip = negated ? 0xFFFFu : 0;
+    for (; pos + 16 <= size; pos += 16) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        auto in = _mm_setzero_si128();
+        for (std::size_t k = 0; k < count; ++k) {
+            const auto d = _mm_sub_epi8(v, lo[k]);
+            in = _mm_or_si128(in, _mm_cmpeq_epi8(_mm_min_epu8(d, span[k]), d));
+        }
+        if (const auto bits = (static_cast<unsigned>(_mm_movemask_epi8(in)) ^ flip) & 0xFFFFu; bits != 0xFFFFu) {
+            return pos + std::countr_zero(~bits);
+        }
+    }
+    return pos;
+}
 
-            add_transition(id, token, u.id);
+#if defined(__GNUC__) && defined(__x86_64__)
+#define REGEX_HAS_AVX2_PATH
+
+__attribute__((target("avx2"))) std::size_t skip_avx2(const char* data, std::size_t pos, const std::size_t size,
+                                                      const std::pair<unsigned char, unsigned char>* ranges,
+                                                      const std::size_t count, const bool negated) {
+    __m256i lo[4];
+    __m256i span[4];
+    for (std::size_t k = 0; k < count; ++k) {
+        lo[k] = _mm256_set1_epi8(static_cast<char>(ranges[k].first));
+        span[k] = _mm256_set1_epi8(static_cast<char>(ranges[k].second - ranges[k].first));
+    }
+    const unsigned flip = negated ? 0xFFFFFFFFu : 0;
+    for (; pos + 32 <= size; pos += 32) {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        auto in = _mm256_setzero_si256();
+        for (std::size_t k = 0; k < count; ++k) {
+            const auto d = _mm256_sub_epi8(v, lo[k]);
+            in = _mm256_or_si256(in, _mm256_cmpeq_epi8(_mm256_min_epu8(d, span[k]), d));
+        }
+        if (const auto bits = static_cast<unsigned>(_mm256_movemask_epi8(in)) ^ flip; bits != 0xFFFFFFFFu) {
+            return pos + std::countr_zero(~bits);
+        }
+    }
+    return pos;
+}
+
+#endif
+#endif
+
+} // namespace
+
+std::size_t run_class::skip(const std::string_view str, std::size_t pos) const {
+#if !defined(REGEX_SCALAR) && defined(__SSE2__)
+    if (range_count > 0) {
+#ifdef REGEX_HAS_AVX2_PATH
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        if (avx2) {
+            pos = skip_avx2(str.data(), pos, str.size(), ranges.data(), range_count, negated);
         }
+#endif
+        pos = skip_sse2(str.data(), pos, str.size(), ranges.data(), range_count, negated);
+    }
+#endif
+    while (pos < str.size() && member.test(static_cast<unsigned char>(str[pos]))) {
+        ++pos;
     }
+    return pos;
 }
 
 } // namespace regex::dfa
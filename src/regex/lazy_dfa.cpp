@@ -0,0 +1,148 @@
+#include "regex/lazy_dfa.hpp"
+
+namespace regex::dfa {
+
+lazy_dfa::lazy_dfa(const tree::regex_tree& tree, const std::size_t cache_bytes)
+    : cache_bytes(cache_bytes) {
+    init(tree);
+}
+
+lazy_dfa::lazy_dfa(const std::string& regex, const std::size_t cache_bytes)
+    : cache_bytes(cache_bytes) {
+    const tree::regex_tree tree(regex);
+    init(tree);
+}
+
+void lazy_dfa::init(const tree::regex_tree& tree) {
+    // 第 0 类不命中任何位置
+    class_positions.emplace_back();
+    if (tree.root) {
+        followpos = tree.followpos;
+        start_set = tree.root->firstpos;
+        end_position = *tree.token_map.at(token::symbol::end_mark).begin();
+        // token_map 已按字节划分为互不相交的 token，每个 token 就是一个字节类
+        for (const auto& [token, positions] : tree.token_map) {
+            if (token::is(token, token::symbol::end_mark)) {
+                continue;
+            }
+            for (int c = 0; c < 256; ++c) {
+                if (token::match(static_cast<char>(c), token)) {
+                    byte_class[c] = static_cast<std::uint8_t>(class_positions.size());
+                }
+            }
+            class_positions.push_back(positions);
+        }
+    } else {
+        start_set.insert(end_position);
+    }
+    // 转移表一行、位置集合本身和哈希表节点的大致开销
+    state_bytes = class_positions.size() * sizeof(state_t) + (followpos.size() / 64 + 1) * 8 + 64;
+    flush();
+    cache.flushes = 0;
+}
+
+void lazy_dfa::flush() const {
+    cache.ids.clear();
+    cache.sets.clear();
+    cache.flags.clear();
+    cache.next.clear();
+    ++cache.flushes;
+    add_state({});
+    add_state(start_set);
+}
+
+lazy_dfa::state_t lazy_dfa::add_state(tree::position_set set) const {
+    const auto [it, inserted] = cache.ids.try_emplace(std::move(set), static_cast<state_t>(cache.sets.size()));
+    if (!inserted) {
+        return it->second;
+    }
+    const auto& positions = it->first;
+    std::uint8_t flags = 0;
+    if (positions.contains(end_position)) {
+        flags |= accepting;
+    }
+    if ((flags & accepting) != 0 && positions.size() == 1) {
+        flags |= final;
+    }
+    cache.sets.push_back(&positions);
+    cache.flags.push_back(flags);
+    cache.next.resize(cache.next.size() + class_positions.size(), unknown);
+    return it->second;
+}
+
+lazy_dfa::state_t lazy_dfa::step(const state_t from, const char ch) const {
+    const auto cls = byte_class[static_cast<unsigned char>(ch)];
+    if (const auto to = cache.next[from * class_positions.size() + cls]; to != unknown) {
+        return to;
+    }
+
+    tree::position_set target;
+    if (cls != 0) {
+        for (const auto pos : *cache.sets[from]) {
+            if (class_positions[cls].contains(pos)) {
+                target |= followpos[pos];
+            }
+        }
+    }
+    if (!cache.ids.contains(target) && (cache.sets.size() + 1) * state_bytes > cache_bytes) {
+        // 清空后 from 不再有效，只需要从新建的目标状态继续
+        flush();
+        return add_state(std::move(target));
+    }
+    const auto to = add_state(std::move(target));
+    cache.next[from * class_positions.size() + cls] = to;
+    return to;
+}
+
+bool lazy_dfa::match(const std::string& str) const {
+    const std::lock_guard lock(mutex);
+    state_t current = start;
+    for (const auto ch : str) {
+        current = step(current, ch);
+        if (current == dead) {
+            return false;
+        }
+    }
+    return (cache.flags[current] & accepting) != 0;
+}
+
+std::size_t lazy_dfa::match_max(const std::string& str) const {
+    std::size_t scanned;
+    return match_max(str, scanned);
+}
+
+std::size_t lazy_dfa::match_max(const std::string_view str, std::size_t& scanned) const {
+    const std::lock_guard lock(mutex);
+    state_t current = start;
+    std::size_t last_accept_pos = 0;
+    scanned = str.size() + 1;
+
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        if ((cache.flags[current] & final) != 0) {
+            scanned = i;
+            break;
+        }
+        current = step(current, str[i]);
+        if (current == dead) {
+            scanned = i + 1;
+            break;
+        }
+        if ((cache.flags[current] & accepting) != 0) {
+            last_accept_pos = i + 1;
+        }
+    }
+
+    return last_accept_pos;
+}
+
+std::size_t lazy_dfa::cached_states() const {
+    const std::lock_guard lock(mutex);
+    return cache.sets.size();
+}
+
+std::size_t lazy_dfa::flushes() const {
+    const std::lock_guard lock(mutex);
+    return cache.flushes;
+}
+
+} // namespace regex::dfa
@@ -0,0 +1,91 @@
+#include "regex/position_set.hpp"
+
+#include <algorithm>
+
+namespace regex::tree {
+
+position_set::iterator::iterator(const std::vector<word_t>* words, const std::size_t index)
+    : words(words), index(index) {
+    settle();
+}
+
+void position_set::iterator::settle() {
+    if (rest == 0) {
+        while (index < words->size() && (*words)[index] == 0) {
+            ++index;
+        }
+        rest = index < words->size() ? (*words)[index] : 0;
+    }
+}
+
+position_set::iterator& position_set::iterator::operator++() {
+    rest &= rest - 1;
+    if (rest == 0) {
+        ++index;
+        settle();
+    }
+    return *this;
+}
+
+position_set::iterator position_set::iterator::operator++(int) {
+    auto old = *this;
+    ++*this;
+    return old;
+}
+
+void position_set::insert(const std::size_t pos) {
+    const auto index = pos / word_bits;
+    if (index >= words.size()) {
+        words.resize(index + 1, 0);
+    }
+    words[index] |= word_t{1} << pos % word_bits;
+}
+
+bool position_set::contains(const std::size_t pos) const {
+    const auto index = pos / word_bits;
+    return index < words.size() && (words[index] >> pos % word_bits & 1) != 0;
+}
+
+std::size_t position_set::size() const {
+    std::size_t count = 0;
+    for (const auto word : words) {
+        count += std::popcount(word);
+    }
+    return count;
+}
+
+bool position_set::intersects(const position_set& other) const {
+    const auto n = std::min(words.size(), other.words.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        if ((words[i] & other.words[i]) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+position_set& position_set::operator|=(const position_set& other) {
+    if (other.words.size() > words.size()) {
+        words.resize(other.words.size(), 0);
+    }
+    for (std::size_t i = 0; i < other.words.size(); ++i) {
+        words[i] |= other.words[i];
+    }
+    return *this;
+}
+
+std::size_t position_set::hash() const {
+    // 逐字 rotate-xor-multiply 混合，再做一次 splitmix 收尾
+    std::uint64_t h = words.size();
+    for (const auto word : words) {
+        h = (std::rotl(h, 5) ^ word) * 0x9e3779b97f4a7c15ULL;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return static_cast<std::size_t>(h);
+}
+
+} // namespace regex::tree
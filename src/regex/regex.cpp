@@ -1,15 +1,243 @@
 #include "regex/regex.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
 namespace regex {
 
-regex::regex(const std::string& regex) : dfa_(regex) {}
+// 从右往左读入文本的自动机，状态为向左再读到其中某个位置即可继续组成匹配的位置集合
+// 每一步都补入 r 的 lastpos，即右侧接 Σ* 的非锚定搜索；读入一个字节后状态含 r 的 firstpos 时，该字节处可以开始一个非空匹配
+// 状态按需构建并缓存，超过上限时整体清空，与 lazy_dfa 相同
+class regex::start_finder {
+public:
+    explicit start_finder(const tree::regex_tree& tree);
+
+    // text 中不小于 from 的最左匹配起点
+    std::optional<std::size_t> leftmost(std::string_view text, std::size_t from) const;
+
+private:
+    using state_t = std::uint32_t;
+
+    static constexpr state_t unknown = UINT32_MAX;
+    static constexpr std::size_t max_states = 4096;
+
+    std::array<std::uint8_t, 256> byte_class{};
+    std::vector<tree::position_set> class_positions;
+    // pred[q] 为 followpos 含 q 的位置
+    std::vector<tree::position_set> pred;
+    tree::position_set last;
+    tree::position_set first;
+
+    mutable std::mutex mutex;
+    mutable std::unordered_map<tree::position_set, state_t, tree::position_set_hash> ids;
+    mutable std::vector<const tree::position_set*> sets;
+    mutable std::vector<bool> starts;
+    mutable std::vector<state_t> next;
+
+    void flush() const;
+    state_t add_state(tree::position_set set) const;
+    state_t step(state_t from, char ch) const;
+};
+
+regex::start_finder::start_finder(const tree::regex_tree& tree) {
+    // 第 0 类不命中任何位置
+    class_positions.emplace_back();
+    if (tree.root) {
+        const auto end_position = *tree.token_map.at(token::symbol::end_mark).begin();
+        for (const auto& [token, positions] : tree.token_map) {
+            if (token::is(token, token::symbol::end_mark)) {
+                continue;
+            }
+            for (int c = 0; c < 256; ++c) {
+                if (token::match(static_cast<char>(c), token)) {
+                    byte_class[c] = static_cast<std::uint8_t>(class_positions.size());
+                }
+            }
+            class_positions.push_back(positions);
+        }
+        pred.resize(tree.followpos.size());
+        for (std::size_t p = 1; p < tree.followpos.size(); ++p) {
+            for (const auto q : tree.followpos[p]) {
+                if (q == end_position) {
+                    last.insert(p);
+                } else {
+                    pred[q].insert(p);
+                }
+            }
+        }
+        for (const auto p : tree.root->firstpos) {
+            if (p != end_position) {
+                first.insert(p);
+            }
+        }
+    }
+    flush();
+}
+
+void regex::start_finder::flush() const {
+    ids.clear();
+    sets.clear();
+    starts.clear();
+    next.clear();
+    add_state({});
+}
+
+regex::start_finder::state_t regex::start_finder::add_state(tree::position_set set) const {
+    const auto [it, inserted] = ids.try_emplace(std::move(set), static_cast<state_t>(sets.size()));
+    if (inserted) {
+        sets.push_back(&it->first);
+        starts.push_back(it->first.intersects(first));
+        next.resize(next.size() + class_positions.size(), unknown);
+    }
+    return it->second;
+}
+
+regex::start_finder::state_t regex::start_finder::step(const state_t from, const char ch) const {
+    const auto cls = byte_class[static_cast<unsigned char>(ch)];
+    if (const auto to = next[from * class_positions.size() + cls]; to != unknown) {
+        return to;
+    }
+
+    tree::position_set target;
+    const auto& matching = class_positions[cls];
+    auto collect = [&](const tree::position_set& candidates) {
+        for (const auto p : candidates) {
+            if (matching.contains(p)) {
+                target.insert(p);
+            }
+        }
+    };
+    if (cls != 0) {
+        collect(last);
+        for (const auto q : *sets[from]) {
+            collect(pred[q]);
+        }
+    }
+    if (!ids.contains(target) && sets.size() >= max_states) {
+        flush();
+        return add_state(std::move(target));
+    }
+    const auto to = add_state(std::move(target));
+    next[from * class_positions.size() + cls] = to;
+    return to;
+}
+
+std::optional<std::size_t> regex::start_finder::leftmost(const std::string_view text, const std::size_t from) const {
+    const std::lock_guard lock(mutex);
+    std::optional<std::size_t> found;
+    state_t current = 0;
+    for (auto i = text.size(); i-- > from;) {
+        current = step(current, text[i]);
+        if (starts[current]) {
+            found = i;
+        }
+    }
+    return found;
+}
+
+regex::regex(const std::string& regex) {
+    const tree::regex_tree tree(regex);
+    if (tree.followpos.size() > lazy_positions) {
+        lazy_ = std::make_shared<const dfa::lazy_dfa>(tree);
+    } else {
+        dfa_.emplace(tree);
+    }
+    init_prefilter(tree);
+    starts_ = std::make_shared<const start_finder>(tree);
+}
+
+regex::regex(const std::string& regex, const lazy mode) {
+    const tree::regex_tree tree(regex);
+    lazy_ = std::make_shared<const dfa::lazy_dfa>(tree, mode.cache_bytes);
+    init_prefilter(tree);
+    starts_ = std::make_shared<const start_finder>(tree);
+}
+
+void regex::init_prefilter(const tree::regex_tree& tree) {
+    for (const auto& [token, positions] : tree.token_map) {
+        if (token::is(token, token::symbol::end_mark) || !positions.intersects(tree.root->firstpos)) {
+            continue;
+        }
+        for (int c = 0; c < 256; ++c) {
+            if (token::match(static_cast<char>(c), token)) {
+                first_bytes.set(c);
+            }
+        }
+    }
+    non_first = dfa::run_class::of(~first_bytes);
+    if (first_bytes.count() == 1) {
+        for (int c = 0; c < 256; ++c) {
+            if (first_bytes.test(c)) {
+                first_byte = c;
+            }
+        }
+    }
+}
 
 bool regex::match(const std::string& str) const {
-    return dfa_.match(str);
+    return lazy_ ? lazy_->match(str) : dfa_->match(str);
 }
 
 std::size_t regex::match_max(const std::string& str) const {
-    return dfa_.match_max(str);
+    return lazy_ ? lazy_->match_max(str) : dfa_->match_max(str);
+}
+
+std::size_t regex::match_max(const std::string_view str, std::size_t& scanned) const {
+    return lazy_ ? lazy_->match_max(str, scanned) : dfa_->match_max(str, scanned);
+}
+
+std::size_t regex::next_candidate(const std::string_view text, const std::size_t pos) const {
+    if (pos >= text.size()) {
+        return text.size();
+    }
+    if (first_byte >= 0) {
+        const auto* found = std::memchr(text.data() + pos, first_byte, text.size() - pos);
+        return found == nullptr ? text.size() : static_cast<const char*>(found) - text.data();
+    }
+    return non_first.skip(text, pos);
+}
+
+std::optional<match_result> regex::find(const std::string_view text, std::size_t from) const {
+    // 失败的锚定匹配读过的字节数超过剩余文本长度的常数倍后，改为反向扫描一次直接找到最左起点，
+    // 否则像 a*b 在一长串 a 上这样每个起点都读到末尾的情况会退化为平方时间
+    auto budget = 2 * (text.size() - std::min(from, text.size())) + 64;
+    for (from = next_candidate(text, from); from < text.size(); from = next_candidate(text, from + 1)) {
+        std::size_t scanned;
+        if (const auto length = match_max(text.substr(from), scanned); length > 0) {
+            return match_result{from, length};
+        }
+        const auto cost = std::min(scanned, text.size() - from);
+        if (cost <= budget) {
+            budget -= cost;
+            continue;
+        }
+        const auto start = starts_->leftmost(text, from + 1);
+        if (!start) {
+            return std::nullopt;
+        }
+        return match_result{*start, match_max(text.substr(*start), scanned)};
+    }
+    return std::nullopt;
+}
+
+std::vector<match_result> regex::find_all(const std::string_view text) const {
+    std::vector<match_result> result;
+    for (auto found = find(text); found; found = find(text, found->position + found->length)) {
+        result.push_back(*found);
+    }
+    return result;
+}
+
+bool regex::is_lazy() const {
+    return lazy_ != nullptr;
+}
+
+std::size_t regex::state_count() const {
+    return lazy_ ? lazy_->cached_states() : dfa_->state_count();
 }
 
 } // namespace regex
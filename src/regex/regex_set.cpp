@@ -0,0 +1,142 @@
+#include "regex/regex_set.hpp"
+#include "regex/exception.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <unordered_map>
+
+namespace regex {
+
+namespace {
+
+struct tuple_hash {
+    std::size_t operator()(const std::vector<std::uint32_t>& tuple) const {
+        std::uint64_t h = tuple.size();
+        for (const auto v : tuple) {
+            h = (std::rotl(h, 5) ^ v) * 0x9e3779b97f4a7c15ULL;
+        }
+        return static_cast<std::size_t>(h ^ h >> 32);
+    }
+};
+
+} // namespace
+
+regex_set::regex_set(const std::vector<std::string>& patterns)
+    : patterns(patterns.size()), words((patterns.size() + 63) / 64) {
+    std::vector<dfa::dfa> dfas;
+    dfas.reserve(patterns.size());
+    for (const auto& pattern : patterns) {
+        dfas.emplace_back(pattern);
+    }
+
+    // 所有模式都不区分的字节归为同一类
+    std::vector<std::size_t> state_counts;
+    for (const auto& d : dfas) {
+        state_counts.push_back(d.state_count());
+    }
+    std::map<std::vector<std::uint32_t>, std::uint32_t> signatures;
+    std::vector<char> representative;
+    for (int c = 0; c < 256; ++c) {
+        std::vector<std::uint32_t> signature;
+        for (std::size_t k = 0; k < dfas.size(); ++k) {
+            for (std::size_t s = 1; s <= state_counts[k]; ++s) {
+                signature.push_back(dfas[k].next(static_cast<dfa::dfa::state_t>(s), static_cast<char>(c)));
+            }
+        }
+        const auto [it, inserted] = signatures.try_emplace(std::move(signature), static_cast<std::uint32_t>(representative.size()));
+        if (inserted) {
+            representative.push_back(static_cast<char>(c));
+        }
+        byte_class[c] = it->second;
+    }
+    classes = representative.size();
+    if (dfas.empty()) {
+        // 没有模式时起始状态与死状态相同，仍保留两个状态使 start 有效
+        table.assign(2 * classes, dead);
+        return;
+    }
+
+    // 乘积状态是各模式当前状态组成的元组，0 号为全部死亡，1 号为起始
+    std::unordered_map<std::vector<std::uint32_t>, state_t, tuple_hash> ids;
+    std::vector<const std::vector<std::uint32_t>*> tuples;
+    auto add = [&](std::vector<std::uint32_t> tuple) {
+        const auto [it, inserted] = ids.try_emplace(std::move(tuple), static_cast<state_t>(tuples.size()));
+        if (inserted) {
+            if (tuples.size() >= max_states) {
+                throw invalid_regex_exception("regex_set needs more than " + std::to_string(max_states) + " states");
+            }
+            tuples.push_back(&it->first);
+            table.resize(table.size() + classes, dead);
+            accepting.resize(accepting.size() + words, 0);
+            for (std::size_t k = 0; k < dfas.size(); ++k) {
+                if (const auto s = it->first[k]; s != 0 && dfas[k].accepts(s)) {
+                    accepting[it->second * words + k / 64] |= std::uint64_t{1} << k % 64;
+                }
+            }
+        }
+        return it->second;
+    };
+    add(std::vector<std::uint32_t>(dfas.size(), 0));
+    add(std::vector<std::uint32_t>(dfas.size(), 1));
+
+    for (state_t id = start; id < tuples.size(); ++id) {
+        for (std::size_t cls = 0; cls < classes; ++cls) {
+            std::vector<std::uint32_t> next(dfas.size());
+            for (std::size_t k = 0; k < dfas.size(); ++k) {
+                if (const auto s = (*tuples[id])[k]; s != 0) {
+                    next[k] = dfas[k].next(s, representative[cls]);
+                }
+            }
+            const auto to = add(std::move(next));
+            table[id * classes + cls] = to;
+        }
+    }
+}
+
+regex_set::state_t regex_set::run(const std::string_view str) const {
+    state_t current = start;
+    for (const auto ch : str) {
+        current = table[current * classes + byte_class[static_cast<unsigned char>(ch)]];
+        if (current == dead) {
+            break;
+        }
+    }
+    return current;
+}
+
+std::vector<std::size_t> regex_set::match(const std::string_view str) const {
+    std::vector<std::size_t> out;
+    match(str, out);
+    return out;
+}
+
+void regex_set::match(const std::string_view str, std::vector<std::size_t>& out) const {
+    out.clear();
+    const auto state = run(str);
+    for (std::size_t w = 0; w < words; ++w) {
+        for (auto bits = accepting[state * words + w]; bits != 0; bits &= bits - 1) {
+            out.push_back(w * 64 + std::countr_zero(bits));
+        }
+    }
+}
+
+bool regex_set::match_any(const std::string_view str) const {
+    const auto state = run(str);
+    for (std::size_t w = 0; w < words; ++w) {
+        if (accepting[state * words + w] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t regex_set::size() const {
+    return patterns;
+}
+
+std::size_t regex_set::state_count() const {
+    return table.size() / std::max<std::size_t>(classes, 1);
+}
+
+} // namespace regex
@@ -2,6 +2,8 @@
 #include "regex/exception.hpp"
 
 #include <cctype>
+#include <limits>
+#include <optional>
 #include <set>
 #include <stack>
 #include <stdexcept>
@@ -19,12 +21,7 @@ std::size_t token_type_hash::operator()(const token_type& t) const {
         return std::hash<int>{}(static_cast<int>(std::get<op>(t)));
     }
     if (std::holds_alternative<char_set>(t)) {
-        std::size_t hash = 0;
-        const auto& set = std::get<char_set>(t);
-        for (const auto& ch : set.chars) {
-            hash ^= std::hash<char>{}(ch);
-        }
-        return hash;
+        return std::get<char_set>(t).hash();
     }
     return 0;
 }
@@ -32,7 +29,8 @@ std::size_t token_type_hash::operator()(const token_type& t) const {
 int get_precedence(op opr) {
     switch (opr) {
     case op::star:
-    case op::plus: return 3;
+    case op::plus:
+    case op::optional: return 3;
     case op::concat: return 2;
     case op::alt: return 1;
     case op::left_par:
@@ -73,11 +71,7 @@ bool match(char c, const token_type& ch) {
         return std::get<char>(ch) == c;
     }
     if (is_char_set(ch)) {
-        if (const auto& set = std::get<char_set>(ch); set.is_negative) {
-            return !set.chars.contains(c);
-        } else {
-            return set.chars.contains(c);
-        }
+        return std::get<char_set>(ch).matches(c);
     }
     return false;
 }
@@ -90,6 +84,112 @@ bool is_nonop(const token_type& ch) {
     return is_char(ch) || is_symbol(ch) || is_char_set(ch);
 }
 
+namespace {
+
+constexpr std::size_t max_repeat = 1000;
+constexpr std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+
+struct repeat_count {
+    std::size_t min;
+    std::size_t max;
+    std::string::const_iterator last;
+};
+
+// 解析从 '{' 开始的 {m}、{m,}、{m,n}，格式不符时返回空，'{' 仍按普通字符处理
+std::optional<repeat_count> parse_repeat(std::string::const_iterator it, const std::string::const_iterator end) {
+    auto number = [&](std::size_t& value) {
+        const auto begin = it;
+        value = 0;
+        while (it != end && std::isdigit(static_cast<unsigned char>(*it))) {
+            value = std::min(value * 10 + (*it - '0'), max_repeat + 1);
+            ++it;
+        }
+        return it != begin;
+    };
+
+    repeat_count count{};
+    ++it;
+    if (!number(count.min)) {
+        return std::nullopt;
+    }
+    count.max = count.min;
+    if (it != end && *it == ',') {
+        ++it;
+        if (!number(count.max)) {
+            count.max = unbounded;
+        }
+    }
+    if (it == end || *it != '}') {
+        return std::nullopt;
+    }
+    if (count.max == 0 || count.max < count.min) {
+        throw regex::invalid_regex_exception("invalid repetition count");
+    }
+    if (count.min > max_repeat || (count.max != unbounded && count.max > max_repeat)) {
+        throw regex::invalid_regex_exception("repetition count exceeds " + std::to_string(max_repeat));
+    }
+    count.last = it;
+    return count;
+}
+
+// 把 result 末尾的操作数 X 替换为 X{min,max} 的展开：
+// min 份 X 依次连接，其后是 (X(X(X)?)?)? 形式的嵌套可选部分或 X*，大小与 max 成线性关系
+void expand_repeat(std::vector<token_type>& result, const std::size_t min, const std::size_t max) {
+    auto begin = result.size() - 1;
+    while (is(result[begin], op::star) || is(result[begin], op::plus) || is(result[begin], op::optional)) {
+        --begin;
+    }
+    if (is(result[begin], op::right_par)) {
+        for (int depth = 0;; --begin) {
+            depth += is(result[begin], op::right_par) ? 1 : is(result[begin], op::left_par) ? -1 : 0;
+            if (depth == 0) {
+                break;
+            }
+        }
+    }
+    const std::vector operand(result.begin() + static_cast<std::ptrdiff_t>(begin), result.end());
+    result.resize(begin);
+
+    auto append_operand = [&] {
+        result.emplace_back(op::left_par);
+        result.insert(result.end(), operand.begin(), operand.end());
+        result.emplace_back(op::right_par);
+    };
+
+    result.emplace_back(op::left_par);
+    for (std::size_t i = 0; i < min; ++i) {
+        if (i > 0) {
+            result.emplace_back(op::concat);
+        }
+        append_operand();
+    }
+    if (max == unbounded) {
+        if (min > 0) {
+            result.emplace_back(op::concat);
+        }
+        append_operand();
+        result.emplace_back(op::star);
+    } else if (max > min) {
+        if (min > 0) {
+            result.emplace_back(op::concat);
+        }
+        for (std::size_t i = min; i < max; ++i) {
+            result.emplace_back(op::left_par);
+            append_operand();
+            if (i + 1 < max) {
+                result.emplace_back(op::concat);
+            }
+        }
+        for (std::size_t i = min; i < max; ++i) {
+            result.emplace_back(op::right_par);
+            result.emplace_back(op::optional);
+        }
+    }
+    result.emplace_back(op::right_par);
+}
+
+} // namespace
+
 std::vector<token_type> split(const std::string& s) {
     std::vector<token_type> result{op::left_par};
     token_type last = nothing{};
@@ -99,6 +199,15 @@ std::vector<token_type> split(const std::string& s) {
     char_set current_set;
     for (auto it = s.begin(); it != s.end(); ++it) {
         const char& ch = *it;
+        if (!in_char_set && ch == '{'
+            && (is_char(last) || is_symbol(last) || is_char_set(last) || is(last, op::right_par) || is(last, op::star) || is(last, op::plus))) {
+            if (const auto count = parse_repeat(it, s.end())) {
+                expand_repeat(result, count->min, count->max);
+                it = count->last;
+                last = op::right_par;
+                continue;
+            }
+        }
         if (is_char(last) || is_symbol(last) || is_char_set(last) || is(last, op::right_par) || is(last, op::star) || is(last, op::plus)) {
             if (!in_char_set && (is_nonop(ch) || ch == '(' || ch == '\\' || ch == '[')) {
                 result.emplace_back(op::concat);
@@ -250,7 +359,7 @@ std::vector<token_type> to_postfix(const std::vector<token_type>& v) {
                 ops.pop();
             }
             ops.push(ch);
-        } else if (is(ch, op::star) || is(ch, op::plus) || is(ch, op::left_par)) {
+        } else if (is(ch, op::star) || is(ch, op::plus) || is(ch, op::optional) || is(ch, op::left_par)) {
             ops.push(ch);
         } else {
             throw regex::unknown_character_exception(std::string{std::get<char>(ch)});
@@ -290,16 +399,20 @@ std::ostream& operator<<(std::ostream& os, const token_type& ch) {
         const auto& set = std::get<char_set>(ch);
         std::set<char> new_chars;
         bool is_negative = set.is_negative;
-        if (set.chars.size() > 128 / 2) {
+        if (set.size() > 128 / 2) {
             is_negative = !is_negative;
             for (int i = 0; i < 128; ++i) {
                 char c = static_cast<char>(i);
-                if (!set.chars.contains(c)) {
+                if (!set.contains(c)) {
                     new_chars.insert(c);
                 }
             }
         } else {
-            new_chars.insert(set.chars.begin(), set.chars.end());
+            for (int i = -128; i < 128; ++i) {
+                if (set.contains(static_cast<char>(i))) {
+                    new_chars.insert(static_cast<char>(i));
+                }
+            }
         }
         if (is_negative) {
             os << "[^";
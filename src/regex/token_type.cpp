@@ -1,5 +1,7 @@
 #include "regex/token_type.hpp"
 
+#include <bit>
+
 namespace regex::token {
 
 const std::unordered_map<symbol, std::string> symbol_map = {
@@ -11,6 +13,7 @@ const std::unordered_map<op, std::string> op_map = {
     {op::alt, "|"},
     {op::star, "*"},
     {op::plus, "+"},
+    {op::optional, "?"},
     {op::left_par, "("},
     {op::right_par, ")"},
     {op::backslash, "\\"}
@@ -20,15 +23,13 @@ char_set::char_set() : is_negative(false) {}
 
 char_set::char_set(const char from, const char to, const bool is_negative)
     : is_negative(is_negative) {
-    for (char ch = from; ch <= to; ++ch) {
-        chars.insert(ch);
-    }
+    add(from, to);
 }
 
 char_set::char_set(const std::initializer_list<char> init, bool is_negative)
     : is_negative(is_negative) {
     for (const auto& ch : init) {
-        chars.insert(ch);
+        add(ch);
     }
 }
 
@@ -40,21 +41,57 @@ char_set::char_set(std::initializer_list<std::pair<char, char>> init, const bool
 }
 
 void char_set::add(const char ch) {
-    chars.insert(ch);
+    const auto c = static_cast<unsigned char>(ch);
+    bits[c >> 6] |= std::uint64_t{1} << (c & 63);
 }
 
 void char_set::add(const char_set& other) {
-    chars.insert(other.chars.begin(), other.chars.end());
+    *this |= other;
 }
 
 void char_set::add(const char from, const char to) {
-    for (char ch = from; ch <= to; ++ch) {
-        chars.insert(ch);
+    for (int ch = from; ch <= to; ++ch) {
+        add(static_cast<char>(ch));
+    }
+}
+
+std::size_t char_set::size() const {
+    std::size_t count = 0;
+    for (const auto word : bits) {
+        count += std::popcount(word);
     }
+    return count;
 }
 
-bool char_set::operator==(const char_set& other) const {
-    return chars == other.chars && is_negative == other.is_negative;
+std::size_t char_set::hash() const {
+    std::uint64_t h = is_negative ? 0x9e3779b97f4a7c15ULL : 0;
+    for (const auto word : bits) {
+        h = (std::rotl(h, 5) ^ word) * 0x9e3779b97f4a7c15ULL;
+    }
+    h ^= h >> 32;
+    return static_cast<std::size_t>(h);
+}
+
+char_set& char_set::operator|=(const char_set& other) {
+    for (std::size_t i = 0; i < bits.size(); ++i) {
+        bits[i] |= other.bits[i];
+    }
+    return *this;
+}
+
+char_set& char_set::operator&=(const char_set& other) {
+    for (std::size_t i = 0; i < bits.size(); ++i) {
+        bits[i] &= other.bits[i];
+    }
+    return *this;
+}
+
+char_set char_set::operator~() const {
+    auto result = *this;
+    for (auto& word : result.bits) {
+        word = ~word;
+    }
+    return result;
 }
 
 const char_set words{{'a', 'z'}, {'A', 'Z'}, {'0', '9'}, {'_', '_'}};
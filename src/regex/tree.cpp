@@ -1,6 +1,8 @@
 #include "regex/tree.hpp"
 #include "regex/exception.hpp"
 
+#include <algorithm>
+#include <array>
 #include <stack>
 #include <utility>
 
@@ -14,21 +16,21 @@ char_node::char_node(token::token_type ch, const std::size_t number)
     lastpos.insert(number);
 }
 
-concat_node::concat_node(const node_ptr_t& left, const node_ptr_t& right)
+concat_node::concat_node(const node_ptr_t left, const node_ptr_t right)
     : left(left), right(right) {
     type = type::concat;
     nullable = left->nullable && right->nullable;
     firstpos = left->firstpos;
     if (left->nullable) {
-        firstpos.insert(right->firstpos.begin(), right->firstpos.end());
+        firstpos |= right->firstpos;
     }
     lastpos = right->lastpos;
     if (right->nullable) {
-        lastpos.insert(left->lastpos.begin(), left->lastpos.end());
+        lastpos |= left->lastpos;
     }
 }
 
-star_node::star_node(const node_ptr_t& child)
+star_node::star_node(const node_ptr_t child)
     : child(child) {
     type = type::star;
     nullable = true;
@@ -36,7 +38,7 @@ star_node::star_node(const node_ptr_t& child)
     lastpos = child->lastpos;
 }
 
-plus_node::plus_node(const node_ptr_t& child)
+plus_node::plus_node(const node_ptr_t child)
     : child(child) {
     type = type::plus;
     nullable = child->nullable;
@@ -44,19 +46,41 @@ plus_node::plus_node(const node_ptr_t& child)
     lastpos = child->lastpos;
 }
 
-alt_node::alt_node(const node_ptr_t& left, const node_ptr_t& right)
+optional_node::optional_node(const node_ptr_t child)
+    : child(child) {
+    type = type::optional;
+    nullable = true;
+    firstpos = child->firstpos;
+    lastpos = child->lastpos;
+}
+
+alt_node::alt_node(const node_ptr_t left, const node_ptr_t right)
     : left(left), right(right) {
     type = type::alt;
     nullable = left->nullable || right->nullable;
     firstpos = left->firstpos;
-    firstpos.insert(right->firstpos.begin(), right->firstpos.end());
+    firstpos |= right->firstpos;
     lastpos = left->lastpos;
-    lastpos.insert(right->lastpos.begin(), right->lastpos.end());
+    lastpos |= right->lastpos;
+}
+
+template <class T, class... Args>
+T* regex_tree::make(Args&&... args) {
+    nodes.reserve(nodes.size() + 1);
+    auto* node = new (arena->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    nodes.push_back(node);
+    return node;
 }
 
 regex_tree::regex_tree(regex_node& root)
     : root(&root) {}
 
+regex_tree::~regex_tree() {
+    for (auto* node : nodes) {
+        node->~regex_node();
+    }
+}
+
 regex_tree::regex_tree(const std::string& s) {
     if (s.empty()) {
         return;
@@ -71,10 +95,22 @@ regex_tree::regex_tree(const std::string& s) {
     ::regex::token::print(postfix);
 #endif
 
+    constexpr auto node_size = std::max({sizeof(char_node), sizeof(concat_node), sizeof(alt_node)});
+    arena = std::make_unique<std::pmr::monotonic_buffer_resource>(postfix.size() * node_size);
+    nodes.reserve(postfix.size());
+    followpos.resize(1);
+
     std::stack<regex_node::node_ptr_t> st;
 
     size_t i = 1;
 
+    // 构造节点的同时计算 followpos，子节点的位置集合只在这时读取一次
+    auto follow = [&](const position_set& from, const position_set& to) {
+        for (const auto idx : from) {
+            followpos[idx] |= to;
+        }
+    };
+
     using token::op;
 
     for (const auto& ch : postfix) {
@@ -84,14 +120,23 @@ regex_tree::regex_tree(const std::string& s) {
             }
             auto operand = st.top();
             st.pop();
-            st.push(std::make_shared<star_node>(operand));
+            st.push(make<star_node>(operand));
+            follow(operand->lastpos, operand->firstpos);
         } else if (token::is(ch, op::plus)) {
             if (st.empty()) {
                 throw regex::invalid_regex_exception("'+' operator with empty stack");
             }
             auto operand = st.top();
             st.pop();
-            st.push(std::make_shared<plus_node>(operand));
+            st.push(make<plus_node>(operand));
+            follow(operand->lastpos, operand->firstpos);
+        } else if (token::is(ch, op::optional)) {
+            if (st.empty()) {
+                throw regex::invalid_regex_exception("'?' operator with empty stack");
+            }
+            auto operand = st.top();
+            st.pop();
+            st.push(make<optional_node>(operand));
         } else if (token::is(ch, op::concat)) {
             if (st.size() < 2) {
                 throw regex::invalid_regex_exception("'·' operator with fewer than 2 operands");
@@ -100,7 +145,8 @@ regex_tree::regex_tree(const std::string& s) {
             st.pop();
             auto left = st.top();
             st.pop();
-            st.push(std::make_shared<concat_node>(left, right));
+            st.push(make<concat_node>(left, right));
+            follow(left->lastpos, right->firstpos);
         } else if (token::is(ch, op::alt)) {
             if (st.size() < 2) {
                 throw regex::invalid_regex_exception("'|' operator with fewer than 2 operands");
@@ -109,10 +155,11 @@ regex_tree::regex_tree(const std::string& s) {
             st.pop();
             auto left = st.top();
             st.pop();
-            st.push(std::make_shared<alt_node>(left, right));
+            st.push(make<alt_node>(left, right));
         } else if (token::is_nonop(ch)) {
             token_map[ch].insert(i);
-            st.push(std::make_shared<char_node>(ch, i++));
+            followpos.emplace_back();
+            st.push(make<char_node>(ch, i++));
         } else {
             throw regex::invalid_regex_exception(s);
         }
@@ -125,22 +172,6 @@ regex_tree::regex_tree(const std::string& s) {
     root = st.top();
     st.pop();
 
-    visit([&](regex_node& node) {
-        if (node.type == regex_node::type::concat) {
-            for (const auto& concat_node = node.as<tree::concat_node>(); auto idx : concat_node.left->lastpos) {
-                followpos[idx].insert(concat_node.right->firstpos.begin(), concat_node.right->firstpos.end());
-            }
-        } else if (node.type == regex_node::type::star) {
-            for (auto& star_node = node.as<tree::star_node>(); auto idx : star_node.lastpos) {
-                followpos[idx].insert(star_node.firstpos.begin(), star_node.firstpos.end());
-            }
-        } else if (node.type == regex_node::type::plus) {
-            for (auto& plus_node = node.as<tree::plus_node>(); auto idx : plus_node.lastpos) {
-                followpos[idx].insert(plus_node.firstpos.begin(), plus_node.firstpos.end());
-            }
-        }
-    });
-
     token_map = disjoint_token_sets(token_map);
 }
 
@@ -158,7 +189,7 @@ void regex_tree::visit(const regex_node::node_ptr_t& node, const std::function<v
         return;
     }
 
-    func(*node.get());
+    func(*node);
 
     if (node->type == regex_node::type::concat) {
         const auto& concat_node = node->as<tree::concat_node>();
@@ -174,6 +205,8 @@ void regex_tree::visit(const regex_node::node_ptr_t& node, const std::function<v
     } else if (node->type == regex_node::type::plus) {
         const auto& plus_node = node->as<tree::plus_node>();
         visit(plus_node.child, func);
+    } else if (node->type == regex_node::type::optional) {
+        visit(node->as<tree::optional_node>().child, func);
     }
 }
 
@@ -201,54 +234,46 @@ void regex_tree::print(const regex_node::node_ptr_t& node, int indent) {
     } else if (node->type == regex_node::type::plus) {
         std::cout << token::op_map.at(op::plus) << std::endl;
         print(node->as<plus_node>().child, indent + 2);
+    } else if (node->type == regex_node::type::optional) {
+        std::cout << token::op_map.at(op::optional) << std::endl;
+        print(node->as<optional_node>().child, indent + 2);
     }
 }
 
-std::size_t regex_tree::unordered_set_hash::operator()(const std::unordered_set<std::size_t>& s) const {
-    std::size_t h = 0;
-    for (const auto v : s) {
-        h ^= std::hash<std::size_t>{}(v);
-    }
-    return h;
-}
-
 regex_tree::token_map_t regex_tree::disjoint_token_sets(const token_map_t& original) {
-    std::unordered_map<char, std::unordered_set<size_t>> char_to_positions;
+    std::array<position_set, 256> char_to_positions;
 
     for (const auto& [token, positions] : original) {
         if (token::is(token, token::symbol::end_mark)) {
             continue;
         }
-        if (auto cs = token::to_char_set(token); !cs.is_negative) {
-            for (char ch : cs.chars) {
-                char_to_positions[ch].insert(positions.begin(), positions.end());
-            }
-        } else {
-            for (int c = -128; c < 128; ++c) {
-                if (!cs.chars.contains(static_cast<char>(c))) {
-                    char_to_positions[static_cast<char>(c)].insert(positions.begin(), positions.end());
-                }
+        const auto cs = token::to_char_set(token);
+        for (int c = 0; c < 256; ++c) {
+            if (cs.matches(static_cast<char>(c))) {
+                char_to_positions[c] |= positions;
             }
         }
     }
 
-    std::unordered_map<std::unordered_set<size_t>, std::unordered_set<char>, unordered_set_hash> grouped;
-    for (const auto& [ch, pos] : char_to_positions) {
-        grouped[pos].insert(ch);
+    std::unordered_map<position_set, token::char_set, position_set_hash> grouped;
+    for (int c = 0; c < 256; ++c) {
+        if (!char_to_positions[c].empty()) {
+            grouped[char_to_positions[c]].add(static_cast<char>(c));
+        }
     }
 
     token_map_t result;
 
     for (const auto& [positions, chars] : grouped) {
         if (chars.size() == 1) {
-            result[token::token_type{*chars.begin()}] = positions;
+            for (int c = 0; c < 256; ++c) {
+                if (chars.contains(static_cast<char>(c))) {
+                    result[token::token_type{static_cast<char>(c)}] = positions;
+                }
+            }
             continue;
         }
-        token::char_set cs;
-        for (char ch : chars) {
-            cs.add(ch);
-        }
-        result[token::token_type{cs}] = positions;
+        result[token::token_type{chars}] = positions;
     }
 
     result[token::token_type{token::symbol::end_mark}] = original.at(token::symbol::end_mark);
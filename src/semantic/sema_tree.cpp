@@ -1,10 +1,33 @@
 #include "semantic/sema_tree.hpp"
+#include "trace.hpp"
+
 #include <iostream>
 #include <ranges>
 #include <utility>
 
 namespace semantic {
 
+namespace {
+
+// 语义动作在 trace 中的名字：所在产生式，动作的位置记为 @，其余动作省略
+std::string action_name(const std::shared_ptr<grammar::tree_node>& action) {
+    const auto parent = action->parent.lock();
+    if (!parent || !parent->symbol) {
+        return "@";
+    }
+    auto name = parent->symbol->name + " ->";
+    for (const auto& child : parent->children) {
+        if (child == action) {
+            name += " @";
+        } else if (child->symbol) {
+            name += " " + child->symbol->name;
+        }
+    }
+    return name;
+}
+
+} // namespace
+
 bool sema_tree_node::is_action() const {
     return action != nullptr;
 }
@@ -26,13 +49,17 @@ sema_tree_node::sema_tree_node(const sema_production::rhs_value_t& value) : gram
 }
 
 sema_tree::sema_tree(const std::vector<sema_production>& productions, std::ostream& oss) : os(&oss) {
+    auto map = std::make_shared<std::unordered_map<production, sema_production>>();
     for (const auto& prod : productions) {
-        prod_map[production(prod)] = prod;
+        (*map)[production(prod)] = prod;
     }
+    prod_map = std::move(map);
 }
 
+sema_tree::sema_tree(const sema_tree& other, std::ostream& oss) : prod_map(other.prod_map), os(&oss) {}
+
 void sema_tree::add(const production& prod) {
-    const auto& sema_prod = prod_map[prod];
+    const auto& sema_prod = prod_map->at(prod);
     if (!root) {
         root = std::make_shared<sema_tree_node>(sema_prod.lhs);
         std::vector<std::shared_ptr<grammar::production::symbol>> tmp;
@@ -82,7 +109,7 @@ void sema_tree::add(const production& prod) {
     if (found) {
         next = new_next;
     } else {
-        next = next->parent;
+        next = next->parent.lock();
         while (next) {
             for (const auto& child : next->children) {
                 if (child->symbol && child->symbol->is_non_terminal() && child->children.empty()) {
@@ -94,13 +121,13 @@ void sema_tree::add(const production& prod) {
             if (found) {
                 break;
             }
-            next = next->parent;
+            next = next->parent.lock();
         }
     }
 }
 
 void sema_tree::add_r(const production& prod) {
-    const auto& sema_prod = prod_map[prod];
+    const auto& sema_prod = prod_map->at(prod);
     if (!root) {
         root = std::make_shared<sema_tree_node>(sema_prod.lhs);
         for (const auto& rhs : sema_prod.rhs) {
@@ -138,7 +165,7 @@ void sema_tree::add_r(const production& prod) {
     }
 
     if (!found) {
-        next_r = next_r->parent;
+        next_r = next_r->parent.lock();
         while (next_r) {
             for (auto& it : std::ranges::reverse_view(next_r->children)) {
                 if (const auto snode = std::static_pointer_cast<sema_tree_node>(it); snode->is_symbol()
@@ -152,7 +179,7 @@ void sema_tree::add_r(const production& prod) {
             if (found) {
                 break;
             }
-            next_r = next_r->parent;
+            next_r = next_r->parent.lock();
         }
     }
 }
@@ -173,11 +200,13 @@ void sema_tree::print_node(const std::shared_ptr<grammar::tree_node>& node, cons
     }
 }
 
-sema_env sema_tree::calc() const {
+sema_env sema_tree::calc(std::any context) const {
+    const trace::span span("sema_tree::calc");
 #ifdef DEBUG
     this->print();
 #endif
     sema_env env(os);
+    env.context = std::move(context);
     calc_node(root, env);
 #ifdef DEBUG
     this->print();
@@ -189,7 +218,12 @@ void sema_tree::calc_node(const std::shared_ptr<grammar::tree_node>& node, sema_
     const auto snode = std::static_pointer_cast<sema_tree_node>(node);
 
     if (snode->is_action()) {
-        snode->action(env);
+        if (trace::enabled() && trace::sample_action()) {
+            const trace::span span(action_name(node));
+            snode->action(env);
+        } else {
+            snode->action(env);
+        }
         return;
     }
     if (snode->children.empty()) {
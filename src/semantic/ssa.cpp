@@ -0,0 +1,199 @@
+#include "semantic/ssa.hpp"
+
+#include <cassert>
+#include <ranges>
+
+namespace semantic {
+
+void ssa_builder::declare(const std::string& var, const std::string& type) {
+    types[var] = type;
+}
+
+void ssa_builder::enter_block(const std::string& block) {
+    current = block;
+}
+
+const std::string& ssa_builder::current_block() const {
+    return current;
+}
+
+void ssa_builder::add_predecessor(const std::string& block, const std::string& pred) {
+    assert(!sealed.contains(block) && "Cannot add a predecessor to a sealed block");
+    preds[block].push_back(pred);
+}
+
+void ssa_builder::seal_block(const std::string& block) {
+    const auto to_complete = std::move(incomplete[block]);
+    incomplete.erase(block);
+    sealed.insert(block);
+    for (const auto& name : to_complete | std::views::values) {
+        add_phi_operands(name);
+    }
+}
+
+bool ssa_builder::is_sealed(const std::string& block) const {
+    return sealed.contains(block);
+}
+
+void ssa_builder::write_variable(const std::string& var, const std::string& value) {
+    write_variable(var, current, value);
+}
+
+void ssa_builder::write_variable(const std::string& var, const std::string& block, const std::string& value) {
+    defs[var][block] = value;
+}
+
+std::string ssa_builder::read_variable(const std::string& var) {
+    return read_variable(var, current);
+}
+
+std::string ssa_builder::read_variable(const std::string& var, const std::string& block) {
+    // 沿唯一前驱向上迭代查找，途经的块都记下结果，长链上不会递归
+    std::vector<std::string> chain;
+    std::string value;
+    for (auto at = block;;) {
+        if (const auto found = defs.find(var); found != defs.end()) {
+            if (const auto def = found->second.find(at); def != found->second.end()) {
+                value = resolve(def->second);
+                break;
+            }
+        }
+        const auto& block_preds = preds[at];
+        if (!sealed.contains(at) || block_preds.size() != 1) {
+            value = read_variable_recursive(var, at);
+            break;
+        }
+        chain.push_back(at);
+        at = block_preds.front();
+    }
+    for (const auto& b : chain) {
+        write_variable(var, b, value);
+    }
+    return value;
+}
+
+std::string ssa_builder::resolve(const std::string& value) const {
+    auto result = value;
+    for (auto found = aliases.find(result); found != aliases.end(); found = aliases.find(result)) {
+        result = found->second;
+    }
+    return result;
+}
+
+bool ssa_builder::has_aliases() const {
+    return !aliases.empty();
+}
+
+std::vector<ssa_builder::phi> ssa_builder::phis(const std::string& block) const {
+    std::vector<phi> result;
+    const auto names = block_phis.find(block);
+    if (names == block_phis.end()) {
+        return result;
+    }
+    for (const auto& name : names->second) {
+        const auto found = phi_map.find(name);
+        if (found == phi_map.end()) {
+            continue;
+        }
+        auto p = found->second;
+        for (auto& value : p.operands | std::views::keys) {
+            value = resolve(value);
+        }
+        result.push_back(std::move(p));
+    }
+    return result;
+}
+
+std::string ssa_builder::read_variable_recursive(const std::string& var, const std::string& block) {
+    std::string value;
+    const auto& block_preds = preds[block];
+    if (!sealed.contains(block)) {
+        value = new_phi(var, block);
+        incomplete[block][var] = value;
+    } else if (block_preds.empty()) {
+        value = undef;
+    } else {
+        value = new_phi(var, block);
+        write_variable(var, block, value);
+        value = add_phi_operands(value);
+    }
+    write_variable(var, block, value);
+    return value;
+}
+
+std::string ssa_builder::new_phi(const std::string& var, const std::string& block) {
+    auto name = var + "." + block;
+    const auto type = types.find(var);
+    phi_map[name] = phi{name, var, type == types.end() ? "" : type->second, block, {}};
+    block_phis[block].push_back(name);
+    pending.insert(name);
+    return name;
+}
+
+std::string ssa_builder::add_phi_operands(const std::string& name) {
+    const auto var = phi_map.at(name).var;
+    const auto block = phi_map.at(name).block;
+    for (const auto& pred : std::vector(preds[block])) {
+        auto value = read_variable(var, pred);
+        if (value != name && phi_map.contains(value)) {
+            users.emplace(value, name);
+        }
+        phi_map.at(name).operands.emplace_back(std::move(value), pred);
+    }
+    pending.erase(name);
+    return try_remove_trivial_phi(name);
+}
+
+std::string ssa_builder::try_remove_trivial_phi(const std::string& name) {
+    std::vector<std::string> worklist{name};
+    while (!worklist.empty()) {
+        const auto candidate = std::move(worklist.back());
+        worklist.pop_back();
+        // 仍在补全操作数的 phi 在补全后自行检查
+        if (!phi_map.contains(candidate) || pending.contains(candidate)) {
+            continue;
+        }
+
+        std::string same;
+        bool trivial = true;
+        for (const auto& operand : phi_map.at(candidate).operands | std::views::keys) {
+            const auto value = resolve(operand);
+            if (value == same || value == candidate) {
+                continue;
+            }
+            if (!same.empty()) {
+                trivial = false;
+                break;
+            }
+            same = value;
+        }
+        if (!trivial) {
+            continue;
+        }
+        if (same.empty()) {
+            same = undef;
+        }
+
+        aliases[candidate] = same;
+        phi_map.erase(candidate);
+
+        // 使用者的操作数现在解析为 same，转移到 same 的使用者中并重新检查
+        const auto [begin, end] = users.equal_range(candidate);
+        std::vector<std::string> found;
+        for (auto it = begin; it != end; ++it) {
+            if (it->second != candidate) {
+                found.push_back(it->second);
+            }
+        }
+        users.erase(candidate);
+        for (auto& user : found) {
+            if (same != user && phi_map.contains(same)) {
+                users.emplace(same, user);
+            }
+            worklist.push_back(std::move(user));
+        }
+    }
+    return resolve(name);
+}
+
+} // namespace semantic
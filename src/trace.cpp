@@ -0,0 +1,116 @@
+#include "trace.hpp"
+
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace detail {
+std::atomic<bool> active{false};
+}
+
+namespace {
+
+struct event {
+    std::string name;
+    double ts;
+    double dur;
+    std::size_t tid;
+};
+
+std::mutex mutex;
+std::vector<event> events;
+std::chrono::steady_clock::time_point origin;
+std::size_t sample_every = 0;
+std::atomic<std::size_t> actions{0};
+
+// 按线程首次记录事件的顺序编号，比 std::thread::id 更便于阅读
+std::size_t thread_index() {
+    static std::atomic<std::size_t> next{1};
+    thread_local const std::size_t index = next++;
+    return index;
+}
+
+void append_escaped(std::string& out, const std::string& s) {
+    for (const char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+}
+
+} // namespace
+
+void start(const std::size_t action_sample) {
+    const std::lock_guard lock(mutex);
+    events.clear();
+    origin = std::chrono::steady_clock::now();
+    sample_every = action_sample;
+    actions = 0;
+    detail::active = true;
+}
+
+void stop() {
+    detail::active = false;
+}
+
+bool sample_action() {
+    return enabled() && sample_every != 0 && actions++ % sample_every == 0;
+}
+
+void write(std::ostream& os) {
+    const std::lock_guard lock(mutex);
+    std::string out = "{\"traceEvents\":[";
+    char buf[128];
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const auto& e = events[i];
+        out += i ? ",\n{\"name\":\"" : "\n{\"name\":\"";
+        append_escaped(out, e.name);
+        std::snprintf(buf, sizeof(buf), "\",\"cat\":\"compiler\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%zu}",
+                      e.ts, e.dur, e.tid);
+        out += buf;
+    }
+    out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    os << out;
+    os.flush();
+}
+
+span::span(const char* name) : recording(enabled()) {
+    if (recording) {
+        this->name = name;
+        begin = std::chrono::steady_clock::now();
+    }
+}
+
+span::span(std::string name) : recording(enabled()) {
+    if (recording) {
+        this->name = std::move(name);
+        begin = std::chrono::steady_clock::now();
+    }
+}
+
+span::~span() {
+    if (!recording) {
+        return;
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto tid = thread_index();
+    const std::lock_guard lock(mutex);
+    const std::chrono::duration<double, std::micro> ts = begin - origin;
+    const std::chrono::duration<double, std::micro> dur = end - begin;
+    events.push_back({std::move(name), ts.count(), dur.count(), tid});
+}
+
+} // namespace trace
@@ -2,6 +2,8 @@
 #include "utils.hpp"
 
 #include <gtest/gtest.h>
+#include <memory>
+#include <thread>
 
 std::vector<lexer::token> simple_lexer(const std::string& input) {
     std::vector<lexer::token> tokens;
@@ -203,3 +205,107 @@ TEST(grammar_test, parse_ambigous_grammar) {
     grammar::SLR<> slr(g);
     EXPECT_ANY_THROW(lr1.build());
 }
+
+TEST(grammar_test, table_sizes) {
+    // 使用默认配置，不受其他测试对线程默认 context 的修改影响
+    const grammar::context ctx;
+    const grammar::context_scope scope(ctx);
+    grammar::SLR<> slr("S -> ( S ) | x");
+    slr.build();
+    EXPECT_EQ(slr.state_count(), 6);
+    EXPECT_EQ(slr.action_count(), 10);
+    EXPECT_EQ(slr.goto_count(), 2);
+
+    // LR(1) 按向前看符号区分括号内外的状态
+    grammar::LR1 lr1("S -> ( S ) | x");
+    lr1.build();
+    EXPECT_EQ(lr1.state_count(), 10);
+    EXPECT_EQ(lr1.goto_count(), 3);
+}
+
+TEST(grammar_test, independent_contexts) {
+    grammar::context braces;
+    braces.set_epsilon_str("E");
+    braces.set_terminal_rule([](const std::string& str) {
+        return str == "{" || str == "}";
+    });
+    grammar::context lower;
+
+    auto make = [](const grammar::context& ctx, const std::string& g) {
+        const grammar::context_scope scope(ctx);
+        auto parser = std::make_unique<grammar::LR1>(g);
+        parser->build();
+        return parser;
+    };
+    const auto nested = make(braces, "B -> { B } B | E");
+    const auto pairs = make(lower, "S -> a S b | ε");
+
+    const auto saved = grammar::context::thread_default();
+    grammar::set_epsilon_str("#");
+    grammar::set_terminal_rule([](const std::string&) { return false; });
+
+    auto preorder = [](const grammar::LR1& parser, const std::string& input) {
+        auto tree = std::make_shared<grammar::tree>();
+        parser.parse(simple_lexer(input), *tree);
+        std::vector<std::string> result;
+        tree->visit([&result](auto&& node) {
+            result.push_back(node->symbol->name);
+        });
+        return result;
+    };
+
+    std::vector<std::string> nested_result;
+    std::vector<std::string> pairs_result;
+    {
+        std::jthread t1([&] { nested_result = preorder(*nested, "{ } { }"); });
+        std::jthread t2([&] { pairs_result = preorder(*pairs, "a a b b"); });
+    }
+
+    EXPECT_EQ(nested_result, (std::vector<std::string>{"B", "{", "B", "E", "}", "B", "{", "B", "E", "}", "B", "E"}));
+    EXPECT_EQ(pairs_result, (std::vector<std::string>{"S", "a", "S", "a", "S", "ε", "b", "b"}));
+
+    grammar::context::thread_default() = saved;
+}
+
+TEST(grammar_test, reparse_matches_full_parse) {
+    // 使用默认配置，不受其他测试对线程默认 context 的修改影响
+    const grammar::context ctx;
+    const grammar::context_scope scope(ctx);
+    grammar::LR1 parser(R"(
+E  -> T E'
+E' -> + T E' | - T E' | ε
+T  -> F T'
+T' -> * F T' | / F T' | ε
+F  -> ( E ) | id
+)");
+    parser.build();
+
+    auto preorder = [](const grammar::tree& tree) {
+        std::vector<std::string> result;
+        tree.visit([&result](auto&& node) {
+            result.push_back(node->symbol->name);
+        });
+        return result;
+    };
+
+    const auto old_tokens = simple_lexer("id + id * id + ( id ) + id + id");
+    grammar::parse_log log;
+    grammar::tree old_tree;
+    parser.parse(old_tokens, old_tree, log);
+    EXPECT_EQ(log.driven, old_tokens.size() + 1);
+
+    // 把第 3 个 id 替换为 ( id + id )
+    const auto new_tokens = simple_lexer("id + id * ( id + id ) + ( id ) + id + id");
+    grammar::tree incremental;
+    parser.reparse(new_tokens, {4, 5, 9}, incremental, log);
+
+    grammar::tree full;
+    parser.parse(new_tokens, full);
+    EXPECT_EQ(preorder(incremental), preorder(full));
+    EXPECT_LT(log.driven, new_tokens.size());
+
+    grammar::tree again;
+    parser.reparse(new_tokens, {new_tokens.size(), new_tokens.size(), new_tokens.size()}, again, log);
+    EXPECT_EQ(preorder(again), preorder(full));
+    EXPECT_EQ(log.driven, 0);
+}
@@ -0,0 +1,364 @@
+#include "ir.hpp"
+#include "passes.hpp"
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// 把函数体包装成只有一个 main 函数的模块并解析
+ir::function parse_function(const std::string& body) {
+    std::istringstream is("define i32 @main() {\n" + body + "}\n");
+    auto mod = ir::parse(is);
+    return std::move(mod.functions.at(0));
+}
+
+// 与 parse_function 的输入格式相同，不含 define 行和右花括号
+std::string body_of(const ir::function& func) {
+    std::ostringstream os;
+    for (const auto& b : func.blocks) {
+        os << b.label << ":\n";
+        for (const auto& inst : b.insts) {
+            os << inst << '\n';
+        }
+    }
+    return os.str();
+}
+
+} // namespace
+
+// IR 解析与输出
+
+TEST(ir_test, parse_module) {
+    std::istringstream is(R"(; ModuleID = 'main'
+
+@.str.0 = private unnamed_addr constant [4 x i8] c"%d\0a\00", align 1
+
+declare i32 @printf(i8*, ...)
+
+define i32 @main() {
+entry:
+  br i1 true, label %L1, label %L2
+L1:
+  br label %L3
+L2:
+  br label %L3
+L3:
+  %a.L3 = phi i32 [ 4, %L1 ], [ 5, %L2 ]
+  %s = getelementptr inbounds [4 x i8], [4 x i8]* @.str.0, i64 0, i64 0
+  %m = mul nsw i32 %a.L3, 2
+  %r = call i32 (i8*, ...) @printf(i8* %s, i32 %m)
+  ret i32 0
+}
+)");
+    const auto mod = ir::parse(is);
+    ASSERT_EQ(mod.globals.size(), 1);
+    EXPECT_EQ(mod.globals[0].name, ".str.0");
+    EXPECT_EQ(mod.globals[0].data, "%d\n");
+    EXPECT_EQ(mod.declarations, std::vector<std::string>{"declare i32 @printf(i8*, ...)"});
+    ASSERT_EQ(mod.functions.size(), 1);
+
+    const auto& func = mod.functions[0];
+    EXPECT_EQ(func.name, "main");
+    ASSERT_EQ(func.blocks.size(), 4);
+    EXPECT_EQ(func.blocks[0].successors(), (std::vector<std::string>{"L1", "L2"}));
+
+    const auto& insts = func.blocks[3].insts;
+    ASSERT_EQ(insts.size(), 5);
+    EXPECT_EQ(insts[0].op, ir::opcode::phi);
+    EXPECT_EQ(insts[0].labels, (std::vector<std::string>{"L1", "L2"}));
+    EXPECT_EQ(insts[1].array_size, 4);
+    EXPECT_TRUE(insts[2].nsw);
+    EXPECT_EQ(insts[3].callee, "printf");
+    EXPECT_EQ(insts[3].operands.size(), 2);
+    EXPECT_EQ(insts[4].op, ir::opcode::ret);
+
+    // 输出后重新解析得到相同的文本
+    std::ostringstream printed;
+    ir::print(printed, mod);
+    std::istringstream again(printed.str());
+    std::ostringstream reprinted;
+    ir::print(reprinted, ir::parse(again));
+    EXPECT_EQ(printed.str(), reprinted.str());
+}
+
+TEST(ir_test, rejects_unknown_instruction) {
+    EXPECT_THROW(parse_function("entry:\n  %x = frob i32 1, 2\n"), ir::parse_error);
+    EXPECT_THROW(parse_function("  ret i32 0\n"), ir::parse_error);
+}
+
+// mem2reg
+
+TEST(passes_test, mem2reg_inserts_phi) {
+    auto func = parse_function(R"(entry:
+  %x = alloca i32, align 4
+  store i32 1, i32* %x, align 4
+  %c = call i1 (i8*, ...) @cond()
+  br i1 %c, label %then, label %join
+then:
+  store i32 2, i32* %x, align 4
+  br label %join
+join:
+  %v = load i32, i32* %x, align 4
+  ret i32 %v
+)");
+    ir::passes::mem2reg(func);
+    EXPECT_EQ(body_of(func), R"(entry:
+  %c = call i1 (i8*, ...) @cond()
+  br i1 %c, label %then, label %join
+then:
+  br label %join
+join:
+  %x.join = phi i32 [ 1, %entry ], [ 2, %then ]
+  ret i32 %x.join
+)");
+}
+
+TEST(passes_test, mem2reg_hoists_escaped_alloca) {
+    auto func = parse_function(R"(entry:
+  br label %body
+body:
+  %buf = alloca i32, align 4
+  %n = call i32 (i8*, ...) @scanf(i8* @.str.0, i32* %buf)
+  %v = load i32, i32* %buf, align 4
+  ret i32 %v
+)");
+    ir::passes::mem2reg(func);
+    // 地址被传给 scanf 的 alloca 不能提升，只移到入口块
+    EXPECT_EQ(body_of(func), R"(entry:
+  %buf = alloca i32, align 4
+  br label %body
+body:
+  %n = call i32 (i8*, ...) @scanf(i8* @.str.0, i32* %buf)
+  %v = load i32, i32* %buf, align 4
+  ret i32 %v
+)");
+}
+
+// 常量折叠
+
+TEST(passes_test, fold_constants) {
+    auto func = parse_function(R"(entry:
+  %a = add nsw i32 2, 3
+  %b = mul nsw i32 %a, 4
+  %c = icmp slt i32 %b, 30
+  %d = add i32 2147483647, 1
+  %e = sdiv i32 %d, 0
+  %f = sitofp i32 %b to double
+  %g = fmul double %f, 0.5
+  br i1 %c, label %yes, label %no
+yes:
+  ret i32 %e
+no:
+  %h = fptosi double %g to i32
+  ret i32 %h
+)");
+    EXPECT_TRUE(ir::passes::fold_constants(func));
+    // i32 溢出按补码回绕，除以 0 保留到运行时
+    EXPECT_EQ(body_of(func), R"(entry:
+  %e = sdiv i32 -2147483648, 0
+  br i1 true, label %yes, label %no
+yes:
+  ret i32 %e
+no:
+  ret i32 10
+)");
+    EXPECT_FALSE(ir::passes::fold_constants(func));
+}
+
+TEST(passes_test, fold_constants_casts) {
+    const auto folded = [](const std::string& cast, const std::string& to) {
+        auto func = parse_function("entry:\n  %a = " + cast + "\n  ret " + to + " %a\n");
+        EXPECT_TRUE(ir::passes::fold_constants(func)) << cast;
+        return func.blocks[0].insts.back().to_string();
+    };
+    // 按源类型的位宽扩展，i8 不能当作 i1
+    EXPECT_EQ(folded("zext i1 true to i32", "i32"), "  ret i32 1");
+    EXPECT_EQ(folded("sext i1 true to i32", "i32"), "  ret i32 -1");
+    EXPECT_EQ(folded("zext i8 255 to i32", "i32"), "  ret i32 255");
+    EXPECT_EQ(folded("zext i8 -1 to i32", "i32"), "  ret i32 255");
+    EXPECT_EQ(folded("zext i8 2 to i32", "i32"), "  ret i32 2");
+    EXPECT_EQ(folded("sext i8 255 to i32", "i32"), "  ret i32 -1");
+    EXPECT_EQ(folded("sext i8 127 to i32", "i32"), "  ret i32 127");
+    EXPECT_EQ(folded("zext i32 -1 to i64", "i64"), "  ret i64 4294967295");
+    EXPECT_EQ(folded("sext i32 -1 to i64", "i64"), "  ret i64 -1");
+    EXPECT_EQ(folded("trunc i32 300 to i8", "i8"), "  ret i8 44");
+    EXPECT_EQ(folded("trunc i64 4294967297 to i32", "i32"), "  ret i32 1");
+}
+
+TEST(passes_test, fold_constants_phi) {
+    auto func = parse_function(R"(entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 7, %entry ], [ %i, %loop ]
+  %c = call i1 (i8*, ...) @cond()
+  br i1 %c, label %loop, label %exit
+exit:
+  ret i32 %i
+)");
+    // 除自身外只有一个来源的 phi 等于该来源
+    EXPECT_TRUE(ir::passes::fold_constants(func));
+    EXPECT_EQ(func.blocks[2].insts.back().to_string(), "  ret i32 7");
+}
+
+// 死代码删除
+
+TEST(passes_test, dce_keeps_side_effects) {
+    auto func = parse_function(R"(entry:
+  %a = add i32 %x, 1
+  %b = mul i32 %a, 2
+  %c = add i32 %x, 3
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0, i32 %c)
+  ret i32 0
+)");
+    EXPECT_TRUE(ir::passes::dce(func));
+    // 未使用的调用结果仍保留，只删除没有副作用的 %a、%b
+    EXPECT_EQ(body_of(func), R"(entry:
+  %c = add i32 %x, 3
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0, i32 %c)
+  ret i32 0
+)");
+    EXPECT_FALSE(ir::passes::dce(func));
+}
+
+// 控制流图化简
+
+TEST(passes_test, simplify_cfg_folds_constant_branch) {
+    auto func = parse_function(R"(entry:
+  br i1 false, label %dead, label %live
+dead:
+  br label %join
+live:
+  br label %join
+join:
+  %v = phi i32 [ 1, %dead ], [ 2, %live ]
+  ret i32 %v
+)");
+    EXPECT_TRUE(ir::passes::simplify_cfg(func));
+    // 不可达的 dead 被删除，剩下的直线块合并进入口块，phi 被唯一的来源替换
+    EXPECT_EQ(body_of(func), R"(entry:
+  ret i32 2
+)");
+    EXPECT_FALSE(ir::passes::simplify_cfg(func));
+}
+
+TEST(passes_test, simplify_cfg_same_targets) {
+    auto func = parse_function(R"(entry:
+  %c = call i1 (i8*, ...) @cond()
+  br i1 %c, label %next, label %next
+next:
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0)
+  ret i32 0
+)");
+    EXPECT_TRUE(ir::passes::simplify_cfg(func));
+    EXPECT_EQ(body_of(func), R"(entry:
+  %c = call i1 (i8*, ...) @cond()
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0)
+  ret i32 0
+)");
+}
+
+TEST(passes_test, simplify_cfg_threads_empty_block) {
+    auto func = parse_function(R"(entry:
+  %c = call i1 (i8*, ...) @cond()
+  br i1 %c, label %a, label %b
+a:
+  br label %exit
+b:
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0)
+  br label %exit
+exit:
+  ret i32 0
+)");
+    EXPECT_TRUE(ir::passes::simplify_cfg(func));
+    // 只含跳转的 a 被绕过后不可达而删除；入口块以条件跳转结束，b 不能合并进去
+    EXPECT_EQ(body_of(func), R"(entry:
+  %c = call i1 (i8*, ...) @cond()
+  br i1 %c, label %exit, label %b
+b:
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0)
+  br label %exit
+exit:
+  ret i32 0
+)");
+}
+
+TEST(passes_test, simplify_cfg_folds_branch_exposed_by_merge) {
+    auto func = parse_function(R"(entry:
+  br label %mid
+mid:
+  %c = phi i1 [ true, %entry ]
+  br i1 %c, label %yes, label %no
+yes:
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0)
+  ret i32 1
+no:
+  ret i32 2
+)");
+    // 合并 mid 后 %c 被替换为 true，下一轮折叠分支并删除 no
+    EXPECT_TRUE(ir::passes::simplify_cfg(func));
+    EXPECT_EQ(body_of(func), R"(entry:
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0)
+  ret i32 1
+)");
+}
+
+TEST(passes_test, simplify_cfg_merges_long_chain) {
+    constexpr int n = 2000;
+    std::string text = "entry:\n  %w0 = add i32 %x, 1\n  br label %L1\n";
+    for (int i = 1; i <= n; ++i) {
+        const auto k = std::to_string(i);
+        const auto prev = std::to_string(i - 1);
+        text += "L" + k + ":\n";
+        text += "  %v" + k + " = phi i32 [ %w" + prev + ", %" + (i == 1 ? std::string("entry") : "L" + prev) + " ]\n";
+        text += "  %w" + k + " = add i32 %v" + k + ", 1\n";
+        text += i == n ? "  ret i32 %w" + k + "\n" : "  br label %L" + std::to_string(i + 1) + "\n";
+    }
+    auto func = parse_function(text);
+    EXPECT_TRUE(ir::passes::simplify_cfg(func));
+    ASSERT_EQ(func.blocks.size(), 1);
+    const auto& insts = func.blocks[0].insts;
+    ASSERT_EQ(insts.size(), n + 2);
+    // phi 全部被替换为前一个块中的值
+    EXPECT_EQ(insts[n].to_string(), "  %w2000 = add i32 %w1999, 1");
+    EXPECT_EQ(insts.back().to_string(), "  ret i32 %w2000");
+}
+
+// 完整的流水线
+
+TEST(passes_test, optimize_pipeline) {
+    std::istringstream is(R"(define i32 @main() {
+entry:
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  store i32 1, i32* %a, align 4
+  store i32 2, i32* %b, align 4
+  %a0 = load i32, i32* %a, align 4
+  %b0 = load i32, i32* %b, align 4
+  %c = icmp slt i32 %a0, %b0
+  br i1 %c, label %then, label %else
+then:
+  %a1 = load i32, i32* %a, align 4
+  %a2 = add nsw i32 %a1, 3
+  store i32 %a2, i32* %a, align 4
+  br label %end
+else:
+  store i32 5, i32* %a, align 4
+  br label %end
+end:
+  %a3 = load i32, i32* %a, align 4
+  %m = mul nsw i32 %a3, 2
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0, i32 %m)
+  ret i32 0
+}
+)");
+    auto mod = ir::parse(is);
+    ir::passes::optimize(mod, 2);
+    EXPECT_EQ(body_of(mod.functions[0]), R"(entry:
+  %r = call i32 (i8*, ...) @printf(i8* @.str.0, i32 8)
+  ret i32 0
+)");
+}
@@ -1,6 +1,7 @@
 #include "lexer/lexer.hpp"
 
 #include <gtest/gtest.h>
+#include <tuple>
 
 enum class token_type {
     INT,
@@ -132,3 +133,144 @@ TEST_F(lexer_tests, handles_long_mixed_input) {
 TEST_F(lexer_tests, handles_error_at_end_of_input) {
     expect_tokens("int i = 1; i = .", {{token_type::INT, "int"}, {token_type::ID, "i"}, {token_type::ASSIGN, "="}, {token_type::INTNUM, "1"}, {token_type::SEMI, ";"}, {token_type::ID, "i"}, {token_type::ASSIGN, "="}, {static_cast<token_type>(-1), "."}});
 }
+
+TEST(lexer_instances, token_names_are_per_lexer) {
+    const lexer::lexer::input_keywords_t<token_type> plus = {{"\\+", token_type::PLUS, "plus"}, {" ", token_type::WHITESPACE, "WS"}};
+    const lexer::lexer::input_keywords_t<token_type> add = {{"\\+", token_type::PLUS, "add"}, {"-", token_type::WHITESPACE, "DASH"}};
+    const lexer::lexer first(plus, token_type::WHITESPACE);
+    const lexer::lexer second(add, token_type::WHITESPACE);
+
+    const auto first_tokens = first.parse("+ +");
+    const auto second_tokens = second.parse("+-+");
+    ASSERT_EQ(first_tokens.size(), 2);
+    ASSERT_EQ(second_tokens.size(), 2);
+    EXPECT_EQ(std::string(first_tokens[0]), "plus");
+    EXPECT_EQ(std::string(second_tokens[0]), "add");
+    EXPECT_EQ(first.token_names().at(static_cast<int>(token_type::PLUS)), "plus");
+    EXPECT_EQ(second.whitespace(), static_cast<int>(token_type::WHITESPACE));
+}
+
+TEST_F(lexer_tests, relex_matches_full_lex) {
+    const std::string input = "int x = 1;\nif (x >= 10) { x = x + 1; }\nelse { x = 0; }";
+    const std::vector<std::tuple<std::size_t, std::size_t, std::string>> edits = {
+        {4, 1, "count"}, {8, 0, "2"}, {0, 0, "  "}, {11, 0, "\n\n"}, {input.size(), 0, " y"}, {15, 4, ""}, {20, 1, "."}, {6, 5, ""}};
+    for (const auto& [offset, removed, text] : edits) {
+        auto edited = input;
+        edited.replace(offset, removed, text);
+        auto tokens = lex.parse(input);
+        const auto d = lex.relex(edited, tokens, {offset, removed, text.size()});
+        const auto expected = lex.parse(edited);
+        ASSERT_EQ(tokens.size(), expected.size()) << edited;
+        EXPECT_LE(d.new_end, tokens.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(tokens[i].type, expected[i].type) << edited << " at index " << i;
+            EXPECT_EQ(tokens[i].value, expected[i].value) << edited << " at index " << i;
+            EXPECT_EQ(tokens[i].line, expected[i].line) << edited << " at index " << i;
+            EXPECT_EQ(tokens[i].column, expected[i].column) << edited << " at index " << i;
+            EXPECT_EQ(tokens[i].offset, expected[i].offset) << edited << " at index " << i;
+        }
+    }
+}
+
+TEST_F(lexer_tests, relex_only_touches_damaged_tokens) {
+    const std::string input = "a = 1; b = 2; c = 3; d = 4;";
+    auto tokens = lex.parse(input);
+    auto edited = input;
+    edited.replace(11, 1, "42");
+    const auto d = lex.relex(edited, tokens, {11, 1, 2});
+    EXPECT_EQ(d.first, 5);
+    EXPECT_EQ(d.old_end, 7);
+    EXPECT_EQ(d.new_end, 7);
+    EXPECT_EQ(tokens[6].value, "42");
+    EXPECT_EQ(tokens.back().offset, edited.size() - 1);
+}
+
+TEST(lexer_instances, relex_with_skipped_comments) {
+    enum class kind { ID, COMMENT, WS };
+    const lexer::lexer::input_keywords_t<kind> words = {
+        {"[a-z]+", kind::ID, "ID"}, {"/\\*([^*]|\\*+[^*/])*\\*+/", kind::COMMENT, "COMMENT"}, {"[ \n]+", kind::WS, "WS"}};
+    lexer::lexer lex(words, kind::WS);
+    lex.skip(kind::COMMENT);
+
+    const std::string input = "a b /* c */ d";
+    auto tokens = lex.parse(input);
+    ASSERT_EQ(tokens.size(), 3);
+
+    // 新插入的注释开头一直延伸到原有注释的结尾
+    auto edited = input;
+    edited.insert(2, "/*");
+    const auto d = lex.relex(edited, tokens, {2, 0, 2});
+    const auto expected = lex.parse(edited);
+    ASSERT_EQ(tokens.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(tokens[i].type, expected[i].type);
+        EXPECT_EQ(tokens[i].value, expected[i].value);
+    }
+    EXPECT_EQ(d.old_end, 2);
+    EXPECT_EQ(d.new_end, 1);
+}
+
+TEST_F(lexer_tests, parallel_parse_matches_sequential) {
+    std::string input;
+    for (int i = 0; input.size() < 160000; ++i) {
+        input += "int x" + std::to_string(i) + " = " + std::to_string(i) + ".5 * (y - 42);\n";
+        if (i % 500 == 0) {
+            input += "if (x >= 10) { x = x + 1; } else { x = . ; }\n";
+        }
+        if (i == 1500) {
+            input += std::string(80000, 'z') + "\n";
+        }
+    }
+
+    const auto expected = lex.parse(input);
+    for (const std::size_t jobs : {2, 3}) {
+        const auto tokens = lex.parse_parallel(input, jobs);
+        ASSERT_EQ(tokens.size(), expected.size()) << jobs;
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(tokens[i].type, expected[i].type) << jobs << " at index " << i;
+            ASSERT_EQ(tokens[i].value, expected[i].value) << jobs << " at index " << i;
+            ASSERT_EQ(tokens[i].line, expected[i].line) << jobs << " at index " << i;
+            ASSERT_EQ(tokens[i].column, expected[i].column) << jobs << " at index " << i;
+            ASSERT_EQ(tokens[i].offset, expected[i].offset) << jobs << " at index " << i;
+            ASSERT_EQ(tokens[i].reach, expected[i].reach) << jobs << " at index " << i;
+        }
+    }
+}
+
+TEST(lexer_instances, parallel_parse_resynchronizes_inside_strings) {
+    enum class kind { ID, STRING, WS };
+    const lexer::lexer::input_keywords_t<kind> words = {
+        {"[a-z0-9]+", kind::ID, "ID"}, {"\"[^\"]*\"", kind::STRING, "STRING"}, {" +", kind::WS, "WS"}};
+    const lexer::lexer lex(words, kind::WS);
+
+    // 块边界落在字符串中间，从块首推测得到的引号配对与真实结果相反
+    std::string input;
+    for (int i = 0; input.size() < 200000; ++i) {
+        input += "\"" + std::string(3000, 'q') + "\" x" + std::to_string(i) + " ";
+    }
+
+    const auto expected = lex.parse(input);
+    const auto tokens = lex.parse_parallel(input, 3);
+    ASSERT_EQ(tokens.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(tokens[i].type, expected[i].type) << " at index " << i;
+        ASSERT_EQ(tokens[i].offset, expected[i].offset) << " at index " << i;
+        ASSERT_EQ(tokens[i].column, expected[i].column) << " at index " << i;
+        ASSERT_EQ(tokens[i].reach, expected[i].reach) << " at index " << i;
+    }
+}
+
+TEST_F(lexer_tests, positions_follow_newlines) {
+    const std::string input = "int x;\n\n  if (x)\n\t{ y = 1; }";
+    const auto tokens = lex.parse(input);
+    const lexer::line_index index(input);
+    for (const auto& t : tokens) {
+        EXPECT_EQ(index.locate(t.offset), std::make_pair(t.line, t.column)) << t;
+    }
+    EXPECT_EQ(tokens[3].line, 3);
+    EXPECT_EQ(tokens[3].column, 3);
+    EXPECT_EQ(tokens[7].line, 4);
+    EXPECT_EQ(tokens[7].column, 2);
+    EXPECT_EQ(index.locate(0), std::make_pair(std::size_t{1}, std::size_t{1}));
+    EXPECT_EQ(index.locate(input.size()), std::make_pair(std::size_t{4}, std::size_t{12}));
+}
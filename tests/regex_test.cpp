@@ -1,6 +1,13 @@
+#include "regex/dfa.hpp"
+#include "regex/exception.hpp"
 #include "regex/regex.hpp"
+#include "regex/regex_set.hpp"
+#include "regex/tree.hpp"
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <random>
+
 class regex_tests : public ::testing::Test {};
 
 TEST_F(regex_tests, exact_concatenation_matches_full_sequence) {
@@ -130,4 +137,285 @@ TEST_F(regex_tests, escaped_characters_in_char_set) {
     EXPECT_TRUE(re.match("]"));
     EXPECT_FALSE(re.match("c"));
     EXPECT_FALSE(re.match("ab"));
-}
\ No newline at end of file
+}
+
+TEST_F(regex_tests, match_max_skips_long_runs) {
+    const auto ws = regex::regex("[ \t\n]+");
+    const auto id = regex::regex("[a-zA-Z_][a-zA-Z0-9_]*");
+    const auto comment = regex::regex("/\\*([^*]|\\*+[^*/])*\\*+/");
+    for (const std::size_t len : {1, 15, 16, 17, 31, 32, 33, 100, 1000}) {
+        EXPECT_EQ(ws.match_max(std::string(len, ' ') + "x"), len);
+        EXPECT_EQ(ws.match_max(std::string(len, '\t') + "\n"), len + 1);
+        EXPECT_EQ(id.match_max("_" + std::string(len, 'z') + "9-"), len + 2);
+        EXPECT_EQ(id.match_max("a" + std::string(len, 'q') + "\xe4"), len + 1);
+        EXPECT_EQ(comment.match_max("/*" + std::string(len, 'x') + "*/ y"), len + 4);
+        EXPECT_EQ(comment.match_max("/*" + std::string(len, '\xff') + "**/"), len + 5);
+        EXPECT_EQ(comment.match_max("/*" + std::string(len, 'x')), 0);
+
+        std::size_t scanned;
+        EXPECT_EQ(ws.match_max(std::string(len, ' '), scanned), len);
+        EXPECT_EQ(scanned, len + 1);
+    }
+}
+
+TEST_F(regex_tests, dfa_is_minimized) {
+    EXPECT_EQ(regex::dfa::dfa("(a|b)*abb").state_count(), 4);
+    EXPECT_EQ(regex::dfa::dfa("a*|b*").state_count(), 3);
+    EXPECT_EQ(regex::regex("(a|b)*abb").state_count(), 4);
+    // 死状态不计入：ab、ac、ad 之后的状态合并为一个
+    const auto ab = regex::dfa::dfa("ab|ac|ad");
+    EXPECT_EQ(ab.state_count(), 3);
+    EXPECT_EQ(ab.class_count(), 3);
+    EXPECT_TRUE(ab.match("ad"));
+    EXPECT_FALSE(ab.match("ae"));
+    const auto comment = regex::dfa::dfa("/\\*([^*]|\\*+[^*/])*\\*+/");
+    EXPECT_EQ(comment.state_count(), 5);
+    EXPECT_TRUE(comment.match("/* a ** b */"));
+    EXPECT_FALSE(comment.match("/* a */ b */"));
+}
+
+TEST_F(regex_tests, followpos_uses_position_sets) {
+    const regex::tree::regex_tree tree("(a|b)*abb");
+    auto positions = [](const regex::tree::position_set& s) { return std::vector(s.begin(), s.end()); };
+    EXPECT_EQ(positions(tree.root->firstpos), (std::vector<std::size_t>{1, 2, 3}));
+    EXPECT_EQ(positions(tree.followpos[1]), (std::vector<std::size_t>{1, 2, 3}));
+    EXPECT_EQ(positions(tree.followpos[2]), (std::vector<std::size_t>{1, 2, 3}));
+    EXPECT_EQ(positions(tree.followpos[3]), (std::vector<std::size_t>{4}));
+    EXPECT_EQ(positions(tree.followpos[4]), (std::vector<std::size_t>{5}));
+    EXPECT_EQ(positions(tree.followpos[5]), (std::vector<std::size_t>{6}));
+    EXPECT_TRUE(tree.followpos[6].empty());
+
+    regex::tree::position_set s;
+    s.insert(200);
+    s.insert(3);
+    s.insert(64);
+    EXPECT_EQ(positions(s), (std::vector<std::size_t>{3, 64, 200}));
+    EXPECT_EQ(s.size(), 3);
+    EXPECT_TRUE(s.contains(64));
+    EXPECT_FALSE(s.contains(65));
+    regex::tree::position_set t;
+    t.insert(64);
+    EXPECT_TRUE(s.intersects(t));
+    t |= s;
+    EXPECT_EQ(t, s);
+    EXPECT_EQ(regex::tree::position_set_hash{}(t), regex::tree::position_set_hash{}(s));
+}
+
+TEST_F(regex_tests, nullable_pattern_accepts_in_start_state) {
+    const auto re = regex::regex("a*|b");
+    EXPECT_TRUE(re.match(""));
+    EXPECT_TRUE(re.match("aa"));
+    EXPECT_TRUE(re.match("b"));
+    EXPECT_FALSE(re.match("ab"));
+}
+
+TEST_F(regex_tests, long_keyword_alternation) {
+    std::string pattern;
+    for (int i = 0; i < 500; ++i) {
+        pattern += (i == 0 ? "k" : "|k") + std::to_string(i * 37);
+    }
+    const auto re = regex::regex(pattern);
+    EXPECT_TRUE(re.match("k0"));
+    EXPECT_TRUE(re.match("k37"));
+    EXPECT_TRUE(re.match("k18463"));
+    EXPECT_FALSE(re.match("k38"));
+    EXPECT_EQ(re.match_max("k740k"), 4);
+}
+
+TEST_F(regex_tests, char_set_is_a_byte_bitmap) {
+    regex::token::char_set high('\x80', '\xff');
+    EXPECT_EQ(high.size(), 128);
+    EXPECT_TRUE(high.contains('\xe4'));
+    EXPECT_FALSE(high.contains('a'));
+
+    regex::token::char_set ascii('\0', '\x7f');
+    EXPECT_EQ(ascii.size(), 128);
+    EXPECT_EQ(~ascii, high);
+    auto all = ascii;
+    all |= high;
+    EXPECT_EQ(all.size(), 256);
+    all &= regex::token::digits;
+    EXPECT_EQ(all, regex::token::digits);
+
+    const regex::token::char_set not_digits({{'0', '9'}}, true);
+    EXPECT_TRUE(not_digits.matches('\xff'));
+    EXPECT_FALSE(not_digits.matches('5'));
+    EXPECT_NE(not_digits, regex::token::digits);
+    EXPECT_NE(regex::token::token_type_hash{}(not_digits), regex::token::token_type_hash{}(regex::token::digits));
+
+    const auto re = regex::regex("[^a]+");
+    EXPECT_EQ(re.match_max("\xff\x80z\x01" "a"), 4);
+}
+
+TEST_F(regex_tests, lazy_dfa_matches_eager_dfa) {
+    const std::vector<std::string> patterns = {
+        "", "abc", "a*b*", "(a|b)*abb", "[a-c]+d|b*", "a*|b", "/\\*([^*]|\\*+[^*/])*\\*+/", "[^x]*x[^y]*",
+    };
+    std::mt19937 rng(7);
+    for (const auto& pattern : patterns) {
+        const regex::dfa::dfa eager(pattern);
+        // 预算只够几个状态，匹配过程中会反复清空缓存
+        const regex::dfa::lazy_dfa small(pattern, 256);
+        const regex::dfa::lazy_dfa large(pattern);
+        for (int round = 0; round < 300; ++round) {
+            std::string input(rng() % 24, ' ');
+            for (auto& ch : input) {
+                ch = "abcdxy*/"[rng() % 8];
+            }
+            std::size_t eager_scanned, small_scanned, large_scanned;
+            const auto expected = eager.match_max(input, eager_scanned);
+            EXPECT_EQ(small.match_max(input, small_scanned), expected) << pattern << " on " << input;
+            EXPECT_EQ(large.match_max(input, large_scanned), expected) << pattern << " on " << input;
+            EXPECT_EQ(small_scanned, eager_scanned) << pattern << " on " << input;
+            EXPECT_EQ(large_scanned, eager_scanned) << pattern << " on " << input;
+            EXPECT_EQ(small.match(input), eager.match(input)) << pattern << " on " << input;
+        }
+        EXPECT_EQ(large.flushes(), 0);
+    }
+    const regex::dfa::lazy_dfa comment("/\\*([^*]|\\*+[^*/])*\\*+/", 256);
+    EXPECT_EQ(comment.match_max("/* a ** b */ c"), 12);
+    EXPECT_GT(comment.flushes(), 0);
+}
+
+TEST_F(regex_tests, large_patterns_are_compiled_lazily) {
+    std::string pattern;
+    for (int i = 0; i < 1000; ++i) {
+        pattern += (i == 0 ? "kw" : "|kw") + std::to_string(i * 7919 % 100000) + "x";
+    }
+    const auto re = regex::regex(pattern);
+    EXPECT_TRUE(re.is_lazy());
+    EXPECT_TRUE(re.match("kw7919x"));
+    EXPECT_FALSE(re.match("kw7918x"));
+    EXPECT_EQ(re.match_max("kw15838xkw"), 8);
+    EXPECT_FALSE(regex::regex("abc").is_lazy());
+    EXPECT_TRUE(regex::regex("abc", regex::lazy{}).is_lazy());
+}
+
+TEST_F(regex_tests, counted_repetition) {
+    EXPECT_TRUE(regex::regex("a{3}").match("aaa"));
+    EXPECT_FALSE(regex::regex("a{3}").match("aa"));
+    EXPECT_FALSE(regex::regex("a{3}").match("aaaa"));
+    EXPECT_TRUE(regex::regex("a{2,}").match("aaaaa"));
+    EXPECT_FALSE(regex::regex("a{2,}").match("a"));
+    EXPECT_EQ(regex::regex("a{1,3}b").match_max("aab"), 3);
+    EXPECT_EQ(regex::regex("a{1,3}b").match_max("aaaab"), 0);
+    EXPECT_TRUE(regex::regex("(ab|c){2}").match("cab"));
+    EXPECT_TRUE(regex::regex("a{0,2}").match(""));
+    EXPECT_EQ(regex::regex("a*{2}x").match_max("aaax"), 4);
+    EXPECT_EQ(regex::regex("[0-9]{1,20}").match_max(std::string(30, '7')), 20);
+    // 不构成计数格式的 '{' 仍是普通字符
+    EXPECT_TRUE(regex::regex("a{").match("a{"));
+    EXPECT_TRUE(regex::regex("x{,3}").match("x{,3}"));
+    EXPECT_TRUE(regex::regex("\\{{2}").match("{{"));
+    EXPECT_THROW(regex::regex("a{3,2}"), regex::invalid_regex_exception);
+    EXPECT_THROW(regex::regex("a{0}"), regex::invalid_regex_exception);
+    EXPECT_THROW(regex::regex("a{1001}"), regex::invalid_regex_exception);
+
+    // 展开是线性的，最小化后每个计数对应一个状态
+    EXPECT_EQ(regex::dfa::dfa("[0-9]{1,20}").state_count(), 21);
+}
+
+TEST_F(regex_tests, find_returns_leftmost_longest_match) {
+    const auto re = regex::regex("[0-9]+ms");
+    EXPECT_EQ(re.find("took 12ms, then 7ms"), (regex::match_result{5, 4}));
+    EXPECT_EQ(re.find("took 12ms, then 7ms", 6), (regex::match_result{6, 3}));
+    EXPECT_EQ(re.find("no timing here 12 ms"), std::nullopt);
+    EXPECT_EQ(re.find_all("1ms 22ms x 333ms"),
+              (std::vector<regex::match_result>{{0, 3}, {4, 4}, {11, 5}}));
+
+    // 单个首字节走 memchr，多个首字节走区间扫描
+    const auto error = regex::regex("ERROR [a-z]+");
+    std::string log(5000, '.');
+    log.replace(100, 10, "ERROR disk");
+    log.replace(4000, 9, "ERROR net");
+    EXPECT_EQ(error.find_all(log), (std::vector<regex::match_result>{{100, 10}, {4000, 9}}));
+    const auto level = regex::regex("(WARN|ERROR|\xe4)");
+    log.replace(2000, 4, "WARN");
+    log[4500] = '\xe4';
+    EXPECT_EQ(level.find_all(log),
+              (std::vector<regex::match_result>{{100, 5}, {2000, 4}, {4000, 5}, {4500, 1}}));
+
+    // 可以匹配空串的模式只报告非空匹配
+    EXPECT_EQ(regex::regex("a*").find_all("baab"), (std::vector<regex::match_result>{{1, 2}}));
+    EXPECT_EQ(regex::regex("").find("abc"), std::nullopt);
+    EXPECT_EQ(regex::regex("x", regex::lazy{}).find("abcx"), (regex::match_result{3, 1}));
+}
+
+TEST_F(regex_tests, find_stays_linear_when_candidates_fail) {
+    // 每个候选起点的锚定匹配都读到末尾才失败，逐个尝试是平方时间
+    constexpr std::size_t n = 200000;
+    const std::string as(n, 'a');
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(regex::regex("a*b").find(as), std::nullopt);
+    EXPECT_EQ(regex::regex("a*b", regex::lazy{}).find(as), std::nullopt);
+    EXPECT_EQ(regex::regex("a*b|ac").find(as + "c"), (regex::match_result{n - 1, 2}));
+    EXPECT_EQ(regex::regex("a*b|c").find_all(as + "c" + as + "c"),
+              (std::vector<regex::match_result>{{n, 1}, {2 * n + 1, 1}}));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+}
+
+TEST_F(regex_tests, find_agrees_with_trying_every_start) {
+    const std::vector<std::string> patterns = {"a*b", "(a|b)*c", "ab|b*a", "a+b?c", "(ab)+|ba*c", "[ab]*cb"};
+    std::mt19937 rng(7);
+    for (const auto& pattern : patterns) {
+        const regex::regex re(pattern);
+        for (int round = 0; round < 20; ++round) {
+            // 长串 a 让逐个起点的匹配超出开销上限，改走反向扫描
+            std::string text(300 + rng() % 300, 'a');
+            for (int k = 0; k < 3; ++k) {
+                text[rng() % text.size()] = "abc"[rng() % 3];
+            }
+            std::vector<regex::match_result> expected;
+            for (std::size_t pos = 0; pos < text.size();) {
+                std::size_t scanned;
+                if (const auto length = re.match_max(std::string_view(text).substr(pos), scanned); length > 0) {
+                    expected.push_back({pos, length});
+                    pos += length;
+                } else {
+                    ++pos;
+                }
+            }
+            EXPECT_EQ(re.find_all(text), expected) << pattern << " " << text;
+        }
+    }
+}
+
+TEST_F(regex_tests, regex_set_reports_every_matching_pattern) {
+    const std::vector<std::string> patterns = {
+        "[a-z]+", "[0-9]+", "[a-z0-9]+", "if", "i[a-z]*", "(ab)*", "", "a{2,3}b",
+    };
+    const regex::regex_set set(patterns);
+    EXPECT_EQ(set.size(), patterns.size());
+    EXPECT_EQ(set.match("if"), (std::vector<std::size_t>{0, 2, 3, 4}));
+    EXPECT_EQ(set.match("42"), (std::vector<std::size_t>{1, 2}));
+    EXPECT_EQ(set.match(""), (std::vector<std::size_t>{5, 6}));
+    EXPECT_TRUE(set.match("-").empty());
+    EXPECT_FALSE(set.match_any("A"));
+
+    std::mt19937 rng(3);
+    std::vector<std::size_t> out;
+    for (int round = 0; round < 500; ++round) {
+        std::string input(rng() % 6, ' ');
+        for (auto& ch : input) {
+            ch = "abif09-"[rng() % 7];
+        }
+        std::vector<std::size_t> expected;
+        for (std::size_t k = 0; k < patterns.size(); ++k) {
+            if (regex::regex(patterns[k]).match(input)) {
+                expected.push_back(k);
+            }
+        }
+        set.match(input, out);
+        EXPECT_EQ(out, expected) << input;
+    }
+
+    std::vector<std::string> many;
+    for (int i = 0; i < 100; ++i) {
+        many.push_back("key" + std::to_string(i));
+    }
+    many.push_back("key[0-9]+");
+    const regex::regex_set wide(many);
+    EXPECT_EQ(wide.match("key99"), (std::vector<std::size_t>{99, 100}));
+    EXPECT_EQ(wide.match("key100"), (std::vector<std::size_t>{100}));
+    EXPECT_TRUE(regex::regex_set({}).match("x").empty());
+}
@@ -1,10 +1,14 @@
 #include "grammar/grammar.hpp"
 #include "semantic/sema.hpp"
+#include "semantic/ssa.hpp"
 
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 enum class token_type {
@@ -263,3 +267,171 @@ TYPED_TEST(sema_test_expr, multi_var_arith_expr) {
 TYPED_TEST(sema_test_expr, multi_var_paren_expr) {
     this->expect_semantics("int a = 1 ; int b = 2 ; { a = ( a + b ) * 2 ; }", {"a: 6", "b: 2"});
 }
+
+// 共享分析表，每次分析使用独立的语法树
+
+class sema_test_shared : public sema_test_base<grammar::LR1> {
+public:
+    sema_test_shared() : sema_test_base(build_grammar()) {}
+};
+
+TEST_F(sema_test_shared, concurrent_parse) {
+    const std::vector<std::pair<std::string, std::string>> cases{
+        {"int a = 1 ; { a = 2 + 3 ; }", "a: 5"},
+        {"int b = 2 ; { b = b * 4 ; }", "b: 8"},
+        {"int c = 3 ; { c = ( c + 1 ) * 2 ; }", "c: 8"},
+        {"int d = 4 ; { d = d - 1 ; }", "d: 3"}};
+
+    std::vector<std::vector<std::string>> results(cases.size());
+    {
+        std::vector<std::jthread> workers;
+        for (std::size_t i = 0; i < cases.size(); ++i) {
+            workers.emplace_back([&, i] {
+                const auto tree = std::as_const(parser).parse(lex.parse(cases[i].first), std::cout);
+                const auto env = tree->calc();
+                env.table.for_each_current([&](auto&& k, auto&& v) {
+                    results[i].push_back(k + ": " + trim_zero(v.at("value")));
+                });
+            });
+        }
+    }
+
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        EXPECT_EQ(results[i], std::vector{cases[i].second});
+    }
+}
+
+TEST_F(sema_test_shared, tree_released_after_calc) {
+    // 结点只通过子结点列表持有，语法树释放后不应留下任何存活的结点
+    for (int round = 0; round < 3; ++round) {
+        std::vector<std::weak_ptr<grammar::tree_node>> nodes;
+        {
+            const auto tree = std::as_const(parser).parse(lex.parse("int a = 1 ; { if ( a < 2 ) then { a = a + 1 ; } else { a = 0 ; } }"), std::cout);
+            const auto env = tree->calc();
+            EXPECT_TRUE(env.errors.empty());
+            tree->visit([&nodes](auto&& node) {
+                nodes.emplace_back(node);
+            });
+        }
+        ASSERT_FALSE(nodes.empty());
+        EXPECT_EQ(std::ranges::count_if(nodes, [](const auto& node) { return !node.expired(); }), 0);
+    }
+}
+
+// SSA 构造
+
+TEST(ssa_builder_test, straight_line) {
+    semantic::ssa_builder ssa;
+    ssa.enter_block("entry");
+    ssa.seal_block("entry");
+    EXPECT_EQ(ssa.read_variable("x"), semantic::ssa_builder::undef);
+    ssa.write_variable("x", "%1");
+    EXPECT_EQ(ssa.read_variable("x"), "%1");
+    ssa.write_variable("x", "%2");
+    EXPECT_EQ(ssa.read_variable("x"), "%2");
+}
+
+TEST(ssa_builder_test, diamond) {
+    semantic::ssa_builder ssa;
+    ssa.declare("x", "int");
+    ssa.enter_block("entry");
+    ssa.seal_block("entry");
+    ssa.write_variable("x", "%0");
+    ssa.write_variable("y", "%1");
+    ssa.add_predecessor("then", "entry");
+    ssa.add_predecessor("else", "entry");
+
+    ssa.enter_block("then");
+    ssa.seal_block("then");
+    ssa.write_variable("x", "%2");
+    ssa.add_predecessor("end", "then");
+
+    ssa.enter_block("else");
+    ssa.seal_block("else");
+    ssa.add_predecessor("end", "else");
+
+    ssa.enter_block("end");
+    ssa.seal_block("end");
+    EXPECT_EQ(ssa.read_variable("x"), "x.end");
+    EXPECT_EQ(ssa.read_variable("y"), "%1");
+
+    const auto phis = ssa.phis("end");
+    ASSERT_EQ(phis.size(), 1);
+    EXPECT_EQ(phis[0].type, "int");
+    EXPECT_EQ(phis[0].operands, (std::vector<std::pair<std::string, std::string>>{{"%2", "then"}, {"%0", "else"}}));
+}
+
+TEST(ssa_builder_test, loop) {
+    semantic::ssa_builder ssa;
+    ssa.enter_block("entry");
+    ssa.seal_block("entry");
+    ssa.write_variable("i", "%0");
+    ssa.write_variable("n", "%1");
+    ssa.add_predecessor("cond", "entry");
+
+    ssa.enter_block("cond");
+    EXPECT_EQ(ssa.read_variable("i"), "i.cond");
+    EXPECT_EQ(ssa.read_variable("n"), "n.cond");
+    ssa.add_predecessor("body", "cond");
+    ssa.add_predecessor("end", "cond");
+
+    ssa.enter_block("body");
+    ssa.seal_block("body");
+    ssa.write_variable("i", "%2");
+    ssa.add_predecessor("cond", "body");
+    ssa.seal_block("cond");
+
+    ssa.enter_block("end");
+    ssa.seal_block("end");
+    EXPECT_EQ(ssa.read_variable("i"), "i.cond");
+    EXPECT_EQ(ssa.read_variable("n"), "%1");
+    EXPECT_TRUE(ssa.has_aliases());
+    EXPECT_EQ(ssa.resolve("n.cond"), "%1");
+
+    const auto phis = ssa.phis("cond");
+    ASSERT_EQ(phis.size(), 1);
+    EXPECT_EQ(phis[0].name, "i.cond");
+    EXPECT_EQ(phis[0].operands, (std::vector<std::pair<std::string, std::string>>{{"%0", "entry"}, {"%2", "body"}}));
+}
+
+TEST(ssa_builder_test, trivial_phi_removal_cascades) {
+    semantic::ssa_builder ssa;
+    ssa.enter_block("entry");
+    ssa.seal_block("entry");
+    ssa.write_variable("n", "%1");
+    ssa.add_predecessor("outer", "entry");
+    ssa.add_predecessor("outer", "inner");
+    ssa.add_predecessor("inner", "outer");
+
+    ssa.enter_block("inner");
+    EXPECT_EQ(ssa.read_variable("n"), "n.inner");
+
+    ssa.enter_block("outer");
+    ssa.seal_block("outer");
+    EXPECT_EQ(ssa.read_variable("n"), "n.outer");
+
+    // n.inner 只引用 n.outer 和自身，删除后 n.outer 也变为平凡的 phi
+    ssa.add_predecessor("inner", "inner");
+    ssa.seal_block("inner");
+    EXPECT_EQ(ssa.resolve("n.inner"), "%1");
+    EXPECT_EQ(ssa.resolve("n.outer"), "%1");
+    EXPECT_TRUE(ssa.phis("inner").empty());
+    EXPECT_TRUE(ssa.phis("outer").empty());
+}
+
+TEST(ssa_builder_test, long_block_chain) {
+    // 只有一个前驱的长链上迭代查找，不会耗尽栈空间
+    constexpr int n = 100000;
+    semantic::ssa_builder ssa;
+    ssa.enter_block("b0");
+    ssa.seal_block("b0");
+    ssa.write_variable("x", "%0");
+    for (int i = 1; i <= n; ++i) {
+        const auto block = "b" + std::to_string(i);
+        ssa.add_predecessor(block, "b" + std::to_string(i - 1));
+        ssa.seal_block(block);
+    }
+    ssa.enter_block("b" + std::to_string(n));
+    EXPECT_EQ(ssa.read_variable("x"), "%0");
+    EXPECT_EQ(ssa.read_variable("x", "b" + std::to_string(n / 2)), "%0");
+}
@@ -0,0 +1,71 @@
+#include "build_grammar.hpp"
+#include "build_lexer.hpp"
+#include "driver.hpp"
+#include "generator.hpp"
+#include "ir.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 词法分析器和 LR(1) 分析表只构建一次，所有用例共享
+class generator_test : public testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        lex_ = std::make_unique<lexer::lexer>(build_lexer());
+        parser = std::make_unique<parser_t>(build_grammar());
+        parser->build();
+    }
+
+    static void TearDownTestSuite() {
+        parser.reset();
+        lex_.reset();
+    }
+
+    // 生成的程序应当通过词法、语法和语义分析，并输出可以解析的 IR
+    static void expect_compiles(const generator::options& opts) {
+        const auto source = generator::generate(opts);
+        EXPECT_GE(source.size(), opts.bytes);
+        std::stringstream il;
+        std::vector<std::string> diagnostics;
+        EXPECT_TRUE(compile_frontend(source, *lex_, *parser, il, diagnostics))
+            << "seed " << opts.seed << ", " << opts.bytes << " bytes: " << (diagnostics.empty() ? "" : diagnostics.front());
+        EXPECT_NO_THROW(ir::parse(il)) << "seed " << opts.seed << ", " << opts.bytes << " bytes";
+    }
+
+    static inline std::unique_ptr<lexer::lexer> lex_;
+    static inline std::unique_ptr<parser_t> parser;
+};
+
+} // namespace
+
+TEST_F(generator_test, same_seed_gives_same_program) {
+    for (const std::size_t bytes : {512, 8192, 65536}) {
+        const generator::options opts{.bytes = bytes, .seed = 42};
+        const auto program = generator::generate(opts);
+        EXPECT_EQ(generator::generate(opts), program);
+        // 流式输出与一次生成的字符串相同
+        std::ostringstream os;
+        generator::generate(os, opts);
+        EXPECT_EQ(os.str(), program);
+        EXPECT_NE(generator::generate({.bytes = bytes, .seed = 43}), program);
+    }
+}
+
+TEST_F(generator_test, programs_compile_at_several_sizes) {
+    for (const std::size_t bytes : {256, 4096, 32768}) {
+        for (const std::uint64_t seed : {1, 2, 3}) {
+            expect_compiles({.bytes = bytes, .seed = seed});
+        }
+    }
+}
+
+TEST_F(generator_test, deep_and_wide_programs_compile) {
+    expect_compiles({.bytes = 16384, .seed = 5, .max_depth = 12, .expr_depth = 20});
+    expect_compiles({.bytes = 16384, .seed = 6, .block_size = 1000});
+    expect_compiles({.bytes = 4096, .seed = 7, .max_depth = 1, .expr_depth = 1, .block_size = 1});
+}
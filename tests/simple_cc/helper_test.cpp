@@ -0,0 +1,113 @@
+#include "helper.hpp"
+#include "semantic/sema_production.hpp"
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace {
+
+const std::string int_min = std::to_string(std::numeric_limits<int>::min());
+const std::string long_min = std::to_string(std::numeric_limits<long long>::min());
+const std::string long_max = std::to_string(std::numeric_limits<long long>::max());
+
+// 常量折叠成功时不生成指令；无法折叠时生成一条转换指令并返回新的临时寄存器
+struct conversion {
+    std::string result;
+    std::string code;
+};
+
+conversion convert(const std::string& reg, const std::string& from, const std::string& to) {
+    std::ostringstream os;
+    semantic::sema_env env(&os);
+    auto result = convert_type(env, reg, from, to);
+    return {std::move(result), os.str()};
+}
+
+} // namespace
+
+TEST(helper_test, int_arithmetic_wraps_to_32_bits) {
+    EXPECT_EQ(fold_binary("+", "2147483647", "1", "int"), int_min);
+    EXPECT_EQ(fold_binary("-", int_min, "1", "int"), "2147483647");
+    EXPECT_EQ(fold_binary("*", "65536", "65536", "int"), "0");
+    EXPECT_EQ(fold_binary("*", "-46341", "46341", "int"), "2147479015");
+    EXPECT_EQ(fold_binary("&", "-1", "255", "int"), "255");
+    EXPECT_EQ(fold_binary("^", "2147483647", "-1", "int"), int_min);
+    EXPECT_EQ(fold_binary("/", "-7", "2", "int"), "-3");
+}
+
+TEST(helper_test, long_arithmetic_wraps_to_64_bits) {
+    EXPECT_EQ(fold_binary("+", long_max, "1", "long"), long_min);
+    EXPECT_EQ(fold_binary("-", long_min, "1", "long"), long_max);
+    EXPECT_EQ(fold_binary("*", "4294967296", "4294967296", "long"), "0");
+    // long 运算不截断到 32 位
+    EXPECT_EQ(fold_binary("+", "2147483647", "1", "long"), "2147483648");
+}
+
+TEST(helper_test, undefined_division_is_not_folded) {
+    EXPECT_EQ(fold_binary("/", "1", "0", "int"), "");
+    EXPECT_EQ(fold_binary("/", "1", "0", "long"), "");
+    EXPECT_EQ(fold_binary("/", int_min, "-1", "int"), "");
+    EXPECT_EQ(fold_binary("/", long_min, "-1", "long"), "");
+    // 只有 INT_MIN / -1 溢出，long 中的 INT_MIN / -1 可以折叠
+    EXPECT_EQ(fold_binary("/", int_min, "-1", "long"), "2147483648");
+    EXPECT_EQ(fold_binary("/", int_min, "1", "int"), int_min);
+    // 浮点除以零按 IEEE 754 得到无穷大
+    EXPECT_TRUE(std::isinf(const_double(fold_binary("/", make_const(1.0), make_const(0.0), "double"))));
+}
+
+TEST(helper_test, non_constant_operands_are_not_folded) {
+    EXPECT_EQ(fold_binary("+", "%t1", "1", "int"), "");
+    EXPECT_EQ(fold_binary("+", "1", "undef", "int"), "");
+    EXPECT_EQ(fold_compare("<", "@g", "1", "int"), "");
+}
+
+TEST(helper_test, comparisons_are_signed) {
+    EXPECT_EQ(fold_compare("<", "-1", "1", "int"), "1");
+    EXPECT_EQ(fold_compare(">", "-1", "1", "int"), "0");
+    EXPECT_EQ(fold_compare("<", int_min, "2147483647", "int"), "1");
+    EXPECT_EQ(fold_compare(">=", "-1", "0", "long"), "0");
+    EXPECT_EQ(fold_compare("<", long_min, long_max, "long"), "1");
+    // 回绕后的结果按有符号数比较
+    EXPECT_EQ(fold_compare("<", fold_binary("+", "2147483647", "1", "int"), "0", "int"), "1");
+    EXPECT_EQ(fold_compare("==", "-1", "4294967295", "long"), "0");
+    EXPECT_EQ(fold_compare("!=", "3", "3", "int"), "0");
+    EXPECT_EQ(fold_compare("<=", "3", "3", "int"), "1");
+}
+
+TEST(helper_test, double_comparisons_are_ordered) {
+    const auto nan = make_const(std::numeric_limits<double>::quiet_NaN());
+    EXPECT_EQ(fold_compare("<", make_const(-0.5), make_const(0.25), "double"), "1");
+    EXPECT_EQ(fold_compare("==", make_const(0.0), make_const(-0.0), "double"), "1");
+    EXPECT_EQ(fold_compare("==", nan, nan, "double"), "0");
+    EXPECT_EQ(fold_compare("!=", nan, make_const(1.0), "double"), "0");
+}
+
+TEST(helper_test, constant_conversions) {
+    EXPECT_EQ(convert("-1", "int", "long").result, "-1");
+    EXPECT_EQ(convert("4294967297", "long", "int").result, "1");
+    EXPECT_EQ(convert("2147483648", "long", "int").result, int_min);
+    EXPECT_EQ(convert("-3", "int", "double").result, make_const(-3.0));
+    EXPECT_EQ(convert(make_const(2.9), "double", "int").result, "2");
+    EXPECT_EQ(convert(make_const(-2.9), "double", "int").result, "-2");
+    EXPECT_EQ(convert(make_const(-2147483648.9), "double", "int").result, int_min);
+    EXPECT_EQ(convert(make_const(2147483647.9), "double", "int").result, "2147483647");
+    EXPECT_EQ(convert(make_const(9.0e18), "double", "long").result, "9000000000000000000");
+    EXPECT_TRUE(convert("7", "int", "double").code.empty());
+}
+
+TEST(helper_test, out_of_range_fptosi_is_not_folded) {
+    for (const double value : {2147483648.0, -2147483649.0, 1e300, -std::numeric_limits<double>::infinity(),
+                               std::numeric_limits<double>::quiet_NaN()}) {
+        const auto c = convert(make_const(value), "double", "int");
+        EXPECT_TRUE(c.result.starts_with("%")) << value;
+        EXPECT_NE(c.code.find("fptosi double " + make_const(value) + " to i32"), std::string::npos) << value;
+    }
+    for (const double value : {9223372036854775808.0, -1e19, std::numeric_limits<double>::infinity()}) {
+        const auto c = convert(make_const(value), "double", "long");
+        EXPECT_TRUE(c.result.starts_with("%")) << value;
+        EXPECT_NE(c.code.find("fptosi double " + make_const(value) + " to i64"), std::string::npos) << value;
+    }
+}
@@ -0,0 +1,64 @@
+#include "json.hpp"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+
+TEST(json_test, round_trip) {
+    const std::string text = R"({"a":[1,-2.5,true,false,null],"b":{"c":"x\"y\\z\n"},"d":1e+100})";
+    const auto v = json::parse(text);
+    EXPECT_EQ(v["b"]["c"].as_string(), "x\"y\\z\n");
+    EXPECT_EQ(v["d"].as_number(), 1e100);
+    EXPECT_TRUE(v["missing"].is_null());
+    EXPECT_EQ(json::dump(v), text);
+    EXPECT_EQ(json::dump(json::parse(json::dump(v))), text);
+}
+
+TEST(json_test, whitespace_and_escapes) {
+    const auto v = json::parse(" \t\r\n{ \"k\" : [ \"\\u0041\\u00e9\\u4e2d\\ud83d\\ude00\" ] }\n");
+    EXPECT_EQ(json::dump(v), "{\"k\":[\"A\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80\"]}");
+    EXPECT_EQ(json::quote(std::string("\x01", 1)), "\"\\u0001\"");
+}
+
+TEST(json_test, numbers) {
+    EXPECT_EQ(json::parse("0").as_number(), 0);
+    EXPECT_EQ(json::parse("-0.5").as_number(), -0.5);
+    EXPECT_EQ(json::parse("12E-1").as_number(), 1.2);
+    EXPECT_EQ(json::parse("3e+2").as_number(), 300);
+    EXPECT_EQ(json::dump(json::parse("9007199254740993")), "9007199254740992");
+    EXPECT_EQ(json::dump(json::parse("0.1")), "0.10000000000000001");
+}
+
+TEST(json_test, malformed_numbers) {
+    for (const char* text : {"+1", "01", "1.", ".5", "1e", "1e+", "-", "0x10", "nan", "NaN", "inf", "-Infinity",
+                             "1e400", "-1e400", "[1.5.2]"}) {
+        EXPECT_THROW(json::parse(text), std::runtime_error) << text;
+    }
+}
+
+TEST(json_test, malformed_documents) {
+    for (const char* text : {"", "{", "}", "[1,]", "[1 2]", "{\"a\" 1}", "{\"a\":1,}", "{a:1}", "\"abc",
+                             "\"\\x\"", "\"\\u12\"", "\"\\u12g4\"", "tru", "nul", "1 2", "[]]"}) {
+        EXPECT_THROW(json::parse(text), std::runtime_error) << text;
+    }
+}
+
+TEST(json_test, unpaired_surrogates) {
+    EXPECT_THROW(json::parse(R"("\ud83d")"), std::runtime_error);
+    EXPECT_THROW(json::parse(R"("\ud83dx")"), std::runtime_error);
+    EXPECT_THROW(json::parse(R"("\ud83d\u0041")"), std::runtime_error);
+    EXPECT_THROW(json::parse(R"("\ud83d\ud83d")"), std::runtime_error);
+    EXPECT_THROW(json::parse(R"("\ude00")"), std::runtime_error);
+}
+
+TEST(json_test, nesting_depth) {
+    const std::string shallow = std::string(500, '[') + std::string(500, ']');
+    EXPECT_NO_THROW(json::parse(shallow));
+    // 深层嵌套应当报错而不是耗尽栈
+    EXPECT_THROW(json::parse(std::string(100000, '[')), std::runtime_error);
+    std::string objects;
+    for (int i = 0; i < 100000; ++i) {
+        objects += "{\"a\":";
+    }
+    EXPECT_THROW(json::parse(objects), std::runtime_error);
+}
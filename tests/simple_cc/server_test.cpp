@@ -0,0 +1,112 @@
+#include "build_grammar.hpp"
+#include "build_lexer.hpp"
+#include "json.hpp"
+#include "server.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+namespace {
+
+// 词法分析器和 LR(1) 分析表只构建一次，所有用例共享
+class server_test : public testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        lex_ = std::make_unique<lexer::lexer>(build_lexer());
+        parser = std::make_unique<parser_t>(build_grammar());
+        parser->build();
+    }
+
+    static void TearDownTestSuite() {
+        parser.reset();
+        lex_.reset();
+    }
+
+    json::value request(const std::string& line) {
+        bool shutdown = false;
+        return json::parse(server::handle(line, *lex_, *parser, state, shutdown));
+    }
+
+    static std::string first_diagnostic(const json::value& response) {
+        return std::get<json::array>(response["diagnostics"].data).at(0).as_string();
+    }
+
+    static inline std::unique_ptr<lexer::lexer> lex_;
+    static inline std::unique_ptr<parser_t> parser;
+    server::session state;
+};
+
+const std::string program = R"(int main() {
+    int a = 6;
+    int b = 7;
+    printf("%d\n", a * b);
+}
+)";
+
+} // namespace
+
+TEST_F(server_test, compile_ir_and_asm) {
+    const auto ir = request(json::dump(json::object{{"id", 1}, {"source", program}, {"opt", 2}}));
+    ASSERT_TRUE(std::get<bool>(ir["ok"].data));
+    EXPECT_EQ(ir["id"].as_number(), 1);
+    EXPECT_NE(ir["output"].as_string().find("define i32 @main()"), std::string::npos);
+    // -O2 把 a * b 折叠为常量
+    EXPECT_NE(ir["output"].as_string().find("i32 42"), std::string::npos);
+
+    const auto asm_ = request(json::dump(json::object{{"id", 2}, {"source", program}, {"emit", "asm"}}));
+    ASSERT_TRUE(std::get<bool>(asm_["ok"].data));
+    EXPECT_NE(asm_["output"].as_string().find("main:"), std::string::npos);
+}
+
+TEST_F(server_test, compile_errors_are_diagnostics) {
+    const auto response = request(json::dump(json::object{{"source", "int main() { x = 1; }"}}));
+    EXPECT_FALSE(std::get<bool>(response["ok"].data));
+    EXPECT_FALSE(std::get<json::array>(response["diagnostics"].data).empty());
+}
+
+TEST_F(server_test, invalid_requests) {
+    EXPECT_EQ(first_diagnostic(request("{")).rfind("invalid request", 0), 0u);
+    EXPECT_EQ(first_diagnostic(request("[]")), "invalid request: expected an object");
+    EXPECT_EQ(first_diagnostic(request(R"({"cmd":"frobnicate"})")), "unknown cmd");
+    EXPECT_EQ(first_diagnostic(request(R"({"opt":2})")), "missing source");
+    for (const char* opt : {"4", "-1", "1.5", "1e30", "\"2\""}) {
+        const auto response = request(std::string(R"({"source":"int main() { }","opt":)") + opt + "}");
+        EXPECT_EQ(first_diagnostic(response), "invalid opt level") << opt;
+    }
+    EXPECT_EQ(first_diagnostic(request(R"({"source":"","emit":"obj"})")), "unknown emit kind: obj");
+}
+
+TEST_F(server_test, edit_document) {
+    ASSERT_TRUE(std::get<bool>(request(json::dump(json::object{{"doc", "a"}, {"source", program}}))["ok"].data));
+    const auto offset = static_cast<double>(program.find('6'));
+    const auto edited = request(json::dump(json::object{
+        {"doc", "a"}, {"opt", 2}, {"edit", json::object{{"offset", offset}, {"length", 1}, {"text", "60"}}}}));
+    ASSERT_TRUE(std::get<bool>(edited["ok"].data));
+    EXPECT_NE(edited["output"].as_string().find("i32 420"), std::string::npos);
+    EXPECT_GT(edited["relexed"].as_number(), 0);
+    EXPECT_EQ(state.documents.at("a").source.find("int a = 60;"), program.find("int a = 6;"));
+}
+
+TEST_F(server_test, invalid_edits_keep_document) {
+    ASSERT_TRUE(std::get<bool>(request(json::dump(json::object{{"doc", "a"}, {"source", program}}))["ok"].data));
+    const auto edit = [&](const std::string& fields) {
+        return first_diagnostic(request(R"({"doc":"a","edit":{)" + fields + "}}"));
+    };
+    EXPECT_EQ(edit(R"("offset":1e30,"length":0,"text":"x")"), "edit out of range");
+    EXPECT_EQ(edit(R"("offset":0,"length":1e30,"text":"x")"), "edit out of range");
+    EXPECT_EQ(edit(R"("offset":0,"length":18446744073709551616,"text":"")"), "edit out of range");
+    EXPECT_EQ(edit(R"("offset":)" + std::to_string(program.size() + 1) + R"(,"text":"x")"), "edit out of range");
+    EXPECT_EQ(edit(R"("offset":1.5,"text":"x")"), "invalid edit");
+    EXPECT_EQ(edit(R"("offset":-1,"text":"x")"), "invalid edit");
+    EXPECT_EQ(edit(R"("offset":0,"length":"1","text":"x")"), "invalid edit");
+    EXPECT_EQ(edit(R"("offset":0)"), "invalid edit");
+    EXPECT_EQ(state.documents.at("a").source, program);
+
+    EXPECT_EQ(first_diagnostic(request(R"({"doc":"b","edit":{"offset":0,"text":""}})")), "unknown document: b");
+    bool shutdown = false;
+    server::handle(R"({"cmd":"close","doc":"a"})", *lex_, *parser, state, shutdown);
+    EXPECT_FALSE(state.documents.contains("a"));
+    server::handle(R"({"cmd":"shutdown"})", *lex_, *parser, state, shutdown);
+    EXPECT_TRUE(shutdown);
+}
@@ -1,3 +1,5 @@
+#include "regex/regex.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
 
 #include <gtest/gtest.h>
@@ -112,3 +114,32 @@ TEST(utils_test, println_single) {
     println(oss, 42);
     EXPECT_EQ(oss.str(), "42\n");
 }
+
+TEST(utils_test, trace_records_spans_only_while_enabled) {
+    { const trace::span ignored("before"); }
+
+    trace::start();
+    {
+        const trace::span outer("outer \"quoted\"");
+        const regex::regex re("a|b");
+    }
+    trace::stop();
+    { const trace::span ignored("after"); }
+
+    std::ostringstream oss;
+    trace::write(oss);
+    const auto out = oss.str();
+    EXPECT_TRUE(out.starts_with("{\"traceEvents\":["));
+    EXPECT_NE(out.find(R"("name":"outer \"quoted\"")"), std::string::npos);
+    EXPECT_NE(out.find(R"("name":"dfa::init")"), std::string::npos);
+    EXPECT_NE(out.find(R"("ph":"X")"), std::string::npos);
+    EXPECT_EQ(out.find("before"), std::string::npos);
+    EXPECT_EQ(out.find("after"), std::string::npos);
+
+    // 重新开始时清空之前的记录
+    trace::start();
+    trace::stop();
+    oss.str({});
+    trace::write(oss);
+    EXPECT_EQ(oss.str().find("outer"), std::string::npos);
+}
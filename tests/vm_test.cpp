@@ -0,0 +1,153 @@
+#include "ir.hpp"
+#include "vm.hpp"
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// 解析模块、编译为字节码并执行，返回 main 的返回值
+int run_module(const std::string& text) {
+    std::istringstream is(text);
+    const auto prog = ir::vm::compile(ir::parse(is));
+    return ir::vm::run(prog);
+}
+
+// 只含 main 函数体的模块
+int run_main(const std::string& body) {
+    return run_module("define i32 @main() {\n" + body + "}\n");
+}
+
+} // namespace
+
+TEST(vm_test, integer_arithmetic) {
+    EXPECT_EQ(run_main(R"(entry:
+  %a = add nsw i32 40, 2
+  %b = mul nsw i32 %a, 3
+  %c = sub nsw i32 %b, 6
+  %d = sdiv i32 %c, 4
+  ret i32 %d
+)"), 30);
+    // i32 运算按补码回绕
+    EXPECT_EQ(run_main(R"(entry:
+  %a = add i32 2147483647, 1
+  %b = icmp slt i32 %a, 0
+  %c = zext i1 %b to i32
+  ret i32 %c
+)"), 1);
+    EXPECT_EQ(run_main(R"(entry:
+  %a = sdiv i32 -7, 2
+  %b = xor i32 %a, 1
+  ret i32 %b
+)"), -4);
+}
+
+TEST(vm_test, float_arithmetic) {
+    EXPECT_EQ(run_main(R"(entry:
+  %a = sitofp i32 7 to double
+  %b = fmul double %a, 2.5
+  %c = fsub double %b, 0.5
+  %d = fptosi double %c to i32
+  ret i32 %d
+)"), 17);
+}
+
+TEST(vm_test, branch_with_phi) {
+    const std::string program = R"(entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %pos, label %neg
+pos:
+  br label %join
+neg:
+  br label %join
+join:
+  %v = phi i32 [ 10, %pos ], [ 20, %neg ]
+  ret i32 %v
+)";
+    // %n 未定义时按 0 处理，走 neg 分支
+    EXPECT_EQ(run_main(program), 20);
+    EXPECT_EQ(run_main(R"(entry:
+  br i1 true, label %a, label %b
+a:
+  br label %join
+b:
+  br label %join
+join:
+  %v = phi i32 [ 1, %a ], [ 2, %b ]
+  ret i32 %v
+)"), 1);
+}
+
+TEST(vm_test, loop_with_phis) {
+    // sum = 1 + 2 + ... + 10
+    EXPECT_EQ(run_main(R"(entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 1, %entry ], [ %i1, %loop ]
+  %sum = phi i32 [ 0, %entry ], [ %sum1, %loop ]
+  %sum1 = add nsw i32 %sum, %i
+  %i1 = add nsw i32 %i, 1
+  %c = icmp sle i32 %i1, 10
+  br i1 %c, label %loop, label %exit
+exit:
+  ret i32 %sum1
+)"), 55);
+}
+
+TEST(vm_test, phi_swap_is_parallel) {
+    // 每次迭代交换 a、b，phi 的复制必须并行执行，否则 a、b 会变成同一个值
+    EXPECT_EQ(run_main(R"(entry:
+  br label %loop
+loop:
+  %a = phi i32 [ 1, %entry ], [ %b, %loop ]
+  %b = phi i32 [ 2, %entry ], [ %a, %loop ]
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %i1 = add nsw i32 %i, 1
+  %c = icmp slt i32 %i1, 3
+  br i1 %c, label %loop, label %exit
+exit:
+  %r = mul nsw i32 %a, 10
+  %s = add nsw i32 %r, %b
+  ret i32 %s
+)"), 12);
+}
+
+TEST(vm_test, loop_through_memory) {
+    EXPECT_EQ(run_main(R"(entry:
+  %x = alloca i32, align 4
+  store i32 1, i32* %x, align 4
+  br label %loop
+loop:
+  %v = load i32, i32* %x, align 4
+  %v2 = mul nsw i32 %v, 2
+  store i32 %v2, i32* %x, align 4
+  %c = icmp slt i32 %v2, 100
+  br i1 %c, label %loop, label %exit
+exit:
+  %r = load i32, i32* %x, align 4
+  ret i32 %r
+)"), 128);
+}
+
+TEST(vm_test, printf_call) {
+    testing::internal::CaptureStdout();
+    const int status = run_module(R"(@.str.0 = private unnamed_addr constant [14 x i8] c"%d %.2f %d%%\0a\00", align 1
+
+declare i32 @printf(i8*, ...)
+
+define i32 @main() {
+entry:
+  %s = getelementptr inbounds [14 x i8], [14 x i8]* @.str.0, i64 0, i64 0
+  %n = call i32 (i8*, ...) @printf(i8* %s, i32 42, double 1.5, i32 -3)
+  ret i32 %n
+}
+)");
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "42 1.50 -3%\n");
+    EXPECT_EQ(status, 12);
+}
+
+TEST(vm_test, missing_main) {
+    std::istringstream is("define i32 @f() {\nentry:\n  ret i32 0\n}\n");
+    EXPECT_THROW(ir::vm::compile(ir::parse(is)), ir::parse_error);
+}
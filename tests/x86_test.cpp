@@ -0,0 +1,145 @@
+#include "ir.hpp"
+#include "x86.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string emit_asm(const std::string& text) {
+    std::istringstream is(text);
+    std::ostringstream os;
+    ir::x86::emit(os, ir::parse(is));
+    return os.str();
+}
+
+// 按行拆分，去掉行首的制表符
+std::vector<std::string> lines_of(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream is(text);
+    for (std::string line; std::getline(is, line);) {
+        lines.push_back(line.starts_with('\t') ? line.substr(1) : line);
+    }
+    return lines;
+}
+
+// 标号 label 之后到下一个标号之前的指令
+std::vector<std::string> block_of(const std::vector<std::string>& lines, const std::string& label) {
+    std::vector<std::string> block;
+    auto it = std::ranges::find(lines, label + ":");
+    EXPECT_NE(it, lines.end()) << label;
+    for (; it != lines.end() && ++it != lines.end() && !it->ends_with(":");) {
+        block.push_back(*it);
+    }
+    return block;
+}
+
+// 同时活跃的整数值多于 int_pool 中的 5 个寄存器
+const std::string many_live = R"(define i32 @main() {
+entry:
+  %x = alloca i32, align 4
+  store i32 5, i32* %x, align 4
+  %p = load i32, i32* %x, align 4
+  %a = add i32 %p, 1
+  %b = add i32 %p, 2
+  %c = add i32 %p, 3
+  %d = add i32 %p, 4
+  %e = add i32 %p, 5
+  %f = add i32 %p, 6
+  %g = add i32 %p, 7
+  %h = add i32 %p, 8
+  %s1 = add i32 %a, %b
+  %s2 = add i32 %s1, %c
+  %s3 = add i32 %s2, %d
+  %s4 = add i32 %s3, %e
+  %s5 = add i32 %s4, %f
+  %s6 = add i32 %s5, %g
+  %s7 = add i32 %s6, %h
+  ret i32 %s7
+}
+)";
+
+const std::string swap_loop = R"(define i32 @main() {
+entry:
+  br label %loop
+loop:
+  %a = phi i32 [ 1, %entry ], [ %b, %loop ]
+  %b = phi i32 [ 2, %entry ], [ %a, %loop ]
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %i1 = add nsw i32 %i, 1
+  %c = icmp slt i32 %i1, 3
+  br i1 %c, label %loop, label %exit
+exit:
+  %r = mul nsw i32 %a, 10
+  %s = add nsw i32 %r, %b
+  ret i32 %s
+}
+)";
+
+} // namespace
+
+TEST(x86_test, spills_when_registers_run_out) {
+    const auto lines = lines_of(emit_asm(many_live));
+    // 被调用者保存的寄存器全部用上，并在序言中保存
+    for (const char* reg : {"%rbx", "%r12", "%r13", "%r14", "%r15"}) {
+        EXPECT_NE(std::ranges::find(lines, std::string("pushq ") + reg), lines.end()) << reg;
+    }
+    // %a 到 %h 同时活跃，至少 3 个溢出到栈上，之后再从各自的栈槽读回
+    const std::regex spill(R"(movq %rax, (-\d+\(%rbp\)))");
+    std::set<std::string> slots;
+    for (const auto& line : lines) {
+        if (std::smatch m; std::regex_match(line, m, spill)) {
+            slots.insert(m[1]);
+        }
+    }
+    EXPECT_GE(slots.size(), 3u);
+    for (const auto& slot : slots) {
+        EXPECT_NE(std::ranges::find(lines, "addl " + slot + ", %eax"), lines.end()) << slot;
+    }
+}
+
+TEST(x86_test, phi_swap_uses_parallel_copy) {
+    const auto lines = lines_of(emit_asm(swap_loop));
+    const auto loop = block_of(lines, ".Lmain_loop");
+    ASSERT_GE(loop.size(), 2u);
+    // 回边经由边上的代码复制 phi，条件不成立时必须跳到 exit，不能落入边上的代码
+    EXPECT_EQ(loop[loop.size() - 2], "jne .Lmain_edge0");
+    EXPECT_EQ(loop.back(), "jmp .Lmain_exit");
+
+    // %a 与 %b 互换，所有源值先写入临时栈槽，再写入目标
+    const auto edge = block_of(lines, ".Lmain_edge0");
+    ASSERT_FALSE(edge.empty());
+    EXPECT_EQ(edge.back(), "jmp .Lmain_loop");
+    std::size_t stores = 0;
+    std::size_t last_store = 0;
+    std::size_t first_load = edge.size();
+    for (std::size_t i = 0; i < edge.size(); ++i) {
+        if (edge[i].starts_with("movq %rax, -")) {
+            ++stores;
+            last_store = i;
+        } else if (edge[i].starts_with("movq -") && first_load == edge.size()) {
+            first_load = i;
+        }
+    }
+    EXPECT_EQ(stores, 3u);
+    EXPECT_LT(last_store, first_load);
+}
+TEST(x86_test, long_block_chain) {
+    // 活跃性分析不递归，长链也不会耗尽栈；%k 在整条链上保持活跃
+    constexpr int n = 20000;
+    std::string text = "define i32 @main() {\nentry:\n  %x = alloca i32, align 4\n  store i32 3, i32* %x, align 4\n"
+                       "  %k = load i32, i32* %x, align 4\n  br label %b0\n";
+    for (int i = 0; i < n; ++i) {
+        text += "b" + std::to_string(i) + ":\n  br label %b" + std::to_string(i + 1) + "\n";
+    }
+    text += "b" + std::to_string(n) + ":\n  %r = add i32 %k, 1\n  ret i32 %r\n}\n";
+    const auto lines = lines_of(emit_asm(text));
+    const auto last = block_of(lines, ".Lmain_b" + std::to_string(n));
+    ASSERT_FALSE(last.empty());
+    EXPECT_EQ(last.front(), "movq %rbx, %rax");
+}
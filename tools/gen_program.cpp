@@ -0,0 +1,80 @@
+#include "generator.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 解析带 K / M / G 后缀的大小
+std::size_t parse_size(const std::string& str) {
+    std::size_t pos = 0;
+    const auto n = std::stoull(str, &pos);
+    const auto suffix = str.substr(pos);
+    if (suffix.empty()) {
+        return n;
+    }
+    if (suffix == "K" || suffix == "k") {
+        return n << 10;
+    }
+    if (suffix == "M" || suffix == "m") {
+        return n << 20;
+    }
+    if (suffix == "G" || suffix == "g") {
+        return n << 30;
+    }
+    throw std::invalid_argument("bad size: " + str);
+}
+
+} // namespace
+
+int main(const int argc, char** argv) {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    generator::options opts;
+    std::string output_file;
+
+    try {
+        for (auto it = args.begin(); it != args.end(); ++it) {
+            const auto& arg = *it;
+            if (arg == "-o" && std::next(it) != args.end()) {
+                output_file = *++it;
+            } else if (arg.starts_with("--size=")) {
+                opts.bytes = parse_size(arg.substr(7));
+            } else if (arg.starts_with("--seed=")) {
+                opts.seed = std::stoull(arg.substr(7));
+            } else if (arg.starts_with("--depth=")) {
+                opts.max_depth = std::stoul(arg.substr(8));
+            } else if (arg.starts_with("--expr-depth=")) {
+                opts.expr_depth = std::stoul(arg.substr(13));
+            } else if (arg.starts_with("--block=")) {
+                opts.block_size = std::max<std::size_t>(std::stoul(arg.substr(8)), 1);
+            } else {
+                std::cerr << "Usage: " << argv[0]
+                          << " [--size=<bytes>[K|M|G]](default 4K)"
+                          << " [--seed=<n>](default 1)"
+                          << " [--depth=<n>](max if/for/while nesting, default 6)"
+                          << " [--expr-depth=<n>](max expression nesting, default 5)"
+                          << " [--block=<n>](max statements per block, default 32)"
+                          << " [-o <output_file>](default stdout)" << std::endl;
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "invalid argument: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (output_file.empty()) {
+        generator::generate(std::cout, opts);
+        return 0;
+    }
+    std::ofstream ofs(output_file, std::ios::binary);
+    if (!ofs) {
+        std::cerr << "cannot open " << output_file << "." << std::endl;
+        return 1;
+    }
+    generator::generate(ofs, opts);
+    return 0;
+}